@@ -0,0 +1,139 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	a1_responder.cpp
+    Abstract:	Implements the A1 policy status responder. When many policy
+                instances arrive together (e.g. after a policy query), their
+                statuses are collected for a short linger time, coalesced per
+                instance, and handed to the sender as one batch.
+
+    Date:       18 Oct 2026
+*/
+
+#include "a1_responder.hpp"
+
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
+
+namespace ts {
+
+A1Responder::A1Responder( const std::string &handler_id, std::chrono::milliseconds linger, a1_sender_t sender ) {
+    this->handler_id = handler_id;
+    this->linger = linger;
+    this->sender = sender;
+
+    flusher = std::thread( &A1Responder::flush_loop, this );
+}
+
+/*
+    Stops the flusher thread; statuses still pending are sent before it exits.
+*/
+A1Responder::~A1Responder( ) {
+    {
+        std::lock_guard<std::mutex> lock( pending_mutex );
+        stopping = true;
+    }
+    pending_cv.notify_all();
+
+    if( flusher.joinable() ) {
+        flusher.join();
+    }
+}
+
+/*
+    Queues the status of a policy instance. A newer status of the same
+    instance replaces one that has not been sent yet.
+*/
+void A1Responder::enqueue( int policy_type_id, const std::string &policy_instance_id, const std::string &status ) {
+    {
+        std::lock_guard<std::mutex> lock( pending_mutex );
+        pending[ policy_key_t( policy_type_id, policy_instance_id ) ] = status;
+    }
+    pending_cv.notify_one();
+}
+
+void A1Responder::flush_loop( ) {
+    std::unique_lock<std::mutex> lock( pending_mutex );
+
+    while( true ) {
+        pending_cv.wait( lock, [this]{ return stopping || !pending.empty(); } );
+        if( pending.empty() ) {     // only when stopping
+            return;
+        }
+
+        if( !stopping ) {           // let the rest of a burst arrive
+            pending_cv.wait_for( lock, linger, [this]{ return stopping; } );
+        }
+
+        std::map<policy_key_t, std::string> batch;
+        batch.swap( pending );
+        lock.unlock();
+
+        std::vector<std::string> payloads;
+        payloads.reserve( batch.size() );
+        for( auto &it : batch ) {
+            payloads.push_back( build_response( handler_id, it.first.first, it.first.second, it.second ) );
+        }
+        sender( payloads );
+
+        lock.lock();
+    }
+}
+
+/*
+    Builds the payload of an A1_POLICY_RESP message like
+    {"policy_type_id": 20008, "policy_instance_id": "tsapolicy145", "handler_id": "trafficxapp", "status": "OK"}
+*/
+std::string A1Responder::build_response( const std::string &handler_id, int policy_type_id,
+                                         const std::string &policy_instance_id, const std::string &status ) {
+    rapidjson::StringBuffer s;
+    rapidjson::Writer<rapidjson::StringBuffer> writer( s );
+
+    writer.StartObject();
+    writer.Key( "policy_type_id" );
+    writer.Int( policy_type_id );
+    writer.Key( "policy_instance_id" );
+    writer.String( policy_instance_id.c_str() );
+    writer.Key( "handler_id" );
+    writer.String( handler_id.c_str() );
+    writer.Key( "status" );
+    writer.String( status.c_str() );
+    writer.EndObject();
+
+    return s.GetString();
+}
+
+/*
+    Builds the payload of an A1_POLICY_QUERY message, which asks the
+    A1 Mediator to send again all instances of the policy type.
+*/
+std::string A1Responder::build_query( int policy_type_id ) {
+    rapidjson::StringBuffer s;
+    rapidjson::Writer<rapidjson::StringBuffer> writer( s );
+
+    writer.StartObject();
+    writer.Key( "policy_type_id" );
+    writer.Int( policy_type_id );
+    writer.EndObject();
+
+    return s.GetString();
+}
+
+} // namespace
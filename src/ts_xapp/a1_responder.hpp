@@ -0,0 +1,80 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	a1_responder.hpp
+    Abstract:	Header for the A1 policy status responder. Statuses are queued
+                by the policy callback and sent to the A1 Mediator in batches
+                from a separate thread.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _A1_RESPONDER_HPP
+#define _A1_RESPONDER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "policy_store.hpp"
+
+namespace ts {
+
+// values of the "status" field in A1_POLICY_RESP messages
+const std::string A1_STATUS_OK = "OK";
+const std::string A1_STATUS_ERROR = "ERROR";
+const std::string A1_STATUS_DELETED = "DELETED";
+
+// sends each A1_POLICY_RESP payload of a batch
+typedef std::function<void( const std::vector<std::string> & )> a1_sender_t;
+
+class A1Responder {
+    private:
+        std::string handler_id;
+        std::chrono::milliseconds linger;
+        a1_sender_t sender;
+
+        std::mutex pending_mutex;
+        std::condition_variable pending_cv;
+        std::map<policy_key_t, std::string> pending;   // latest status of each instance
+        bool stopping = false;
+        std::thread flusher;
+
+        void flush_loop( );
+
+    public:
+        A1Responder( const std::string &handler_id, std::chrono::milliseconds linger, a1_sender_t sender );
+        ~A1Responder();
+
+        void enqueue( int policy_type_id, const std::string &policy_instance_id, const std::string &status );
+
+        static std::string build_response( const std::string &handler_id, int policy_type_id,
+                                           const std::string &policy_instance_id, const std::string &status );
+        static std::string build_query( int policy_type_id );
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,368 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	batch_assign.cpp
+    Abstract:	Implements the batch assignment of UEs to target cells.
+                Built with optimisations even when the rest of the xApp is
+                not (see CMakeLists.txt), the solver relies on them.
+
+    Date:       18 Oct 2026
+*/
+
+#include "batch_assign.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <iostream>
+
+namespace ts {
+
+namespace {
+
+const size_t BLOCK = 16;        // cells tested at once
+
+// four lanes, a SSE or NEON register; loads from any float boundary
+typedef float v4sf __attribute__(( vector_size( 16 ), aligned( 4 ), may_alias ));
+typedef int v4si __attribute__(( vector_size( 16 ) ));
+
+// bit j set if cell j of the block beats floor
+inline uint32_t block_beats( const float *b, float floor ) {
+    v4sf f = { floor, floor, floor, floor };
+    uint32_t mask = 0;
+
+    for( int i = 0; i < 4; i++ ) {
+        v4si gt = *(const v4sf *) ( b + 4 * i ) > f;
+        mask |= ( ( gt[0] & 1 ) | ( gt[1] & 2 ) | ( gt[2] & 4 ) | ( gt[3] & 8 ) ) << ( 4 * i );
+    }
+
+    return mask;
+}
+
+/*
+    Finds the best k cells of a row that beat floor, best first, and pads
+    cols with -1 if fewer qualify.
+*/
+void top_cells( const float *row, size_t stride, float floor, int k, int *cols ) {
+    float vals[MAX_BATCH_CANDIDATES];
+    int found = 0;
+
+    for( size_t block = 0; block < stride; block += BLOCK ) {
+        const float *b = row + block;
+
+        for( uint32_t mask = block_beats( b, floor ); mask != 0; mask &= mask - 1 ) {
+            size_t j = __builtin_ctz( mask );
+            float t = b[j];
+            if( t <= floor ) {  // the floor rose since the block was tested
+                continue;
+            }
+
+            int pos = found < k ? found : k - 1;    // once full, the worst candidate is dropped
+            while( pos > 0 && vals[pos - 1] < t ) {
+                vals[pos] = vals[pos - 1];
+                cols[pos] = cols[pos - 1];
+                pos--;
+            }
+            vals[pos] = t;
+            cols[pos] = (int) ( block + j );
+
+            if( found < k ) {
+                found++;
+            }
+            if( found == k ) {
+                floor = vals[k - 1];
+            }
+        }
+    }
+
+    for( int i = found; i < k; i++ ) {
+        cols[i] = -1;
+    }
+}
+
+} // namespace
+
+void assign_problem::reset( size_t ues, size_t cells ) {
+    this->ues = ues;
+    this->cells = cells;
+    stride = ( cells + BLOCK - 1 ) / BLOCK * BLOCK;
+
+    throughput.assign( ues * stride, -1.0f );
+    serving.assign( ues, 0 );
+    above.assign( ues, 0 );
+    capacity.assign( cells, 0 );
+}
+
+size_t solve_assignment( const assign_problem_t &problem, int threads, int candidates, std::vector<int> &assignment ) {
+    size_t n = problem.ues;
+    int k = std::max( 1, std::min( candidates, MAX_BATCH_CANDIDATES ) );
+    std::vector<int> cand( n * k );
+
+    // the candidates of each UE; rows are independent, so they are split among threads
+    auto pick = [&]( size_t first, size_t last ) {
+        for( size_t u = first; u < last; u++ ) {
+            top_cells( problem.row( u ), problem.stride, std::max( problem.above[u], 0.0f ), k, &cand[u * k] );
+        }
+    };
+
+    size_t nthreads = std::max<size_t>( 1, std::min<size_t>( std::max( threads, 1 ), n / 512 ) );    // a thread is not worth less rows
+    size_t chunk = ( n + nthreads - 1 ) / nthreads;
+    std::vector<std::thread> workers;
+    for( size_t t = 1; t < nthreads; t++ ) {
+        workers.emplace_back( pick, std::min( n, t * chunk ), std::min( n, ( t + 1 ) * chunk ) );
+    }
+    pick( 0, std::min( n, chunk ) );
+    for( std::thread &w : workers ) {
+        w.join();
+    }
+
+    /*
+        Deferred acceptance: each round, UEs without a cell propose to their
+        next candidate; a cell holds the UEs gaining the most from it, up to
+        its capacity, and turns the others down. A UE proposes at most k
+        times, so there are at most k rounds.
+    */
+    auto gain = [&]( int u, int c ) { return problem.row( u )[c] - problem.serving[u]; };
+
+    std::vector<int> next( n, 0 );
+    std::vector<std::vector<int>> held( problem.cells );
+    std::vector<std::vector<int>> offers( problem.cells );
+    std::vector<int> proposing;
+    std::vector<int> touched;
+
+    for( size_t u = 0; u < n; u++ ) {
+        if( cand[u * k] >= 0 ) {
+            proposing.push_back( (int) u );
+        }
+    }
+
+    while( !proposing.empty() ) {
+        touched.clear();
+        for( int u : proposing ) {
+            while( next[u] < k ) {
+                int c = cand[u * k + next[u]++];
+                if( c < 0 ) {
+                    next[u] = k;
+                    break;
+                }
+                if( problem.capacity[c] <= 0 ) {
+                    continue;
+                }
+                if( offers[c].empty() ) {
+                    touched.push_back( c );
+                }
+                offers[c].push_back( u );
+                break;
+            }
+        }
+
+        proposing.clear();
+        for( int c : touched ) {
+            std::vector<int> &h = held[c];
+            h.insert( h.end(), offers[c].begin(), offers[c].end() );
+            offers[c].clear();
+
+            size_t cap = problem.capacity[c];
+            if( h.size() > cap ) {
+                std::nth_element( h.begin(), h.begin() + cap, h.end(), [&]( int a, int b ) {
+                    float ga = gain( a, c );
+                    float gb = gain( b, c );
+                    return ga > gb || ( ga == gb && a < b );
+                } );
+                proposing.insert( proposing.end(), h.begin() + cap, h.end() );
+                h.resize( cap );
+            }
+        }
+    }
+
+    size_t handoffs = 0;
+    assignment.assign( n, -1 );
+    for( size_t c = 0; c < problem.cells; c++ ) {
+        for( int u : held[c] ) {
+            assignment[u] = (int) c;
+            handoffs++;
+        }
+    }
+
+    return handoffs;
+}
+
+BatchAssigner::BatchAssigner( const batch_opts_t &opts, const batch_hooks_t &hooks ) : opts( opts ), hooks( hooks ) {
+    if( this->opts.threads <= 0 ) {
+        this->opts.threads = std::max( 1u, std::thread::hardware_concurrency() );
+    }
+    if( this->opts.max_ues == 0 ) {
+        this->opts.max_ues = 1;
+    }
+
+    solver = std::thread( &BatchAssigner::solve_loop, this );
+}
+
+BatchAssigner::~BatchAssigner( ) {
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        stopping = true;
+    }
+    cv.notify_all();
+
+    if( solver.joinable() ) {
+        solver.join();
+    }
+}
+
+void BatchAssigner::add( const std::string &ue_id, const std::string &serving_cell_id, float serving, float above,
+                         const std::unordered_map<std::string, int> &throughput ) {
+    bool notify;
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+
+        if( current.ues.empty() ) {
+            first_at = std::chrono::steady_clock::now();
+        }
+
+        // columns are numbered as cells show up, so the solver does no string lookups
+        pending p;
+        p.ue_id = ue_id;
+        p.serving_cell_id = serving_cell_id;
+        p.serving = serving;
+        p.above = above;
+        p.cells.reserve( throughput.size() );
+        for( const auto &cell : throughput ) {
+            auto column = current.columns.emplace( cell.first, (int) current.cell_ids.size() );
+            if( column.second ) {
+                current.cell_ids.push_back( cell.first );
+            }
+            p.cells.emplace_back( column.first->second, (float) cell.second );
+        }
+
+        // a newer prediction of a UE in the batch replaces the older one, so the UE gets one control request
+        auto row = current.rows.emplace( ue_id, current.ues.size() );
+        if( row.second ) {
+            current.ues.push_back( std::move( p ) );
+        } else {
+            current.ues[row.first->second] = std::move( p );
+        }
+
+        // the first UE starts the window, the last one ends it
+        notify = current.ues.size() == 1 || current.ues.size() >= opts.max_ues;
+    }
+
+    if( notify ) {
+        cv.notify_one();
+    }
+}
+
+void BatchAssigner::solve_loop( ) {
+    auto next_log = std::chrono::steady_clock::now() + opts.stats_interval;
+    std::unique_lock<std::mutex> lock( mutex );
+
+    for( ;; ) {
+        if( current.ues.empty() ) {
+            cv.wait_for( lock, std::chrono::seconds( 1 ), [this]{ return stopping || !current.ues.empty(); } );
+        } else {
+            cv.wait_until( lock, first_at + opts.window, [this]{ return stopping || current.ues.size() >= opts.max_ues; } );
+        }
+
+        // the batch collected when stopping is solved too
+        if( !current.ues.empty() && ( stopping || current.ues.size() >= opts.max_ues ||
+                                      std::chrono::steady_clock::now() >= first_at + opts.window ) ) {
+            batch b;
+            std::swap( b, current );
+
+            lock.unlock();
+            solve( b );
+            lock.lock();
+        }
+
+        if( stopping ) {
+            break;
+        }
+        if( opts.stats_interval.count() > 0 && std::chrono::steady_clock::now() >= next_log ) {
+            log_stats();
+            next_log = std::chrono::steady_clock::now() + opts.stats_interval;
+        }
+    }
+}
+
+// fills the matrix of a batch, solves it and sends the control requests of the UEs assigned to a cell
+void BatchAssigner::solve( batch &b ) {
+    auto start = std::chrono::steady_clock::now();
+
+    assign_problem_t problem;
+    problem.reset( b.ues.size(), b.cell_ids.size() );
+    for( size_t c = 0; c < b.cell_ids.size(); c++ ) {
+        if( !hooks.cell_open || hooks.cell_open( b.cell_ids[c] ) ) {
+            problem.capacity[c] = opts.cell_capacity > 0 ? opts.cell_capacity : INT_MAX;
+        }
+    }
+    for( size_t u = 0; u < b.ues.size(); u++ ) {
+        float *row = problem.row( u );
+        for( const auto &cell : b.ues[u].cells ) {
+            row[cell.first] = cell.second;
+        }
+        problem.serving[u] = b.ues[u].serving;
+        problem.above[u] = b.ues[u].above;
+    }
+
+    std::vector<int> assignment;
+    size_t assigned = solve_assignment( problem, opts.threads, opts.candidates, assignment );
+
+    uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start ).count();
+    batches.fetch_add( 1, std::memory_order_relaxed );
+    ues.fetch_add( b.ues.size(), std::memory_order_relaxed );
+    handoffs.fetch_add( assigned, std::memory_order_relaxed );
+    solve_us.fetch_add( elapsed, std::memory_order_relaxed );
+    if( elapsed > max_solve_us.load( std::memory_order_relaxed ) ) {    // only this thread writes it
+        max_solve_us.store( elapsed, std::memory_order_relaxed );
+    }
+
+    for( size_t u = 0; u < b.ues.size(); u++ ) {
+        if( assignment[u] >= 0 ) {
+            hooks.send_control( b.ues[u].ue_id, b.ues[u].serving_cell_id, b.cell_ids[assignment[u]] );
+        }
+    }
+}
+
+batch_stats_t BatchAssigner::get_stats( ) const {
+    batch_stats_t stats;
+
+    stats.batches = batches.load( std::memory_order_relaxed );
+    stats.ues = ues.load( std::memory_order_relaxed );
+    stats.handoffs = handoffs.load( std::memory_order_relaxed );
+    stats.solve_us = solve_us.load( std::memory_order_relaxed );
+    stats.max_solve_us = max_solve_us.load( std::memory_order_relaxed );
+
+    return stats;
+}
+
+void BatchAssigner::log_stats( ) {
+    batch_stats_t stats = get_stats();
+
+    if( stats.batches == last_logged ) {
+        return;     // no batch was solved since the last time
+    }
+    last_logged = stats.batches;
+
+    std::cout << "[INFO] Batch decisions: " << stats.batches << " batches, " << stats.ues << " UEs, "
+              << stats.handoffs << " handoffs, " << ( stats.batches > 0 ? stats.solve_us / stats.batches : 0 )
+              << " us average and " << stats.max_solve_us << " us longest solve" << std::endl;
+}
+
+} // namespace
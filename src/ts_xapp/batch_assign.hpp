@@ -0,0 +1,162 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	batch_assign.hpp
+    Abstract:	Header for the batch decision mode. During mass anomaly
+                events, the UEs whose prediction qualifies them for a
+                handoff are collected for a short window and assigned to
+                target cells jointly, so no cell takes more UEs than its
+                capacity, instead of each UE going to its own best cell.
+
+                The solver works on a dense UE x cell matrix of predicted
+                throughput. A parallel pass picks the few best qualifying
+                cells of each UE: rows are scanned in blocks of cells,
+                compared at once with the worst candidate found so far in
+                SIMD lanes, and only the cells beating it are looked at one
+                by one. Then UEs propose to their candidates in turn
+                (deferred acceptance): a full cell keeps the UEs that gain
+                the most from it and turns the others down, which then
+                propose to their next candidate.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _BATCH_ASSIGN_HPP
+#define _BATCH_ASSIGN_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ts {
+
+const int MAX_BATCH_CANDIDATES = 16;
+
+typedef struct assign_problem {
+    size_t ues = 0;
+    size_t cells = 0;
+    size_t stride = 0;                  // floats in a row, cells rounded up to a whole block
+    std::vector<float> throughput;      // row major, ues x stride; < 0 where there is no prediction
+    std::vector<float> serving;         // throughput of each UE in its serving cell
+    std::vector<float> above;           // throughput a target of each UE must beat
+    std::vector<int> capacity;          // UEs each cell takes
+
+    // sizes the problem; every throughput is set to -1 and every capacity to 0
+    void reset( size_t ues, size_t cells );
+    float *row( size_t ue ) { return &throughput[ue * stride]; }
+    const float *row( size_t ue ) const { return &throughput[ue * stride]; }
+} assign_problem_t;
+
+/*
+    Assigns UEs to cells: assignment[ue] is the column of the target cell,
+    or -1 if the UE stays in its cell. Each UE is only considered for its
+    best `candidates` qualifying cells. Returns the number of handoffs.
+*/
+size_t solve_assignment( const assign_problem_t &problem, int threads, int candidates, std::vector<int> &assignment );
+
+typedef struct batch_opts {
+    size_t max_ues = 10000;             // a batch is solved once it holds this many UEs
+    std::chrono::milliseconds window { 20 };    // or once its first UE waited this long
+    int cell_capacity = 0;              // handoffs each cell takes per batch; 0 leaves cells uncapped
+    int threads = 0;                    // threads of the solver; 0 uses one per CPU
+    int candidates = 4;                 // best cells each UE is considered for, up to MAX_BATCH_CANDIDATES
+    std::chrono::seconds stats_interval { 10 };         // 0 disables the periodic stats log
+} batch_opts_t;
+
+typedef struct batch_hooks {
+    // false if the cell cannot take any UE
+    std::function<bool( const std::string &cell_id )> cell_open;
+    std::function<bool( const std::string &ue_id, const std::string &serving_cell_id,
+                        const std::string &target_cell_id )> send_control;
+} batch_hooks_t;
+
+typedef struct batch_stats {
+    uint64_t batches = 0;
+    uint64_t ues = 0;                   // UEs that qualified for a handoff
+    uint64_t handoffs = 0;              // UEs assigned to a target cell
+    uint64_t solve_us = 0;              // time spent building and solving batches
+    uint64_t max_solve_us = 0;
+} batch_stats_t;
+
+class BatchAssigner {
+    private:
+        struct pending {
+            std::string ue_id;
+            std::string serving_cell_id;
+            float serving = 0;
+            float above = 0;
+            std::vector<std::pair<int, float>> cells;   // (column, throughput)
+        };
+
+        // UEs collected so far, and the cells they were predicted in
+        struct batch {
+            std::vector<pending> ues;
+            std::unordered_map<std::string, size_t> rows;       // UE id -> its entry in ues
+            std::vector<std::string> cell_ids;
+            std::unordered_map<std::string, int> columns;
+        };
+
+        batch_opts_t opts;
+        batch_hooks_t hooks;
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        batch current;
+        std::chrono::steady_clock::time_point first_at;     // arrival of the first UE of the batch
+        bool stopping = false;
+        std::thread solver;
+
+        std::atomic<uint64_t> batches { 0 };
+        std::atomic<uint64_t> ues { 0 };
+        std::atomic<uint64_t> handoffs { 0 };
+        std::atomic<uint64_t> solve_us { 0 };
+        std::atomic<uint64_t> max_solve_us { 0 };
+        uint64_t last_logged = 0;
+
+        void solve_loop( );
+        void solve( batch &b );
+        void log_stats( );
+
+    public:
+        BatchAssigner( const batch_opts_t &opts, const batch_hooks_t &hooks );
+        ~BatchAssigner();           // solves the batch being collected, if any
+
+        /*
+            Adds a UE that qualifies for a handoff: throughput holds the
+            cells it may go to, and above what a target must beat. A UE
+            added again before its batch is solved replaces its entry.
+        */
+        void add( const std::string &ue_id, const std::string &serving_cell_id, float serving, float above,
+                  const std::unordered_map<std::string, int> &throughput );
+
+        batch_stats_t get_stats( ) const;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,287 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	handlers_bench.cpp
+    Abstract:	Microbenchmarks of the per message work of the TS xApp: the
+                SAX handlers on representative and worst case payloads, and
+                the handoff decision kernel on a growing number of neighbor
+                cells. The reported time is the cost of one message, except
+                for the batch assignment solver.
+
+                The payloads follow what the AD and QP xApps, the A1
+                Mediator and the E2 manager send; the benchmark argument is
+                the number of cells, UEs or nodebs in the message.
+
+    Date:       18 Oct 2026
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <rapidjson/reader.h>
+
+#include "message_handlers.hpp"
+#include "handoff_decision.hpp"
+#include "batch_assign.hpp"
+
+using namespace std;
+
+namespace {
+
+uint64_t lcg_state = 42;
+
+// deterministic values, so runs are comparable
+int next_rand( int lo, int hi ) {
+    lcg_state = lcg_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return lo + (int) ( ( lcg_state >> 33 ) % (uint64_t) ( hi - lo + 1 ) );
+}
+
+string cell_id( int n ) {
+    char buf[32];
+    snprintf( buf, sizeof( buf ), "310-680-200-%06d", 555001 + n );
+    return buf;
+}
+
+string base64_encode( const string &in ) {
+    static const char *chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    string out;
+    int val = 0, valb = -6;
+
+    for( unsigned char c : in ) {
+        val = ( val << 8 ) + c;
+        valb += 8;
+        while( valb >= 0 ) {
+            out.push_back( chars[( val >> valb ) & 0x3F] );
+            valb -= 6;
+        }
+    }
+    if( valb > -6 ) {
+        out.push_back( chars[( ( val << 8 ) >> ( valb + 8 ) ) & 0x3F] );
+    }
+    while( out.size() % 4 ) {
+        out.push_back( '=' );
+    }
+
+    return out;
+}
+
+// A1 policy, optionally scoped to ncells cells
+string policy_payload( int ncells ) {
+    string json = "{\"operation\": \"CREATE\", \"policy_type_id\": 20008, \"policy_instance_id\": \"tsapolicy145\", "
+                  "\"payload\": {\"threshold\": 5";
+    if( ncells > 0 ) {
+        json += ", \"scope\": {\"cell_ids\": [";
+        for( int i = 0; i < ncells; i++ ) {
+            json += ( i ? ", \"" : "\"" ) + cell_id( i ) + "\"";
+        }
+        json += "]}";
+    }
+    json += "}}";
+
+    return json;
+}
+
+// QP prediction of one UE, the first cell is the serving one
+string prediction_payload( int ncells ) {
+    string json = "{\"12345\": {";
+    for( int i = 0; i < ncells; i++ ) {
+        json += ( i ? ", \"" : "\"" ) + cell_id( i ) + "\": [" + to_string( next_rand( 0, 99 ) ) + ", " +
+                to_string( next_rand( 0, 99 ) ) + "]";
+    }
+    json += "}}";
+
+    return json;
+}
+
+// AD anomaly list of nues UEs
+string anomaly_payload( int nues ) {
+    string json = "[";
+    for( int i = 0; i < nues; i++ ) {
+        json += ( i ? ", " : "" ) + string( "{\"du-id\": 1010, \"ue-id\": \"" ) + to_string( 12345 + i ) +
+                "\", \"measTimeStampRf\": 1620835470108, \"Degradation\": \"RSRP RSSINR\"}";
+    }
+    json += "]";
+
+    return json;
+}
+
+// E2 manager reply to GET /v1/nodeb/states
+string nodeb_list_payload( int nnodebs ) {
+    char buf[256];
+    string json = "[";
+    for( int i = 0; i < nnodebs; i++ ) {
+        snprintf( buf, sizeof( buf ), "%s{\"inventoryName\": \"gnb_734_733_%08x\", \"globalNbId\": {\"plmnId\": \"373437\", "
+                  "\"nbId\": \"10110101110001100111011110001\"}, \"connectionStatus\": \"CONNECTED\"}", i ? ", " : "", 0xb5c60000 + i );
+        json += buf;
+    }
+    json += "]";
+
+    return json;
+}
+
+/*
+    E2 manager reply to GET /v1/nodeb/<ran name>, with ncells cells of the
+    nodeb embedded in an E2 setup request part of about part_size bytes
+*/
+string nodeb_payload( int ncells, int part_size ) {
+    const string nb = "B5C67788";
+    string part;
+    int stride = ncells > 0 ? part_size / ncells : part_size;
+
+    // lower case filler never matches the (upper case) nodeb id
+    auto fill = [&]( int size ) {
+        while( (int) part.size() < size ) {
+            part.push_back( "0123456789abcdef"[next_rand( 0, 15 )] );
+        }
+    };
+
+    for( int i = 0; i < ncells; i++ ) {
+        char cell[16];
+        fill( i * stride );
+        snprintf( cell, sizeof( cell ), "%s%02X", nb.c_str(), i );
+        part += cell;
+    }
+    fill( part_size );
+
+    return "{\"ranName\": \"gnb_734_733_b5c67788\", \"connectionStatus\": \"CONNECTED\", "
+           "\"globalNbId\": {\"plmnId\": \"373437\", \"nbId\": \"10110101110001100111011110001\"}, "
+           "\"gnb\": {\"nodeConfigs\": [{\"e2nodeComponentInterfaceType\": \"ng\", \"e2nodeComponentConfiguration\": "
+           "{\"e2nodeComponentRequestPart\": \"" + base64_encode( part ) + "\", \"e2nodeComponentResponsePart\": \"AA==\"}}]}}";
+}
+
+template<typename Handler>
+void parse( benchmark::State &state, const string &json ) {
+    for( auto _ : state ) {
+        Handler handler;
+        rapidjson::Reader reader;
+        rapidjson::StringStream ss( json.c_str() );
+        reader.Parse( ss, handler );
+        benchmark::DoNotOptimize( &handler );
+    }
+
+    state.SetItemsProcessed( state.iterations() );
+    state.SetBytesProcessed( state.iterations() * json.size() );
+}
+
+void BM_PolicyHandler( benchmark::State &state ) {
+    parse<PolicyHandler>( state, policy_payload( state.range( 0 ) ) );
+}
+BENCHMARK( BM_PolicyHandler )->ArgName( "cells" )->Arg( 0 )->Arg( 1 )->Arg( 64 );
+
+void BM_PredictionHandler( benchmark::State &state ) {
+    parse<PredictionHandler>( state, prediction_payload( state.range( 0 ) ) );
+}
+BENCHMARK( BM_PredictionHandler )->ArgName( "cells" )->Arg( 3 )->Arg( 16 )->Arg( 64 )->Arg( 256 );
+
+void BM_AnomalyHandler( benchmark::State &state ) {
+    parse<AnomalyHandler>( state, anomaly_payload( state.range( 0 ) ) );
+}
+BENCHMARK( BM_AnomalyHandler )->ArgName( "ues" )->Arg( 1 )->Arg( 100 )->Arg( 1000 );
+
+void BM_NodebListHandler( benchmark::State &state ) {
+    parse<NodebListHandler>( state, nodeb_list_payload( state.range( 0 ) ) );
+}
+BENCHMARK( BM_NodebListHandler )->ArgName( "nodebs" )->Arg( 4 )->Arg( 1000 );
+
+void BM_NodebHandler( benchmark::State &state ) {
+    parse<NodebHandler>( state, nodeb_payload( state.range( 0 ), state.range( 1 ) ) );
+}
+BENCHMARK( BM_NodebHandler )->ArgNames( { "cells", "part_bytes" } )->Args( { 3, 1 << 10 } )->Args( { 64, 64 << 10 } );
+
+/*
+    Decision kernel alone, on the map built by PredictionHandler. The
+    argument is the number of neighbors of the serving cell.
+*/
+void BM_DecideHandoff( benchmark::State &state ) {
+    PredictionHandler handler;
+    rapidjson::Reader reader;
+    string json = prediction_payload( state.range( 0 ) + 1 );
+    rapidjson::StringStream ss( json.c_str() );
+    reader.Parse( ss, handler );
+
+    ts::handoff_decision_t decision;
+    for( auto _ : state ) {
+        ts::decide_handoff( handler.cell_pred_down, handler.serving_cell_id, 10, decision );
+        benchmark::DoNotOptimize( decision.handoff );
+    }
+
+    state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_DecideHandoff )->ArgName( "neighbors" )->RangeMultiplier( 2 )->Range( 1, 256 );
+
+// prediction message end to end: parse and decide
+void BM_PredictionDecision( benchmark::State &state ) {
+    string json = prediction_payload( state.range( 0 ) + 1 );
+    ts::handoff_decision_t decision;
+
+    for( auto _ : state ) {
+        PredictionHandler handler;
+        rapidjson::Reader reader;
+        rapidjson::StringStream ss( json.c_str() );
+        reader.Parse( ss, handler );
+        ts::decide_handoff( handler.cell_pred_down, handler.serving_cell_id, 10, decision );
+        benchmark::DoNotOptimize( decision.handoff );
+    }
+
+    state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_PredictionDecision )->ArgName( "neighbors" )->RangeMultiplier( 4 )->Range( 1, 256 );
+
+/*
+    Batch assignment of a mass anomaly event: UEs x cells of predicted
+    throughput, cells capped at twice their fair share of handoffs. The
+    reported time is the cost of one batch.
+*/
+void BM_SolveAssignment( benchmark::State &state ) {
+    size_t ues = state.range( 0 );
+    size_t cells = state.range( 1 );
+
+    ts::assign_problem_t problem;
+    problem.reset( ues, cells );
+    for( size_t u = 0; u < ues; u++ ) {
+        float *row = problem.row( u );
+        for( size_t c = 0; c < cells; c++ ) {
+            row[c] = next_rand( 1000, 5000000 );
+        }
+        problem.serving[u] = row[next_rand( 0, cells - 1 )];
+        problem.above[u] = problem.serving[u] * 1.1f;
+    }
+    for( size_t c = 0; c < cells; c++ ) {
+        problem.capacity[c] = 2 * ues / cells;
+    }
+
+    vector<int> assignment;
+    for( auto _ : state ) {
+        benchmark::DoNotOptimize( ts::solve_assignment( problem, state.range( 2 ), 4, assignment ) );
+    }
+
+    state.SetItemsProcessed( state.iterations() * ues );
+}
+BENCHMARK( BM_SolveAssignment )->ArgNames( { "ues", "cells", "threads" } )
+    ->Args( { 1000, 64, 1 } )->Args( { 10000, 64, 1 } )->Args( { 10000, 64, 4 } )
+    ->Unit( benchmark::kMicrosecond )->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,199 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	capture_log.cpp
+    Abstract:	Implements the capture writer and reader, and the replay
+                driver that paces the captured messages into the callbacks.
+
+    Date:       18 Oct 2026
+*/
+
+#include "capture_log.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace ts {
+
+namespace {
+
+uint64_t now_ns( ) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch() ).count();
+}
+
+template<typename T>
+T load( const char *p ) {
+    T v;
+    memcpy( &v, p, sizeof( v ) );
+    return v;
+}
+
+template<typename T>
+void store( char *p, T v ) {
+    memcpy( p, &v, sizeof( v ) );
+}
+
+} // namespace
+
+/*
+    Opens the capture for appending; the file header is only written to a
+    new (empty) file, so a restarted xApp keeps adding to the same capture.
+*/
+CaptureWriter::CaptureWriter( const std::string &path ) {
+    file = fopen( path.c_str(), "ab" );
+    if( file == nullptr ) {
+        return;
+    }
+
+    buffer.resize( 1 << 20 );
+    setvbuf( file, buffer.data(), _IOFBF, buffer.size() );
+
+    if( ftell( file ) == 0 ) {
+        char header[CAPTURE_FILE_HEADER_SIZE] = { 0 };
+        store<uint32_t>( header, CAPTURE_MAGIC );
+        store<uint16_t>( header + 4, CAPTURE_VERSION );
+        fwrite( header, 1, sizeof( header ), file );
+    }
+}
+
+CaptureWriter::~CaptureWriter( ) {
+    if( file != nullptr ) {
+        fclose( file );
+    }
+}
+
+void CaptureWriter::append( int mtype, const void *payload, uint32_t len ) {
+    if( file == nullptr ) {
+        return;
+    }
+
+    uint64_t ts = now_ns();
+    char header[CAPTURE_RECORD_HEADER_SIZE];
+    store<uint64_t>( header, ts );
+    store<int32_t>( header + 8, mtype );
+    store<uint32_t>( header + 12, len );
+
+    std::lock_guard<std::mutex> lock( write_mutex );
+    fwrite( header, 1, sizeof( header ), file );
+    fwrite( payload, 1, len, file );
+
+    if( ts - last_flush_ns > 1000000000ULL ) {
+        fflush( file );
+        last_flush_ns = ts;
+    }
+}
+
+void CaptureWriter::flush( ) {
+    std::lock_guard<std::mutex> lock( write_mutex );
+    if( file != nullptr ) {
+        fflush( file );
+    }
+}
+
+bool CaptureReader::open( const std::string &path, std::string &error ) {
+    FILE *f = fopen( path.c_str(), "rb" );
+    if( f == nullptr ) {
+        error = "unable to open " + path + ": " + strerror( errno );
+        return false;
+    }
+
+    data.clear();
+    char buf[65536];
+    size_t n;
+    while( ( n = fread( buf, 1, sizeof( buf ), f ) ) > 0 ) {
+        data.insert( data.end(), buf, buf + n );
+    }
+    fclose( f );
+
+    if( data.size() < CAPTURE_FILE_HEADER_SIZE || load<uint32_t>( data.data() ) != CAPTURE_MAGIC ) {
+        error = path + " is not a capture file";
+        return false;
+    }
+    if( load<uint16_t>( data.data() + 4 ) != CAPTURE_VERSION ) {
+        error = path + " has an unsupported capture version " + std::to_string( load<uint16_t>( data.data() + 4 ) );
+        return false;
+    }
+
+    rewind();
+    return true;
+}
+
+bool CaptureReader::next( capture_record_t &record ) {
+    if( data.size() - offset < CAPTURE_RECORD_HEADER_SIZE ) {
+        return false;
+    }
+
+    const char *p = data.data() + offset;
+    uint32_t len = load<uint32_t>( p + 12 );
+    if( data.size() - offset - CAPTURE_RECORD_HEADER_SIZE < len ) {
+        return false;
+    }
+
+    record.timestamp_ns = load<uint64_t>( p );
+    record.mtype = load<int32_t>( p + 8 );
+    record.len = len;
+    record.payload = p + CAPTURE_RECORD_HEADER_SIZE;
+
+    offset += CAPTURE_RECORD_HEADER_SIZE + len;
+    return true;
+}
+
+replay_stats_t replay( CaptureReader &reader, double speed,
+                       const std::function<void( const capture_record_t & )> &dispatch ) {
+    using clock = std::chrono::steady_clock;
+
+    replay_stats_t stats;
+    capture_record_t record;
+    uint64_t first_ns = 0;
+    auto start = clock::now();
+
+    while( reader.next( record ) ) {
+        if( stats.messages == 0 ) {
+            first_ns = record.timestamp_ns;
+        }
+
+        auto now = clock::now();
+        if( speed > 0 && record.timestamp_ns > first_ns ) {
+            auto due = start + std::chrono::nanoseconds( (uint64_t) ( ( record.timestamp_ns - first_ns ) / speed ) );
+            if( due > now ) {
+                std::this_thread::sleep_until( due );
+                now = clock::now();
+            } else {
+                double lag = std::chrono::duration<double, std::milli>( now - due ).count();
+                if( lag > stats.max_lag_ms ) {
+                    stats.max_lag_ms = lag;
+                }
+            }
+        }
+
+        dispatch( record );
+
+        stats.latency_ns[record.mtype].push_back( std::chrono::duration_cast<std::chrono::nanoseconds>( clock::now() - now ).count() );
+        stats.messages++;
+    }
+
+    stats.elapsed_s = std::chrono::duration<double>( clock::now() - start ).count();
+    return stats;
+}
+
+} // namespace
@@ -0,0 +1,112 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	capture_log.hpp
+    Abstract:	Header for the capture of inbound RMR messages and for their
+                replay. A capture is a binary log of the messages received by
+                the callbacks, with the time they were received, so the same
+                traffic can be fed again to the callbacks without RMR.
+
+                Layout (native byte order, little endian on all our targets):
+                    file header  magic u32 "TSCP", version u16, reserved u16
+                    each record  receive time u64 (ns since the epoch),
+                                 message type i32, payload length u32,
+                                 payload bytes
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _CAPTURE_LOG_HPP
+#define _CAPTURE_LOG_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ts {
+
+const uint32_t CAPTURE_MAGIC = 0x50435354;     // "TSCP" when read as bytes
+const uint16_t CAPTURE_VERSION = 1;
+const size_t CAPTURE_FILE_HEADER_SIZE = 8;
+const size_t CAPTURE_RECORD_HEADER_SIZE = 16;
+
+typedef struct capture_record {
+    uint64_t timestamp_ns;
+    int mtype;
+    const char *payload;        // points into the reader's buffer
+    uint32_t len;
+} capture_record_t;
+
+/*
+    Appends messages to a capture file. Writes are buffered and flushed at
+    most once a second, so appending costs a copy in the caller's thread.
+*/
+class CaptureWriter {
+    private:
+        std::mutex write_mutex;
+        FILE *file = nullptr;
+        std::vector<char> buffer;       // stdio buffer of the file
+        uint64_t last_flush_ns = 0;
+
+    public:
+        CaptureWriter( const std::string &path );
+        ~CaptureWriter();
+
+        bool is_open( ) const { return file != nullptr; }
+        void append( int mtype, const void *payload, uint32_t len );
+        void flush( );
+};
+
+/*
+    Loads a whole capture in memory, so reading it does not add I/O to the
+    replay. A truncated last record (e.g. the xApp was killed) is ignored.
+*/
+class CaptureReader {
+    private:
+        std::vector<char> data;
+        size_t offset = CAPTURE_FILE_HEADER_SIZE;
+
+    public:
+        bool open( const std::string &path, std::string &error );
+        bool next( capture_record_t &record );
+        void rewind( ) { offset = CAPTURE_FILE_HEADER_SIZE; }
+};
+
+typedef struct replay_stats {
+    uint64_t messages = 0;
+    double elapsed_s = 0;
+    double max_lag_ms = 0;              // how late a message was dispatched, paced replays only
+    std::map<int, std::vector<uint32_t>> latency_ns;    // time spent in dispatch, per message type
+} replay_stats_t;
+
+/*
+    Feeds each record of the capture to dispatch, keeping the original
+    spacing divided by speed. A speed of 0 replays as fast as possible.
+*/
+replay_stats_t replay( CaptureReader &reader, double speed,
+                       const std::function<void( const capture_record_t & )> &dispatch );
+
+} // namespace
+
+#endif
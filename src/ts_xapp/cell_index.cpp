@@ -0,0 +1,76 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	cell_index.cpp
+    Abstract:	Implements the dense index of cell ids.
+
+    Date:       18 Oct 2026
+*/
+
+#include "cell_index.hpp"
+
+#include <iostream>
+
+namespace ts {
+
+CellIndex::CellIndex( size_t max_cells ) : max_cells( max_cells ), ids( std::make_shared<const ids_t>() ) {
+}
+
+int CellIndex::find( const std::string &cell_id ) const {
+    std::shared_ptr<const ids_t> current = ids.load();
+
+    auto it = current->find( cell_id );
+    return it == current->end() ? NO_CELL : it->second;
+}
+
+int CellIndex::intern( const std::string &cell_id ) {
+    int index = find( cell_id );
+    if( index != NO_CELL ) {
+        return index;
+    }
+
+    std::lock_guard<std::mutex> lock( intern_mutex );
+    std::shared_ptr<const ids_t> current = ids.load();
+
+    auto it = current->find( cell_id );     // another writer may have added it meanwhile
+    if( it != current->end() ) {
+        return it->second;
+    }
+    if( current->size() >= max_cells ) {
+        if( !full_logged ) {
+            std::cout << "[ERROR] Cell index is full (" << max_cells << " cells), cell " << cell_id << " and later ones are not indexed" << std::endl;
+            full_logged = true;
+        }
+        return NO_CELL;
+    }
+
+    std::shared_ptr<ids_t> next = std::make_shared<ids_t>( *current );
+    index = (int) next->size();
+    next->emplace( cell_id, index );
+    ids.store( next );
+
+    return index;
+}
+
+size_t CellIndex::size( ) const {
+    return ids.load()->size();
+}
+
+} // namespace
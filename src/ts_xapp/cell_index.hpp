@@ -0,0 +1,70 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	cell_index.hpp
+    Abstract:	Header for the dense index of cell ids. Each cell id is given
+                the next free index the first time it is seen, and keeps it
+                for the life of the process; per cell state can then live in
+                flat arrays, and a cell id is hashed once (when a message is
+                decoded or a policy applied) rather than at every lookup.
+
+                Lookups load an immutable map without taking any lock. New
+                cells copy the map, which only happens while the set of
+                cells is being discovered.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _CELL_INDEX_HPP
+#define _CELL_INDEX_HPP
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "snapshot_slot.hpp"
+
+namespace ts {
+
+const int NO_CELL = -1;
+
+class CellIndex {
+    private:
+        typedef std::unordered_map<std::string, int> ids_t;
+
+        size_t max_cells;
+        std::mutex intern_mutex;    // serializes writers only
+        SnapshotSlot<ids_t> ids;
+        bool full_logged = false;
+
+    public:
+        explicit CellIndex( size_t max_cells = 65536 );
+
+        // index of a cell, NO_CELL if it was never interned
+        int find( const std::string &cell_id ) const;
+        // index of a cell, given one the first time; NO_CELL once max_cells are indexed
+        int intern( const std::string &cell_id );
+        size_t size( ) const;
+};
+
+} // namespace
+
+#endif
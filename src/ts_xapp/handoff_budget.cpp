@@ -0,0 +1,132 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	handoff_budget.cpp
+    Abstract:	Implements the handoff admission budget of target cells.
+
+    Date:       18 Oct 2026
+*/
+
+#include "handoff_budget.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+namespace ts {
+
+HandoffBudget::HandoffBudget( const budget_opts_t &opts ) : opts( opts ), next_log( clock::now() + opts.stats_interval ) {
+    int64_t interval_ns = std::chrono::duration_cast<std::chrono::nanoseconds>( opts.interval ).count();
+    int handoffs = std::max( 1, opts.handoffs );
+
+    emission_ns = std::max<int64_t>( 1, interval_ns / handoffs );
+    tolerance_ns = emission_ns * ( handoffs - 1 );
+
+    size_t size = 1;
+    while( size < 2 * std::max<size_t>( 1, opts.max_cells ) ) {    // probes stay short at half load
+        size <<= 1;
+    }
+    mask = size - 1;
+    slots = std::unique_ptr<slot[]>( new slot[size] );
+}
+
+/*
+    Returns the slot of a cell, claiming a free one the first time the cell
+    is seen; nil if the table is full.
+*/
+HandoffBudget::slot *HandoffBudget::find( const std::string &cell_id ) {
+    uint64_t key = std::hash<std::string>()( cell_id ) | 1;    // never 0, which marks a free slot
+
+    for( size_t probe = 0, i = key & mask; probe <= mask; probe++, i = ( i + 1 ) & mask ) {
+        uint64_t current = slots[i].key.load( std::memory_order_acquire );
+        if( current == key ) {
+            return &slots[i];
+        }
+        if( current == 0 ) {
+            if( slots[i].key.compare_exchange_strong( current, key, std::memory_order_acq_rel ) || current == key ) {
+                return &slots[i];
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+bool HandoffBudget::admit( const std::string &cell_id ) {
+    clock::time_point now_tp = clock::now();
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>( now_tp.time_since_epoch() ).count();
+    bool ok = true;
+
+    slot *s = find( cell_id );
+    if( s == nullptr ) {
+        untracked.fetch_add( 1, std::memory_order_relaxed );
+    } else {
+        int64_t full_at = s->full_at.load( std::memory_order_relaxed );
+        for( ;; ) {
+            int64_t next = std::max( full_at, now ) + emission_ns;
+            if( next - now > tolerance_ns + emission_ns ) {
+                ok = false;     // no token left
+                break;
+            }
+            if( s->full_at.compare_exchange_weak( full_at, next, std::memory_order_relaxed ) ) {
+                break;
+            }
+        }
+    }
+
+    ( ok ? admitted : refused ).fetch_add( 1, std::memory_order_relaxed );
+    maybe_log( now_tp );
+
+    return ok;
+}
+
+budget_stats_t HandoffBudget::get_stats( ) const {
+    budget_stats_t stats;
+
+    stats.admitted = admitted.load( std::memory_order_relaxed );
+    stats.refused = refused.load( std::memory_order_relaxed );
+    stats.fallbacks = fallbacks.load( std::memory_order_relaxed );
+    stats.untracked = untracked.load( std::memory_order_relaxed );
+
+    return stats;
+}
+
+void HandoffBudget::maybe_log( clock::time_point now ) {
+    if( opts.stats_interval.count() <= 0 ) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock( log_mutex, std::try_to_lock );
+    if( !lock.owns_lock() || now < next_log ) {
+        return;
+    }
+    next_log = now + opts.stats_interval;
+
+    budget_stats_t stats = get_stats();
+    if( stats.refused == last_logged ) {
+        return;     // no cell went over its budget since the last time
+    }
+    last_logged = stats.refused;
+
+    std::cout << "[INFO] Handoff budget: " << stats.admitted << " admitted, " << stats.refused << " refused, "
+              << stats.fallbacks << " fell back to another cell, " << stats.untracked << " in untracked cells" << std::endl;
+}
+
+} // namespace
@@ -0,0 +1,107 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	handoff_budget.hpp
+    Abstract:	Header for the admission budget of handoffs into each target
+                cell. When many UEs of a cell degrade at once, each one is
+                decided on its own and they would all pick the same best
+                neighbor; the budget caps the handoffs a cell takes per
+                interval, and the caller falls back to the next best target.
+
+                Each cell has a token bucket holding up to a budget of
+                handoffs and refilled at that budget per interval. A bucket
+                is a single atomic word, the time at which it will be full
+                again (generic cell rate algorithm), updated with a CAS.
+                Buckets live in a fixed open addressing table, one per
+                cache line, and cells are added with a CAS on the slot key,
+                so admit never takes a lock and threads deciding for
+                different cells do not share cache lines.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _HANDOFF_BUDGET_HPP
+#define _HANDOFF_BUDGET_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace ts {
+
+typedef struct budget_opts {
+    int handoffs = 0;                   // handoffs each cell takes per interval, at most
+    std::chrono::milliseconds interval { 1000 };
+    size_t max_cells = 4096;            // cells tracked; handoffs into cells over it are not limited
+    std::chrono::seconds stats_interval { 10 };         // 0 disables the periodic stats log
+} budget_opts_t;
+
+typedef struct budget_stats {
+    uint64_t admitted = 0;
+    uint64_t refused = 0;               // handoffs refused by a cell over its budget
+    uint64_t fallbacks = 0;             // UEs handed off to another cell than their best one
+    uint64_t untracked = 0;             // handoffs admitted because the table was full
+} budget_stats_t;
+
+class HandoffBudget {
+    private:
+        using clock = std::chrono::steady_clock;
+
+        struct alignas( 64 ) slot {
+            std::atomic<uint64_t> key { 0 };    // hash of the cell id, 0 if free
+            std::atomic<int64_t> full_at { 0 }; // time (ns) at which the bucket is full again
+        };
+
+        budget_opts_t opts;
+        int64_t emission_ns;                // time one token takes to come back
+        int64_t tolerance_ns;               // how far full_at can run ahead of now
+        size_t mask;
+        std::unique_ptr<slot[]> slots;
+
+        std::atomic<uint64_t> admitted { 0 };
+        std::atomic<uint64_t> refused { 0 };
+        std::atomic<uint64_t> fallbacks { 0 };
+        std::atomic<uint64_t> untracked { 0 };
+
+        std::mutex log_mutex;
+        clock::time_point next_log;
+        uint64_t last_logged = 0;
+
+        slot *find( const std::string &cell_id );
+        void maybe_log( clock::time_point now );
+
+    public:
+        explicit HandoffBudget( const budget_opts_t &opts );
+
+        // takes a token from the cell bucket; false if the cell used up its budget
+        bool admit( const std::string &cell_id );
+
+        // accounts for a UE sent to a cell other than its best one
+        void count_fallback( ) { fallbacks.fetch_add( 1, std::memory_order_relaxed ); }
+
+        budget_stats_t get_stats( ) const;
+};
+
+} // namespace
+
+#endif
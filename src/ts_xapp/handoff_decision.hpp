@@ -0,0 +1,104 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	handoff_decision.hpp
+    Abstract:	Decision kernel applied to each QP prediction: picks the cell
+                with the highest predicted throughput and hands the UE off to
+                it only if it beats the serving cell by more than the A1
+                policy threshold (a percentage of the serving throughput).
+                When the best cell cannot take the UE, rank_targets lists the
+                other cells that also qualify.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _HANDOFF_DECISION_HPP
+#define _HANDOFF_DECISION_HPP
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ts {
+
+typedef struct handoff_decision {
+    int serving_throughput = 0;
+    int highest_throughput = 0;
+    std::string highest_cell_id;    // cell with the highest prediction, might be the serving one
+    float handoff_above = 0;        // throughput a target cell must beat
+    bool handoff = false;           // true if the UE should be moved to highest_cell_id
+} handoff_decision_t;
+
+/*
+    Returns false if there is no prediction for the serving cell.
+    A threshold <= 0 means any cell better than the serving one is a target.
+*/
+inline bool decide_handoff( const std::unordered_map<std::string, int> &throughput,
+                            const std::string &serving_cell_id, int threshold, handoff_decision_t &decision ) {
+    auto serving = throughput.find( serving_cell_id );
+    if( serving == throughput.end() ) {
+        return false;
+    }
+
+    decision.serving_throughput = serving->second;
+    decision.highest_throughput = 0;
+    decision.highest_cell_id.clear();
+
+    for( const auto &cell : throughput ) {
+        if( decision.highest_throughput < cell.second ) {
+            decision.highest_throughput = cell.second;
+            decision.highest_cell_id = cell.first;
+        }
+    }
+
+    float thresh = 0;
+    if( threshold > 0 ) {
+        thresh = decision.serving_throughput * ( threshold / 100.0 );
+    }
+
+    decision.handoff_above = decision.serving_throughput + thresh;
+    decision.handoff = decision.highest_throughput > decision.handoff_above;
+
+    return true;
+}
+
+/*
+    Lists the cells that qualify as targets of a decision made on the same
+    throughput, best first.
+*/
+inline void rank_targets( const std::unordered_map<std::string, int> &throughput, const handoff_decision_t &decision,
+                          std::vector<std::pair<std::string, int>> &targets ) {
+    targets.clear();
+    for( const auto &cell : throughput ) {
+        if( cell.second > decision.handoff_above ) {
+            targets.push_back( cell );
+        }
+    }
+
+    std::sort( targets.begin(), targets.end(), []( const std::pair<std::string, int> &a, const std::pair<std::string, int> &b ) {
+        return a.second > b.second || ( a.second == b.second && a.first < b.first );
+    } );
+}
+
+} // namespace
+
+#endif
@@ -0,0 +1,323 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	handoff_workflow.cpp
+    Abstract:	Implements the handoff workflow engine. A workflow suspends
+                on an awaiter that records, in the state of its UE, what it
+                waits for and a sequence number, and arms a timer. Whatever
+                comes first, the answer or the timer, resumes it; the other
+                one then finds a different sequence number and is dropped.
+
+    Date:       18 Oct 2026
+*/
+
+#include "handoff_workflow.hpp"
+
+#ifdef TS_HANDOFF_WORKFLOWS
+
+#include <algorithm>
+#include <iostream>
+
+namespace ts {
+
+void HandoffEngine::Awaiter::await_suspend( std::coroutine_handle<> handle ) {
+    ue_state &state = engine.workflows.at( ue_id );
+
+    state.handle = handle;
+    state.waiting = kind;
+    state.wait_seq = ++engine.next_wait_seq;
+    state.timed_out = false;
+    engine.timers.push( { clock::now() + timeout, ue_id, state.wait_seq } );
+
+    if( on_suspend != nullptr ) {
+        ( *on_suspend )( state.wait_seq );
+    }
+}
+
+bool HandoffEngine::Awaiter::await_resume( ) {
+    return !engine.workflows.at( ue_id ).timed_out;
+}
+
+HandoffEngine::HandoffEngine( const workflow_opts_t &opts, const workflow_hooks_t &hooks ) :
+    opts( opts ), hooks( hooks ) {
+
+    for( int i = 0; i < std::max( 1, opts.control_workers ); i++ ) {
+        control_threads.emplace_back( &HandoffEngine::control_loop, this );
+    }
+    executor = std::thread( &HandoffEngine::run, this );
+}
+
+HandoffEngine::~HandoffEngine() {
+    {
+        std::lock_guard<std::mutex> lock( inbox_mutex );
+        stopping = true;
+    }
+    inbox_cv.notify_one();
+    executor.join();
+
+    {
+        std::lock_guard<std::mutex> lock( control_mutex );
+        control_stopping = true;
+    }
+    control_cv.notify_all();
+    for( auto &t : control_threads ) {
+        t.join();
+    }
+}
+
+/*
+    The workflow of one UE. It is started, and runs up to its first
+    co_await, before the prediction request is sent, so the prediction
+    cannot arrive before the workflow waits for it. A predicted workflow
+    already has its prediction and goes straight to the decision.
+*/
+HandoffEngine::workflow HandoffEngine::run_workflow( std::string ue_id, bool predicted ) {
+    bool answered;
+
+    if( !predicted ) {
+        answered = co_await Awaiter { *this, ue_id, Wait::PREDICTION, opts.prediction_timeout, nullptr };
+        if( !answered ) {
+            counters.prediction_timeouts++;
+            finish( ue_id );
+            co_return;
+        }
+    }
+
+    std::string target_cell_id;
+    const ue_prediction_t &prediction = workflows.at( ue_id ).prediction;
+    if( !hooks.choose_target( prediction, target_cell_id ) ) {
+        counters.kept++;
+        finish( ue_id );
+        co_return;
+    }
+
+    /*
+        The control request is queued once the workflow is suspended, its
+        answer can come at any time. It is not sent at all if it waited in
+        the queue until the workflow gave up on it.
+    */
+    std::string serving_cell_id = prediction.serving_cell_id;
+    std::function<void( uint64_t )> send = [this, ue_id, serving_cell_id, target_cell_id]( uint64_t wait_seq ) {
+        auto deadline = clock::now() + opts.control_timeout;
+        std::lock_guard<std::mutex> lock( control_mutex );
+        control_queue.emplace_back( [=, this]( ) {
+            if( clock::now() >= deadline ) {
+                return;
+            }
+            bool ok = hooks.send_control( ue_id, serving_cell_id, target_cell_id );
+            post( [=, this]( ) {
+                auto it = workflows.find( ue_id );
+                if( it != workflows.end() && it->second.waiting == Wait::CONTROL && it->second.wait_seq == wait_seq ) {
+                    it->second.control_ok = ok;
+                    wake( it->second, false );
+                }
+            } );
+        } );
+        control_cv.notify_one();
+    };
+
+    answered = co_await Awaiter { *this, ue_id, Wait::CONTROL, opts.control_timeout, &send };
+    if( !answered ) {
+        counters.control_timeouts++;
+    } else if( workflows.at( ue_id ).control_ok ) {
+        counters.handoffs++;
+    } else {
+        counters.control_failures++;
+    }
+    finish( ue_id );
+}
+
+void HandoffEngine::start( const std::vector<std::string> &ue_ids ) {
+    post( [this, ue_ids]( ) {
+        std::vector<std::string> started;
+
+        for( const std::string &ue_id : ue_ids ) {
+            if( !workflows.emplace( ue_id, ue_state() ).second ) {
+                counters.merged++;      // its running workflow will act on the next prediction
+                continue;
+            }
+
+            counters.started++;
+            counters.active++;
+            run_workflow( ue_id, false );
+            started.push_back( ue_id );
+        }
+
+        if( !started.empty() ) {
+            hooks.request_predictions( started );
+        }
+    } );
+}
+
+void HandoffEngine::on_prediction( ue_prediction_t &&prediction ) {
+    post( [this, prediction = std::move( prediction )]( ) mutable {
+        auto it = workflows.find( prediction.ue_id );
+        if( it == workflows.end() || it->second.waiting != Wait::PREDICTION ) {
+            counters.unmatched++;
+            return;
+        }
+
+        it->second.prediction = std::move( prediction );
+        wake( it->second, false );
+    } );
+}
+
+void HandoffEngine::start_predicted( ue_prediction_t &&prediction ) {
+    post( [this, prediction = std::move( prediction )]( ) mutable {
+        std::string ue_id = prediction.ue_id;
+
+        auto inserted = workflows.emplace( ue_id, ue_state() );
+        if( !inserted.second ) {
+            counters.merged++;
+            return;
+        }
+        inserted.first->second.prediction = std::move( prediction );
+
+        counters.started++;
+        counters.active++;
+        run_workflow( ue_id, true );
+    } );
+}
+
+workflow_stats_t HandoffEngine::get_stats( ) const {
+    workflow_stats_t stats;
+
+    stats.started = counters.started.load();
+    stats.merged = counters.merged.load();
+    stats.prediction_timeouts = counters.prediction_timeouts.load();
+    stats.unmatched = counters.unmatched.load();
+    stats.kept = counters.kept.load();
+    stats.handoffs = counters.handoffs.load();
+    stats.control_failures = counters.control_failures.load();
+    stats.control_timeouts = counters.control_timeouts.load();
+    stats.active = counters.active.load();
+
+    return stats;
+}
+
+void HandoffEngine::post( std::function<void()> task ) {
+    {
+        std::lock_guard<std::mutex> lock( inbox_mutex );
+        inbox.push_back( std::move( task ) );
+    }
+    inbox_cv.notify_one();
+}
+
+// resumes a suspended workflow; it may run to its end, so state must not be used afterwards
+void HandoffEngine::wake( ue_state &state, bool timed_out ) {
+    state.waiting = Wait::NONE;
+    state.timed_out = timed_out;
+    state.handle.resume();
+}
+
+void HandoffEngine::finish( const std::string &ue_id ) {
+    workflows.erase( ue_id );
+    counters.active--;
+}
+
+// timers are not cancelled when the wait ends first, they are dropped here
+void HandoffEngine::fire_timers( ) {
+    auto now = clock::now();
+
+    while( !timers.empty() && timers.top().deadline <= now ) {
+        timer t = timers.top();
+        timers.pop();
+
+        auto it = workflows.find( t.ue_id );
+        if( it != workflows.end() && it->second.waiting != Wait::NONE && it->second.wait_seq == t.wait_seq ) {
+            wake( it->second, true );
+        }
+    }
+}
+
+void HandoffEngine::run( ) {
+    std::vector<std::function<void()>> tasks;
+    auto next_log = clock::now() + opts.stats_interval;
+
+    while( true ) {
+        {
+            std::unique_lock<std::mutex> lock( inbox_mutex );
+
+            auto deadline = clock::now() + std::chrono::seconds( 1 );
+            if( !timers.empty() ) {
+                deadline = std::min( deadline, timers.top().deadline );
+            }
+            inbox_cv.wait_until( lock, deadline, [this]{ return stopping || !inbox.empty(); } );
+
+            if( stopping ) {
+                break;
+            }
+            tasks.swap( inbox );
+        }
+
+        for( auto &task : tasks ) {
+            task();
+        }
+        tasks.clear();
+        fire_timers();
+
+        if( opts.stats_interval.count() > 0 && clock::now() >= next_log ) {
+            log_stats();
+            next_log = clock::now() + opts.stats_interval;
+        }
+    }
+
+    // every workflow left is suspended; destroying its frame ends it
+    for( auto &w : workflows ) {
+        w.second.handle.destroy();
+    }
+    counters.active -= workflows.size();
+    workflows.clear();
+}
+
+void HandoffEngine::control_loop( ) {
+    while( true ) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock( control_mutex );
+            control_cv.wait( lock, [this]{ return control_stopping || !control_queue.empty(); } );
+            if( control_stopping ) {
+                return;
+            }
+            job = std::move( control_queue.front() );
+            control_queue.pop_front();
+        }
+        job();
+    }
+}
+
+void HandoffEngine::log_stats( ) {
+    workflow_stats_t stats = get_stats();
+
+    if( stats.started == last_logged.started && stats.active == last_logged.active ) {
+        return;     // nothing happened since the last time
+    }
+    last_logged = stats;
+
+    std::cout << "[INFO] Handoff workflows: " << stats.active << " active, " << stats.started << " started, "
+              << stats.merged << " merged, " << stats.handoffs << " handoff(s), " << stats.kept << " kept, "
+              << stats.prediction_timeouts << " prediction timeout(s), " << stats.unmatched << " unmatched prediction(s), "
+              << stats.control_failures << " control failure(s), " << stats.control_timeouts << " control timeout(s)"
+              << std::endl;
+}
+
+} // namespace
+
+#endif
@@ -0,0 +1,213 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	handoff_workflow.hpp
+    Abstract:	Header for the handoff workflow engine. Each UE reported by
+                AD runs a coroutine that waits for its prediction, decides,
+                and waits for the control request to be acknowledged, each
+                step with a timeout. A suspended workflow is only its
+                coroutine frame, so tens of thousands of UEs in flight cost
+                a few MB and no thread.
+
+                All workflows run on one executor thread. Predictions and
+                control results reach it through a queue of posted tasks;
+                the blocking REST/gRPC control calls run on a small pool of
+                control workers.
+
+                Requires C++20 coroutines; TS_HANDOFF_WORKFLOWS is only
+                defined when the compiler supports them (build with
+                -DCOROUTINES=1). Otherwise the xApp keeps using callbacks.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _HANDOFF_WORKFLOW_HPP
+#define _HANDOFF_WORKFLOW_HPP
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+
+namespace ts {
+
+typedef struct ue_prediction {
+    std::string ue_id;
+    std::string serving_cell_id;
+    int serving_cell = -1;                              // index of the serving cell (see cell_index.hpp), -1 if not resolved
+    std::unordered_map<std::string, int> downlink;      // predicted throughput per cell
+} ue_prediction_t;
+
+} // namespace
+
+#if defined( __cpp_impl_coroutine ) && __has_include( <coroutine> )
+
+#define TS_HANDOFF_WORKFLOWS 1
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace ts {
+
+typedef struct workflow_opts {
+    std::chrono::milliseconds prediction_timeout { 500 };
+    std::chrono::milliseconds control_timeout { 2000 };
+    int control_workers = 4;
+    std::chrono::seconds stats_interval { 10 };         // 0 disables the periodic stats log
+} workflow_opts_t;
+
+typedef struct workflow_hooks {
+    // sends one prediction request for the UEs; called on the executor thread
+    std::function<void( const std::vector<std::string> & )> request_predictions;
+    // true and the target cell if the UE should be handed off; called on the executor thread
+    std::function<bool( const ue_prediction_t &, std::string & )> choose_target;
+    // sends the control request and waits for its answer; called on a control worker
+    std::function<bool( const std::string &ue_id, const std::string &serving_cell_id,
+                        const std::string &target_cell_id )> send_control;
+} workflow_hooks_t;
+
+typedef struct workflow_stats {
+    uint64_t started = 0;
+    uint64_t merged = 0;                // anomalies of a UE whose workflow was still running
+    uint64_t prediction_timeouts = 0;
+    uint64_t unmatched = 0;             // predictions no workflow was waiting for (e.g. late)
+    uint64_t kept = 0;                  // the serving cell was the best one
+    uint64_t handoffs = 0;              // control requests acknowledged
+    uint64_t control_failures = 0;
+    uint64_t control_timeouts = 0;
+    uint64_t active = 0;
+} workflow_stats_t;
+
+class HandoffEngine {
+    private:
+        using clock = std::chrono::steady_clock;
+
+        // fire and forget coroutine, the frame is freed when the workflow ends
+        struct workflow {
+            struct promise_type {
+                workflow get_return_object( ) { return { }; }
+                std::suspend_never initial_suspend( ) noexcept { return { }; }
+                std::suspend_never final_suspend( ) noexcept { return { }; }
+                void return_void( ) { }
+                void unhandled_exception( ) { std::terminate(); }
+            };
+        };
+
+        enum class Wait { NONE, PREDICTION, CONTROL };
+
+        // executor thread only
+        struct ue_state {
+            std::coroutine_handle<> handle;
+            Wait waiting = Wait::NONE;
+            uint64_t wait_seq = 0;      // tells a timeout or a late answer of an earlier wait apart
+            bool timed_out = false;
+            bool control_ok = false;
+            ue_prediction_t prediction;
+        };
+
+        struct timer {
+            clock::time_point deadline;
+            std::string ue_id;
+            uint64_t wait_seq;
+            bool operator>( const timer &other ) const { return deadline > other.deadline; }
+        };
+
+        /*
+            Suspends the workflow of a UE until woken up or timed out; resumes
+            to false on timeout. on_suspend, if any, is called with the
+            sequence number of the wait once the workflow is suspended.
+            Only references and scalars: gcc mishandles the destruction of
+            awaiter temporaries with non-trivial members.
+        */
+        struct Awaiter {
+            HandoffEngine &engine;
+            const std::string &ue_id;
+            Wait kind;
+            std::chrono::milliseconds timeout;
+            const std::function<void( uint64_t )> *on_suspend;
+
+            bool await_ready( ) const noexcept { return false; }
+            void await_suspend( std::coroutine_handle<> handle );
+            bool await_resume( );
+        };
+
+        workflow_opts_t opts;
+        workflow_hooks_t hooks;
+
+        std::mutex inbox_mutex;
+        std::condition_variable inbox_cv;
+        std::vector<std::function<void()>> inbox;
+        bool stopping = false;
+        std::thread executor;
+
+        std::unordered_map<std::string, ue_state> workflows;
+        std::priority_queue<timer, std::vector<timer>, std::greater<timer>> timers;
+        uint64_t next_wait_seq = 0;
+
+        std::mutex control_mutex;
+        std::condition_variable control_cv;
+        std::deque<std::function<void()>> control_queue;
+        bool control_stopping = false;
+        std::vector<std::thread> control_threads;
+
+        struct {
+            std::atomic<uint64_t> started { 0 }, merged { 0 }, prediction_timeouts { 0 }, unmatched { 0 };
+            std::atomic<uint64_t> kept { 0 }, handoffs { 0 }, control_failures { 0 }, control_timeouts { 0 };
+            std::atomic<uint64_t> active { 0 };
+        } counters;
+        workflow_stats_t last_logged;       // executor thread only
+
+        void post( std::function<void()> task );
+        void run( );
+        void fire_timers( );
+        void wake( ue_state &state, bool timed_out );
+        void finish( const std::string &ue_id );
+        void control_loop( );
+        void log_stats( );
+
+        workflow run_workflow( std::string ue_id, bool predicted );
+
+    public:
+        HandoffEngine( const workflow_opts_t &opts, const workflow_hooks_t &hooks );
+        ~HandoffEngine();
+
+        // starts a workflow for each UE not already in one; any thread
+        void start( const std::vector<std::string> &ue_ids );
+        // hands a prediction to the workflow of its UE; any thread
+        void on_prediction( ue_prediction_t &&prediction );
+        // starts a workflow that already has the prediction of its UE (e.g. cached); any thread
+        void start_predicted( ue_prediction_t &&prediction );
+
+        workflow_stats_t get_stats( ) const;
+};
+
+} // namespace
+
+#endif
+
+#endif
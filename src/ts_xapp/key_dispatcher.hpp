@@ -0,0 +1,127 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	key_dispatcher.hpp
+    Abstract:	Compile-time table of JSON keys used by the SAX handlers.
+                The table is an open addressing hash built at compile time,
+                so matching a key costs one hash of its bytes, usually one
+                probe and one memcmp, with no heap allocation.
+
+                Usage:
+                    enum { OPERATION = 1, THRESHOLD };  // ids follow the order of the keys
+                    static constexpr ts::KeyDispatcher keys { "operation", "threshold" };
+                    int id = keys.find( str, length );  // 0 if the key is unknown
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _KEY_DISPATCHER_HPP
+#define _KEY_DISPATCHER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace ts {
+
+// FNV-1a hash of the len bytes in str
+constexpr uint32_t key_hash( const char *str, size_t len ) {
+    uint32_t h = 2166136261u;
+    for( size_t i = 0; i < len; i++ ) {
+        h ^= (uint8_t) str[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+constexpr size_t key_length( const char *str ) {
+    size_t len = 0;
+    while( str[len] != '\0' ) {
+        len++;
+    }
+    return len;
+}
+
+template<size_t N>
+class KeyDispatcher {
+    private:
+        // at least 4 slots per key keeps probe sequences short
+        static constexpr size_t slots( ) {
+            size_t n = 1;
+            while( n < N * 4 ) {
+                n <<= 1;
+            }
+            return n;
+        }
+        static constexpr size_t SLOTS = slots();
+        static constexpr size_t MASK = SLOTS - 1;
+
+        struct entry {
+            const char *key = nullptr;
+            size_t len = 0;
+            uint32_t hash = 0;
+            int id = 0;
+        };
+
+        entry table[SLOTS] = {};
+
+    public:
+        template<typename... K>
+        constexpr KeyDispatcher( K... keys ) {
+            const char *list[] = { keys... };
+
+            for( size_t k = 0; k < N; k++ ) {
+                size_t len = key_length( list[k] );
+                uint32_t h = key_hash( list[k], len );
+                size_t i = h & MASK;
+
+                while( table[i].key != nullptr ) {
+                    i = ( i + 1 ) & MASK;
+                }
+                table[i].key = list[k];
+                table[i].len = len;
+                table[i].hash = h;
+                table[i].id = k + 1;
+            }
+        }
+
+        /*
+            Returns the id (1-based position in the constructor) of the key,
+            or 0 if it is not one of the keys of this table.
+        */
+        int find( const char *str, size_t len ) const {
+            uint32_t h = key_hash( str, len );
+
+            for( size_t i = h & MASK; table[i].key != nullptr; i = ( i + 1 ) & MASK ) {
+                if( table[i].hash == h && table[i].len == len && memcmp( table[i].key, str, len ) == 0 ) {
+                    return table[i].id;
+                }
+            }
+
+            return 0;
+        }
+};
+
+template<typename... K>
+KeyDispatcher( K... ) -> KeyDispatcher<sizeof...( K )>;
+
+} // namespace
+
+#endif
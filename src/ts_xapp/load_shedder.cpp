@@ -0,0 +1,107 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	load_shedder.cpp
+    Abstract:	Implements the overload protection of the anomaly path.
+
+    Date:       18 Oct 2026
+*/
+
+#include "load_shedder.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace ts {
+
+LoadShedder::LoadShedder( const shed_opts_t &opts ) : opts( opts ) { }
+
+// uniform in [0, 1); xorshift64*
+double LoadShedder::next_rand( ) {
+    rand_state ^= rand_state >> 12;
+    rand_state ^= rand_state << 25;
+    rand_state ^= rand_state >> 27;
+    return ( ( rand_state * 2685821657736338717ULL ) >> 11 ) * ( 1.0 / 9007199254740992.0 );
+}
+
+bool LoadShedder::admit( int64_t meas_ts_ms, int64_t now_ms, double backlog ) {
+    if( opts.stats_interval_ms > 0 && now_ms >= next_log_ms ) {
+        if( next_log_ms > 0 ) {
+            log_stats();
+        }
+        next_log_ms = now_ms + opts.stats_interval_ms;
+    }
+
+    // an unknown measurement time, or one ahead of our clock, counts as fresh
+    int64_t age = meas_ts_ms > 0 ? std::max<int64_t>( 0, now_ms - meas_ts_ms ) : 0;
+
+    if( opts.max_age_ms > 0 && age > opts.max_age_ms ) {
+        stale.fetch_add( 1, std::memory_order_relaxed );
+        return false;
+    }
+
+    if( opts.shed_start > 0 && backlog > opts.shed_start ) {
+        double p = std::min( 1.0, ( backlog - opts.shed_start ) / ( 1.0 - opts.shed_start ) );
+
+        /*
+            Weighs the probability by the age, relative to the maximum age,
+            up to one and a half times the backlog share for the oldest
+            anomalies. It never goes below the backlog share, so fresh
+            anomalies are still shed under backlog. Without a maximum age,
+            all anomalies weigh the same.
+        */
+        if( opts.max_age_ms > 0 && p < 1.0 ) {
+            double floor = p;
+            p = std::min( 1.0, std::max( floor, p * ( 0.5 + (double) age / opts.max_age_ms ) ) );
+        }
+
+        if( next_rand() < p ) {
+            shed.fetch_add( 1, std::memory_order_relaxed );
+            return false;
+        }
+    }
+
+    admitted.fetch_add( 1, std::memory_order_relaxed );
+    return true;
+}
+
+shed_stats_t LoadShedder::get_stats( ) const {
+    shed_stats_t stats;
+
+    stats.admitted = admitted.load( std::memory_order_relaxed );
+    stats.stale = stale.load( std::memory_order_relaxed );
+    stats.shed = shed.load( std::memory_order_relaxed );
+
+    return stats;
+}
+
+void LoadShedder::log_stats( ) {
+    shed_stats_t stats = get_stats();
+
+    if( stats.stale + stats.shed == last_logged ) {
+        return;     // nothing was dropped since the last time
+    }
+    last_logged = stats.stale + stats.shed;
+
+    std::cout << "[INFO] Anomaly load shedding: " << stats.admitted << " admitted, " << stats.stale
+              << " dropped as stale, " << stats.shed << " shed under backlog" << std::endl;
+}
+
+} // namespace
@@ -0,0 +1,86 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	load_shedder.hpp
+    Abstract:	Header for the overload protection of the anomaly path.
+                Anomalies whose measurement (measTimeStampRf) is older than
+                a maximum age are dropped: by the time a handoff is decided
+                it would no longer help. Once the backlog of the data queue
+                passes a threshold, anomalies are also shed with a
+                probability that grows linearly with the backlog, up to
+                every anomaly when the queue is full. Older anomalies are
+                more likely to be shed, so the cycles left go to fresh ones.
+
+                Only one thread at a time calls admit; the counters can be
+                read from any thread.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _LOAD_SHEDDER_HPP
+#define _LOAD_SHEDDER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+namespace ts {
+
+typedef struct shed_opts {
+    int64_t max_age_ms = 0;             // anomalies older than this are dropped; 0 never drops by age
+    double shed_start = 0;              // backlog (0..1) above which anomalies are shed; 0 never sheds
+    int64_t stats_interval_ms = 10000;  // 0 disables the periodic stats log
+} shed_opts_t;
+
+typedef struct shed_stats {
+    uint64_t admitted = 0;
+    uint64_t stale = 0;                 // dropped because of their age
+    uint64_t shed = 0;                  // dropped because of the backlog
+} shed_stats_t;
+
+class LoadShedder {
+    private:
+        shed_opts_t opts;
+        uint64_t rand_state = 0x9e3779b97f4a7c15ULL;
+        int64_t next_log_ms = 0;
+        uint64_t last_logged = 0;
+
+        std::atomic<uint64_t> admitted { 0 };
+        std::atomic<uint64_t> stale { 0 };
+        std::atomic<uint64_t> shed { 0 };
+
+        double next_rand( );
+        void log_stats( );
+
+    public:
+        explicit LoadShedder( const shed_opts_t &opts );
+
+        /*
+            Returns true if an anomaly measured at meas_ts_ms (0 if unknown)
+            should be handled, now_ms being the current time and backlog the
+            occupancy of the data queue, from 0 (empty) to 1 (full).
+        */
+        bool admit( int64_t meas_ts_ms, int64_t now_ms, double backlog );
+
+        shed_stats_t get_stats( ) const;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,241 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	loopback_sim.cpp
+    Abstract:	Implements the AD and QP stand-ins and the pipeline driver.
+
+    Date:       18 Oct 2026
+*/
+
+#include "loopback_sim.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <rapidjson/reader.h>
+#include <rmr/RIC_message_types.h>
+
+namespace ts {
+
+namespace {
+
+// collects the UEs of {"UEPredictionSet": ["12345", ...]}, skipping the optional "CandidateCells"
+struct UeListHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, UeListHandler> {
+    std::vector<std::string> ues;
+    int depth = 0;
+    bool in_list = false;
+
+    bool Key( const char *str, rapidjson::SizeType length, bool copy ) {
+        if( depth == 1 ) {
+            in_list = std::string( str, length ) == "UEPredictionSet";
+        }
+        return true;
+    }
+    bool String( const char *str, rapidjson::SizeType length, bool copy ) {
+        if( in_list && depth == 2 ) {
+            ues.emplace_back( str, length );
+        }
+        return true;
+    }
+    bool StartObject( ) { depth++; return true; }
+    bool EndObject( rapidjson::SizeType count ) { depth--; return true; }
+    bool StartArray( ) { depth++; return true; }
+    bool EndArray( rapidjson::SizeType count ) { depth--; return true; }
+};
+
+std::string cell_id( int n ) {
+    char buf[32];
+    snprintf( buf, sizeof( buf ), "310-680-200-%06d", 555001 + n );
+    return buf;
+}
+
+} // namespace
+
+SimAd::SimAd( LoopbackBus &bus, const pipeline_opts_t &opts, size_t capacity ) :
+    endpoint( bus, "ad", capacity ), opts( opts ) {
+
+    endpoint.add_handler( TS_ANOMALY_ACK, [this]( int mtype, const char *payload, int len, Replier &replier ) {
+        acked.fetch_add( 1, std::memory_order_relaxed );
+    } );
+}
+
+bool SimAd::send_one( ) {
+    char buf[256];
+    std::string body = "[";
+    long long now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch() ).count();
+
+    for( int i = 0; i < opts.ues_per_msg; i++ ) {
+        int ue = 12345 + (int) ( ( next_ue + i ) % opts.population );
+        snprintf( buf, sizeof( buf ), "%s{\"du-id\": 1010, \"ue-id\": \"%d\", \"measTimeStampRf\": %lld, \"Degradation\": \"RSRP RSSINR\"}",
+                  i == 0 ? "" : ", ", ue, now_ms );
+        body += buf;
+    }
+    body += "]";
+
+    if( !endpoint.send( TS_ANOMALY_UPDATE, body.c_str(), body.size() ) ) {
+        return false;
+    }
+
+    next_ue += opts.ues_per_msg;
+    sent++;
+    return true;
+}
+
+SimQp::SimQp( LoopbackBus &bus, const pipeline_opts_t &opts, size_t capacity ) :
+    endpoint( bus, "qp", capacity ), opts( opts ) {
+
+    endpoint.add_handler( TS_UE_LIST, [this]( int mtype, const char *payload, int len, Replier &replier ) {
+        std::string json( payload, len );
+        UeListHandler handler;
+        rapidjson::Reader reader;
+        rapidjson::StringStream ss( json.c_str() );
+        reader.Parse( ss, handler );
+
+        for( const std::string &ue : handler.ues ) {
+            std::string body = build_prediction( ue );
+            if( replier.reply( TS_QOE_PREDICTION, body.c_str(), body.size() ) ) {
+                predictions.fetch_add( 1, std::memory_order_relaxed );
+            }
+        }
+        requests.fetch_add( 1, std::memory_order_relaxed );
+    } );
+}
+
+int SimQp::next_rand( int lo, int hi ) {
+    rand_state = rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return lo + (int) ( ( rand_state >> 33 ) % (uint64_t) ( hi - lo + 1 ) );
+}
+
+// same predictions as test/app/qp_xapp.cpp with -H
+std::string SimQp::build_prediction( const std::string &ue_id ) {
+    bool handoff = opts.ncells > 1 && next_rand( 0, 99 ) < opts.handoff_pct;
+    int best = handoff ? next_rand( 1, opts.ncells - 1 ) : -1;
+    int serving = next_rand( 10, 50 );
+
+    std::string body = "{\"" + ue_id + "\": {";
+    for( int i = 0; i < opts.ncells; i++ ) {
+        int down = i == 0 ? serving : ( i == best ? serving * 2 + next_rand( 1, 50 ) : next_rand( 0, serving - 1 ) );
+        body += "\"" + cell_id( i ) + "\": [" + std::to_string( down ) + ", " + std::to_string( next_rand( 0, 99 ) ) + "]";
+        body += ( i == opts.ncells - 1 ) ? "}}" : ", ";
+    }
+
+    return body;
+}
+
+pipeline_stats_t run_pipeline( LoopbackBus &bus, LoopbackTransport &ts, const pipeline_opts_t &opts ) {
+    SimAd ad( bus, opts, pipeline_capacity( opts ) );
+    SimQp qp( bus, opts, pipeline_capacity( opts ) );
+    LoopbackTransport *endpoints[] = { &ts, &qp.get_endpoint(), &ad.get_endpoint() };
+
+    bus.add_route( A1_POLICY_REQ, &ts );
+    bus.add_route( TS_ANOMALY_UPDATE, &ts );
+    bus.add_route( TS_QOE_PREDICTION, &ts );
+    bus.add_route( TS_UE_LIST, &qp.get_endpoint() );
+
+    // anomalies whose predictions TS did not handle yet; bounds the occupancy of every queue
+    auto in_flight = [&]( ) { return ad.get_sent() - ts.dispatched() / ( 1 + opts.ues_per_msg ); };
+    auto idle = [&]( ) {
+        for( auto e : endpoints ) {
+            if( e->pending() > 0 ) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    if( !opts.threaded ) {
+        while( true ) {
+            while( ad.get_sent() < opts.anomalies && in_flight() < opts.window && ad.send_one() ) { }
+
+            size_t handled = 0;
+            for( auto e : endpoints ) {
+                handled += e->poll( opts.window );
+            }
+            if( handled == 0 && ( ad.get_sent() == opts.anomalies || in_flight() >= opts.window ) ) {
+                break;      // done, or stuck because messages were lost
+            }
+        }
+
+    } else {
+        std::vector<std::thread> threads;
+        for( auto e : endpoints ) {
+            threads.emplace_back( [e]{ e->run( 1 ); } );
+        }
+
+        while( ad.get_sent() < opts.anomalies ) {
+            if( in_flight() >= opts.window || !ad.send_one() ) {
+                std::this_thread::yield();
+            }
+        }
+
+        /*
+            Done once every anomaly was acked and went through QP, and TS
+            handled every prediction. If messages were lost, give up when
+            nothing moved for 100 ms.
+        */
+        uint64_t last = 0;
+        int stalled = 0;
+        while( true ) {
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+
+            uint64_t sent = ad.get_sent();
+            if( idle() && ad.get_acked() == sent && qp.get_endpoint().dispatched() == sent &&
+                ts.dispatched() == sent + qp.get_predictions() ) {
+                break;
+            }
+
+            uint64_t total = 0;
+            for( auto e : endpoints ) {
+                total += e->dispatched();
+            }
+            stalled = total == last ? stalled + 1 : 0;
+            if( stalled >= 100 ) {
+                break;
+            }
+            last = total;
+        }
+
+        for( auto e : endpoints ) {
+            e->stop();
+        }
+        for( auto &t : threads ) {
+            t.join();
+        }
+    }
+
+    pipeline_stats_t stats;
+    stats.elapsed_s = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    stats.anomalies = ad.get_sent();
+    stats.acks = ad.get_acked();
+    stats.prediction_requests = qp.get_requests();
+    stats.predictions = qp.get_predictions();
+    for( auto e : endpoints ) {
+        stats.refused += e->refused();
+    }
+
+    return stats;
+}
+
+} // namespace
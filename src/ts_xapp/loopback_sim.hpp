@@ -0,0 +1,112 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	loopback_sim.hpp
+    Abstract:	Header for the in-process stand-ins of the AD and QP xApps,
+                and for the driver that runs the AD -> TS -> QP -> TS
+                pipeline over loopback endpoints. They behave like the test
+                xApps in test/app, with deterministic values.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _LOOPBACK_SIM_HPP
+#define _LOOPBACK_SIM_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "loopback_transport.hpp"
+
+namespace ts {
+
+typedef struct pipeline_opts {
+    uint64_t anomalies = 100000;    // anomaly messages sent by AD
+    int ues_per_msg = 1;            // UEs in each anomaly message
+    int population = 10000;         // distinct UEs, ids start at 12345
+    int ncells = 3;                 // cells in each prediction, the first one is the serving cell
+    int handoff_pct = 20;           // predictions where a neighbor is much better than the serving cell
+    size_t window = 256;            // anomaly messages whose predictions were not handled yet
+    bool threaded = false;          // a thread per endpoint instead of polling them in turn
+} pipeline_opts_t;
+
+typedef struct pipeline_stats {
+    uint64_t anomalies = 0;         // sent by AD
+    uint64_t acks = 0;              // received by AD
+    uint64_t prediction_requests = 0;   // received by QP
+    uint64_t predictions = 0;       // sent by QP
+    uint64_t refused = 0;           // sends refused because a queue was full
+    double elapsed_s = 0;
+} pipeline_stats_t;
+
+// queue size of each endpoint, enough for opts.window anomalies in flight and their predictions
+inline size_t pipeline_capacity( const pipeline_opts_t &opts ) {
+    return opts.window * ( opts.ues_per_msg + 1 ) * 2;
+}
+
+// stand-in for the AD xApp: sends anomalies and counts the ACKs
+class SimAd {
+    private:
+        LoopbackTransport endpoint;
+        const pipeline_opts_t &opts;
+        std::atomic<uint64_t> acked { 0 };
+        uint64_t sent = 0;
+        uint64_t next_ue = 0;
+
+    public:
+        SimAd( LoopbackBus &bus, const pipeline_opts_t &opts, size_t capacity );
+
+        bool send_one( );
+        uint64_t get_sent( ) const { return sent; }
+        uint64_t get_acked( ) const { return acked.load( std::memory_order_relaxed ); }
+        LoopbackTransport &get_endpoint( ) { return endpoint; }
+};
+
+// stand-in for the QP xApp: replies a prediction for each UE of a TS_UE_LIST
+class SimQp {
+    private:
+        LoopbackTransport endpoint;
+        const pipeline_opts_t &opts;
+        uint64_t rand_state = 42;
+        std::atomic<uint64_t> requests { 0 };
+        std::atomic<uint64_t> predictions { 0 };
+
+        int next_rand( int lo, int hi );
+        std::string build_prediction( const std::string &ue_id );
+
+    public:
+        SimQp( LoopbackBus &bus, const pipeline_opts_t &opts, size_t capacity );
+
+        uint64_t get_requests( ) const { return requests.load( std::memory_order_relaxed ); }
+        uint64_t get_predictions( ) const { return predictions.load( std::memory_order_relaxed ); }
+        LoopbackTransport &get_endpoint( ) { return endpoint; }
+};
+
+/*
+    Routes the TS message types to ts, whose handlers are already set, sends
+    opts.anomalies anomaly messages to it and returns once every message of
+    the pipeline has been handled.
+*/
+pipeline_stats_t run_pipeline( LoopbackBus &bus, LoopbackTransport &ts, const pipeline_opts_t &opts );
+
+} // namespace
+
+#endif
@@ -0,0 +1,198 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	loopback_transport.cpp
+    Abstract:	Implements the in-process messaging endpoints. The queue is
+                the bounded MPMC queue by D. Vyukov: a message is written in
+                place in its slot, and handled there, so it is copied once,
+                by the sender, as RMR does.
+
+    Date:       18 Oct 2026
+*/
+
+#include "loopback_transport.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace ts {
+
+namespace {
+
+// replies go to the queue of the endpoint that sent the message
+class LoopbackReplier : public Replier {
+    private:
+        LoopbackTransport *self;
+        LoopbackTransport *from;
+
+    public:
+        LoopbackReplier( LoopbackTransport *self, LoopbackTransport *from ) : self( self ), from( from ) { }
+
+        bool reply( int mtype, const void *payload, int len ) override {
+            return from != nullptr && from->push( mtype, payload, len, self );
+        }
+};
+
+} // namespace
+
+void LoopbackBus::add_route( int mtype, LoopbackTransport *endpoint ) {
+    routes[mtype] = endpoint;
+}
+
+LoopbackTransport *LoopbackBus::route( int mtype ) const {
+    auto it = routes.find( mtype );
+    return it == routes.end() ? nullptr : it->second;
+}
+
+LoopbackTransport::LoopbackTransport( LoopbackBus &bus, const std::string &name, size_t capacity ) :
+    bus( bus ), name( name ) {
+
+    size_t size = 2;
+    while( size < capacity ) {
+        size <<= 1;
+    }
+
+    ring = std::unique_ptr<slot[]>( new slot[size] );
+    mask = size - 1;
+    for( size_t i = 0; i < size; i++ ) {
+        ring[i].seq.store( i, std::memory_order_relaxed );
+    }
+}
+
+bool LoopbackTransport::push( int mtype, const void *payload, int len, LoopbackTransport *from ) {
+    if( len < 0 || len > LOOPBACK_MAX_PAYLOAD ) {
+        return false;
+    }
+
+    size_t pos = tail.load( std::memory_order_relaxed );
+    slot *s;
+
+    while( true ) {
+        s = &ring[pos & mask];
+        intptr_t dif = (intptr_t) s->seq.load( std::memory_order_acquire ) - (intptr_t) pos;
+
+        if( dif == 0 ) {
+            if( tail.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) ) {
+                break;
+            }
+        } else if( dif < 0 ) {      // the consumer has not freed this slot yet
+            full.fetch_add( 1, std::memory_order_relaxed );
+            return false;
+        } else {
+            pos = tail.load( std::memory_order_relaxed );
+        }
+    }
+
+    s->mtype = mtype;
+    s->len = len;
+    s->from = from;
+    memcpy( s->payload, payload, len );
+    s->seq.store( pos + 1, std::memory_order_release );
+
+    return true;
+}
+
+/*
+    Handles the oldest queued message, if any. The slot is only given back
+    to the producers once its handler returns.
+*/
+bool LoopbackTransport::dispatch_one( ) {
+    size_t pos = head.load( std::memory_order_relaxed );
+    slot *s;
+
+    while( true ) {
+        s = &ring[pos & mask];
+        intptr_t dif = (intptr_t) s->seq.load( std::memory_order_acquire ) - (intptr_t) ( pos + 1 );
+
+        if( dif == 0 ) {
+            if( head.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) ) {
+                break;
+            }
+        } else if( dif < 0 ) {      // empty
+            return false;
+        } else {
+            pos = head.load( std::memory_order_relaxed );
+        }
+    }
+
+    auto handler = handlers.find( s->mtype );
+    if( handler != handlers.end() ) {
+        LoopbackReplier replier( this, s->from );
+        handler->second( s->mtype, s->payload, s->len, replier );
+    }
+
+    s->seq.store( pos + mask + 1, std::memory_order_release );
+    handled.fetch_add( 1, std::memory_order_relaxed );
+    return true;
+}
+
+void LoopbackTransport::add_handler( int mtype, msg_handler_t handler ) {
+    handlers[mtype] = handler;
+}
+
+bool LoopbackTransport::send( int mtype, const void *payload, int len ) {
+    LoopbackTransport *to = bus.route( mtype );
+    return to != nullptr && to->push( mtype, payload, len, this );
+}
+
+size_t LoopbackTransport::poll( size_t max ) {
+    size_t n = 0;
+    while( n < max && dispatch_one() ) {
+        n++;
+    }
+    return n;
+}
+
+void LoopbackTransport::run( int nthreads ) {
+    auto loop = [this]( ) {
+        int idle = 0;
+        while( !stopping.load( std::memory_order_relaxed ) ) {
+            if( dispatch_one() ) {
+                idle = 0;
+            } else if( ++idle < 1000 ) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for( std::chrono::microseconds( 50 ) );
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for( int i = 1; i < nthreads; i++ ) {
+        threads.emplace_back( loop );
+    }
+    loop();
+
+    for( auto &t : threads ) {
+        t.join();
+    }
+}
+
+void LoopbackTransport::stop( ) {
+    stopping.store( true );
+}
+
+size_t LoopbackTransport::pending( ) const {
+    return tail.load( std::memory_order_relaxed ) - head.load( std::memory_order_relaxed );
+}
+
+} // namespace
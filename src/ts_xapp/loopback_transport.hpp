@@ -0,0 +1,115 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	loopback_transport.hpp
+    Abstract:	Header for the in-process implementation of the messaging
+                interface. Each endpoint (an xApp) has a bounded lock-free
+                queue of inbound messages; the bus routes message types to
+                endpoints like an RMR route table.
+
+                Messages are handled either by run, on threads of their own,
+                or by poll, on the caller's thread. Polling every endpoint in
+                turn runs a whole pipeline in one thread, deterministically.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _LOOPBACK_TRANSPORT_HPP
+#define _LOOPBACK_TRANSPORT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "transport.hpp"
+
+namespace ts {
+
+const int LOOPBACK_MAX_PAYLOAD = 4096;
+
+class LoopbackTransport;
+
+// route table shared by the endpoints; routes are added before any message is sent
+class LoopbackBus {
+    private:
+        std::unordered_map<int, LoopbackTransport *> routes;
+
+    public:
+        void add_route( int mtype, LoopbackTransport *endpoint );
+        LoopbackTransport *route( int mtype ) const;
+};
+
+class LoopbackTransport : public Transport {
+    private:
+        /*
+            Bounded multi-producer multi-consumer queue: each slot carries a
+            sequence number telling whether it is free for the producer of
+            a given position or ready for its consumer, so producers and
+            consumers only contend on their own position counter.
+        */
+        struct alignas( 64 ) slot {
+            std::atomic<size_t> seq;
+            int mtype;
+            int len;
+            LoopbackTransport *from;
+            char payload[LOOPBACK_MAX_PAYLOAD];
+        };
+
+        LoopbackBus &bus;
+        std::string name;
+        std::unique_ptr<slot[]> ring;
+        size_t mask;
+
+        alignas( 64 ) std::atomic<size_t> tail { 0 };     // next position to produce
+        alignas( 64 ) std::atomic<size_t> head { 0 };     // next position to consume
+        alignas( 64 ) std::atomic<bool> stopping { false };
+        std::atomic<uint64_t> full { 0 };                 // sends refused because the queue was full
+        std::atomic<uint64_t> handled { 0 };              // messages dispatched to a handler
+
+        std::unordered_map<int, msg_handler_t> handlers;
+
+        bool dispatch_one( );
+
+    public:
+        LoopbackTransport( LoopbackBus &bus, const std::string &name, size_t capacity = 1024 );
+
+        // queues a message in this endpoint, from is where replies go
+        bool push( int mtype, const void *payload, int len, LoopbackTransport *from );
+
+        void add_handler( int mtype, msg_handler_t handler ) override;
+        bool send( int mtype, const void *payload, int len ) override;
+        void run( int nthreads ) override;
+        void stop( ) override;
+
+        // handles up to max queued messages in the caller's thread, returns how many were handled
+        size_t poll( size_t max = SIZE_MAX );
+
+        size_t pending( ) const;
+        uint64_t refused( ) const { return full.load( std::memory_order_relaxed ); }
+        uint64_t dispatched( ) const { return handled.load( std::memory_order_relaxed ); }
+        const std::string &get_name( ) const { return name; }
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,391 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	message_handlers.hpp
+    Abstract:	rapidjson SAX handlers for the messages received by the TS xApp
+                (A1 policies, QP predictions, AD anomalies) and for the E2
+                manager replies used to map cells to E2 nodes.
+
+                The handlers only collect what they parse, so they can be
+                driven by the callbacks and by the microbenchmarks alike.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _MESSAGE_HANDLERS_HPP
+#define _MESSAGE_HANDLERS_HPP
+
+#include <cctype>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <rapidjson/reader.h>
+
+#include "key_dispatcher.hpp"
+
+// E2 node that serves a cell, as reported by the E2 manager
+typedef struct nodeb {
+  std::string ran_name;
+  struct {
+    std::string plmn_id;
+    std::string nb_id;
+  } global_nb_id;
+} nodeb_t;
+
+//https://stackoverflow.com/a/34571089/15098882
+
+static std::string base64_decode(const std::string &in) {
+
+	std::string out;
+
+	std::vector<int> T(256, -1);
+	for (int i = 0; i < 64; i++) T["ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"[i]] = i;
+
+	int val = 0, valb = -8;
+	for (unsigned char c : in) {
+		if (T[c] == -1) break;
+		val = (val << 6) + T[c];
+		valb += 6;
+		if (valb >= 0) {
+			out.push_back(char((val >> valb) & 0xFF));
+			valb -= 8;
+		}
+	}
+	return out;
+}
+
+struct PolicyHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, PolicyHandler> {
+  /*
+    Assuming we receive the following payload from A1 Mediator
+    {"operation": "CREATE", "policy_type_id": 20008, "policy_instance_id": "tsapolicy145", "payload": {"threshold": 5}}
+
+    The payload might also restrict the policy to a cell or a group of cells
+    {"threshold": 5, "scope": {"cell_ids": ["310-680-200-555001", "310-680-200-555002"]}}
+
+    slice_id is parsed only to reject slice scoped policies, which are not supported
+  */
+  enum { OPERATION = 1, POLICY_TYPE_ID, POLICY_INSTANCE_ID, THRESHOLD, CELL_IDS, CELL_ID, SLICE_ID };
+  static constexpr ts::KeyDispatcher keys { "operation", "policy_type_id", "policy_instance_id", "threshold",
+                                            "cell_ids", "cell_id", "slice_id" };
+
+  int curr_key = 0;
+  int policy_type_id = 0;
+  std::string policy_instance_id;
+  int threshold = 0;
+  std::string operation;
+  bool found_threshold = false;
+  std::vector<std::string> cells;
+  std::string slice_id;
+
+  bool Null() { return true; }
+  bool Bool(bool b) { return true; }
+  bool Int(int i) {
+
+    switch (curr_key) {
+      case POLICY_TYPE_ID:
+        policy_type_id = i;
+        break;
+      case POLICY_INSTANCE_ID:
+        policy_instance_id = std::to_string(i);
+        break;
+      case THRESHOLD:
+        found_threshold = true;
+        threshold = i;
+        break;
+    }
+
+    return true;
+  }
+  bool Uint(unsigned u) {
+
+    switch (curr_key) {
+      case POLICY_TYPE_ID:
+        policy_type_id = u;
+        break;
+      case POLICY_INSTANCE_ID:
+        policy_instance_id = std::to_string(u);
+        break;
+      case THRESHOLD:
+        found_threshold = true;
+        threshold = u;
+        break;
+    }
+
+    return true;
+  }
+  bool Int64(int64_t i) {  return true; }
+  bool Uint64(uint64_t u) {  return true; }
+  bool Double(double d) {  return true; }
+  bool String(const char* str, rapidjson::SizeType length, bool copy) {
+
+    switch (curr_key) {
+      case OPERATION:
+        operation.assign(str, length);
+        break;
+      case POLICY_INSTANCE_ID:
+        policy_instance_id.assign(str, length);
+        break;
+      case CELL_IDS:
+      case CELL_ID:
+        cells.emplace_back(str, length);
+        break;
+      case SLICE_ID:
+        slice_id.assign(str, length);
+        break;
+    }
+
+    return true;
+  }
+  bool StartObject() {
+
+    return true;
+  }
+  bool Key(const char* str, rapidjson::SizeType length, bool copy) {
+
+    curr_key = keys.find(str, length);
+
+    return true;
+  }
+  bool EndObject(rapidjson::SizeType memberCount) {  return true; }
+  bool StartArray() {  return true; }
+  bool EndArray(rapidjson::SizeType elementCount) {  return true; }
+
+};
+
+struct PredictionHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, PredictionHandler> {
+  std::unordered_map<std::string, int> cell_pred_down;
+  std::unordered_map<std::string, int> cell_pred_up;
+  std::string ue_id;
+  bool ue_id_found = false;
+  std::string curr_key = "";
+  std::string curr_value = "";
+  std::string serving_cell_id;
+  bool down_val = true;
+  bool Null() {  return true; }
+  bool Bool(bool b) {  return true; }
+  bool Int(int i) {  return true; }
+  bool Uint(unsigned u) {
+    // Currently, we assume the first cell in the prediction message is the serving cell
+    if ( serving_cell_id.empty() ) {
+      serving_cell_id = curr_key;
+    }
+
+    if (down_val) {
+      cell_pred_down[curr_key] = u;
+      down_val = false;
+    } else {
+      cell_pred_up[curr_key] = u;
+      down_val = true;
+    }
+
+    return true;
+
+  }
+  bool Int64(int64_t i) {  return true; }
+  bool Uint64(uint64_t u) {  return true; }
+  bool Double(double d) {  return true; }
+  bool String(const char* str, rapidjson::SizeType length, bool copy) {
+
+    return true;
+  }
+  bool StartObject() {  return true; }
+  bool Key(const char* str, rapidjson::SizeType length, bool copy) {
+    if (!ue_id_found) {
+
+      ue_id = str;
+      ue_id_found = true;
+    } else {
+      curr_key = str;
+    }
+    return true;
+  }
+  bool EndObject(rapidjson::SizeType memberCount) {  return true; }
+  bool StartArray() {  return true; }
+  bool EndArray(rapidjson::SizeType elementCount) {  return true; }
+};
+
+// one entry of an AD anomaly message
+typedef struct anomaly {
+  std::string ue_id;
+  long long du_id = -1;
+  long long meas_ts_ms = 0;       // measTimeStampRf, ms since the epoch; 0 if missing
+  std::string degradation;
+} anomaly_t;
+
+struct AnomalyHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, AnomalyHandler> {
+  /*
+    Assuming we receive the following payload from AD
+    [{"du-id": 1010, "ue-id": "Train passenger 2", "measTimeStampRf": 1620835470108, "Degradation": "RSRP RSSINR"}]
+  */
+  enum { UE_ID = 1, DU_ID, MEAS_TS, DEGRADATION };
+  static constexpr ts::KeyDispatcher keys { "ue-id", "du-id", "measTimeStampRf", "Degradation" };
+
+  std::vector<std::string> prediction_ues;
+  std::vector<anomaly_t> anomalies;   // one per object, in the same order as prediction_ues
+  int curr_key = 0;
+
+  bool StartObject() {
+    anomalies.emplace_back();
+    return true;
+  }
+
+  bool Key(const Ch* str, rapidjson::SizeType len, bool copy) {
+    curr_key = keys.find( str, len );
+    return true;
+  }
+
+  bool String(const Ch* str, rapidjson::SizeType len, bool copy) {
+    if ( anomalies.empty() ) {
+      return true;
+    }
+    if ( curr_key == UE_ID ) {
+      prediction_ues.emplace_back( str, len );
+      anomalies.back().ue_id.assign( str, len );
+    } else if ( curr_key == DEGRADATION ) {
+      anomalies.back().degradation.assign( str, len );
+    }
+    return true;
+  }
+
+  bool Int64(int64_t i) {
+    if ( !anomalies.empty() ) {
+      if ( curr_key == DU_ID ) {
+        anomalies.back().du_id = i;
+      } else if ( curr_key == MEAS_TS ) {
+        anomalies.back().meas_ts_ms = i;
+      }
+    }
+    return true;
+  }
+
+  bool Int(int i) { return Int64( i ); }
+  bool Uint(unsigned u) { return Int64( u ); }
+  bool Uint64(uint64_t u) { return Int64( (int64_t) u ); }
+  bool Double(double d) { return Int64( (int64_t) d ); }
+
+  bool EndObject(rapidjson::SizeType count) {
+    if ( !anomalies.empty() && anomalies.back().ue_id.empty() ) {
+      anomalies.pop_back();     // no ue-id, nothing to predict
+    }
+    return true;
+  }
+};
+
+struct NodebListHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, NodebListHandler> {
+  enum { INVENTORY_NAME = 1 };
+  static constexpr ts::KeyDispatcher keys { "inventoryName" };
+
+  std::vector<std::string> nodeb_list;
+  int curr_key = 0;
+
+  bool Key(const Ch* str, rapidjson::SizeType length, bool copy) {
+    curr_key = keys.find( str, length );
+    return true;
+  }
+
+  bool String(const Ch* str, rapidjson::SizeType length, bool copy) {
+    if( curr_key == INVENTORY_NAME ) {
+      nodeb_list.emplace_back( str, length );
+    }
+    return true;
+  }
+};
+
+// collects the cells of an E2 node from its E2 setup request; the caller maps each cell to the nodeb
+struct NodebHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, NodebHandler> {
+	enum { RAN_NAME = 1, PLMN_ID, NB_ID, E2NODE_COMPONENT_REQUEST_PART };
+	static constexpr ts::KeyDispatcher keys { "ranName", "plmnId", "nbId", "e2nodeComponentRequestPart" };
+
+	int curr_key = 0;
+	std::shared_ptr<nodeb_t> nodeb = std::make_shared<nodeb_t>();
+	std::string meid;
+	std::vector<std::string> cells;
+
+	bool Key(const Ch* str, rapidjson::SizeType length, bool copy) {
+		curr_key = keys.find( str, length );
+		return true;
+	}
+
+	bool String(const Ch* str, rapidjson::SizeType length, bool copy) {
+
+		if (curr_key == RAN_NAME) {
+			//std::cout << str << "\n";
+			nodeb->ran_name = str;
+			meid= str;
+			//std::cout << "\n meid = " << meid;
+
+		}
+		else if (curr_key == PLMN_ID) {
+			//std::cout << str << "\n";
+			nodeb->global_nb_id.plmn_id = str;
+		}
+		else if (curr_key == NB_ID) {
+			//std::cout <<str<< "\n";
+			nodeb->global_nb_id.nb_id = str;
+		}
+		else if (curr_key == E2NODE_COMPONENT_REQUEST_PART) {
+			//std::cout << str<<"\n";
+			auto message = base64_decode(str);
+			//std::cout << message<<"\n";
+			int len = meid.length();
+			//std::cout << "\n meid = " << meid;
+			int counter = 0;
+				for (int i = 0; i <len; i++ ){
+					if (meid[i] == '_') {
+						counter++;
+					}
+					if( counter == 3) {
+						counter = i + 1;
+						break;
+					}
+				}
+				std::string last_matching_bits = meid.substr(counter, meid.length());
+				len = last_matching_bits.size();
+				char b;
+
+				for (int i = 0; i < len; i++) {
+					b = last_matching_bits[i];
+					b = toupper(b);
+					// b = to lower(b); //alternately
+					last_matching_bits[i] = b;
+				}
+				len = message.length();
+				//std::cout << "\nlast_matching_bits = " << last_matching_bits;
+				int matching_len = last_matching_bits.length();;
+
+					for (int i = 0; i <= len - matching_len; i++ ){
+						//std::cout << "\n" << message.substr(i, matching_len);
+
+						if (message.substr(i,matching_len)== last_matching_bits){
+							//std::cout << "\nmatched!\n";
+							cells.push_back(message.substr(i,10));//cell id is 36 bit long , last  4 bit unused
+
+						}
+					}
+
+		}
+		return true;
+	}
+
+};
+
+#endif
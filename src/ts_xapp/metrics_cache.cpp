@@ -0,0 +1,394 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	metrics_cache.cpp
+    Abstract:	Implements the cache of UE and cell metrics. Instead of sweeping
+                whole SDL namespaces, the cache either fetches only the keys
+                reported by a change feed, or reads the keys of a single prefix
+                per polling round. In both cases only values that changed are
+                parsed. Readers never go to SDL.
+
+                Example of the UE metrics stored by KPIMON (and by populatedb)
+                { "UEID": 12345, "ServingCellID": "310-680-200-555002", ...,
+                  "ServingCellRF": [-115,-16,-5],
+                  "NeighborCellRF": [ {"CID": "310-680-200-555001", "CellRF": [-90,-13,-2.5]} ] }
+
+    Date:       18 Oct 2026
+*/
+
+#include "metrics_cache.hpp"
+#include "key_dispatcher.hpp"
+#include "metrics_record.hpp"
+
+#include <iostream>
+#include <string_view>
+
+#include <rapidjson/reader.h>
+#include <rapidjson/memorystream.h>
+
+using namespace rapidjson;
+
+namespace ts {
+
+namespace {     // SAX handlers for the metrics stored in SDL
+
+struct UEDataHandler : public BaseReaderHandler<UTF8<>, UEDataHandler> {
+    enum { SERVING_CELL_ID = 1, SERVING_CELL_RF, NEIGHBOR_CELL_RF, CID, CELL_RF };
+    static constexpr KeyDispatcher keys { "ServingCellID", "ServingCellRF", "NeighborCellRF", "CID", "CellRF" };
+
+    ue_metrics_t &ue;
+    int curr_key = 0;
+    int rf_array = 0;           // SERVING_CELL_RF or CELL_RF while inside one of these arrays
+    int rf_index = 0;
+    bool in_neighbors = false;
+
+    UEDataHandler( ue_metrics_t &ue ) : ue( ue ) { }
+
+    // RF arrays are [rsrp, rsrq, sinr]
+    bool Number( double v ) {
+        if( rf_array != 0 ) {
+            rf_t &rf = ( rf_array == SERVING_CELL_RF ) ? ue.serving_rf : ue.neighbors.back().rf;
+            switch( rf_index++ ) {
+                case 0: rf.rsrp = v; break;
+                case 1: rf.rsrq = v; break;
+                case 2: rf.sinr = v; break;
+            }
+        }
+        return true;
+    }
+    bool Int( int i ) { return Number( i ); }
+    bool Uint( unsigned u ) { return Number( u ); }
+    bool Int64( int64_t i ) { return Number( i ); }
+    bool Uint64( uint64_t u ) { return Number( u ); }
+    bool Double( double d ) { return Number( d ); }
+
+    bool String( const Ch* str, SizeType length, bool copy ) {
+        if( curr_key == SERVING_CELL_ID ) {
+            ue.serving_cell_id.assign( str, length );
+        } else if( curr_key == CID && in_neighbors ) {
+            ue.neighbors.back().cell_id.assign( str, length );
+        }
+        return true;
+    }
+    bool StartObject( ) {
+        if( in_neighbors ) {
+            ue.neighbors.emplace_back();
+        }
+        return true;
+    }
+    bool Key( const Ch* str, SizeType length, bool copy ) {
+        curr_key = keys.find( str, length );
+        return true;
+    }
+    bool StartArray( ) {
+        if( curr_key == SERVING_CELL_RF || ( curr_key == CELL_RF && in_neighbors ) ) {
+            rf_array = curr_key;
+            rf_index = 0;
+        } else if( curr_key == NEIGHBOR_CELL_RF ) {
+            in_neighbors = true;
+        }
+        return true;
+    }
+    bool EndArray( SizeType elementCount ) {
+        if( rf_array != 0 ) {
+            rf_array = 0;
+        } else if( in_neighbors ) {
+            in_neighbors = false;
+        }
+        curr_key = 0;
+        return true;
+    }
+};
+
+struct CellDataHandler : public BaseReaderHandler<UTF8<>, CellDataHandler> {
+    enum { AVAIL_PRB_DL = 1, AVAIL_PRB_UL, PDCP_BYTES_DL, PDCP_BYTES_UL };
+    static constexpr KeyDispatcher keys { "AvailPRBDL", "AvailPRBUL", "PDCPBytesDL", "PDCPBytesUL" };
+
+    cell_metrics_t &cell;
+    int curr_key = 0;
+
+    CellDataHandler( cell_metrics_t &cell ) : cell( cell ) { }
+
+    bool Number( double v ) {
+        switch( curr_key ) {
+            case AVAIL_PRB_DL: cell.avail_prb_dl = v; cell.has_avail_prb_dl = true; break;
+            case AVAIL_PRB_UL: cell.avail_prb_ul = v; break;
+            case PDCP_BYTES_DL: cell.pdcp_bytes_dl = v; break;
+            case PDCP_BYTES_UL: cell.pdcp_bytes_ul = v; break;
+        }
+        return true;
+    }
+    bool Int( int i ) { return Number( i ); }
+    bool Uint( unsigned u ) { return Number( u ); }
+    bool Int64( int64_t i ) { return Number( i ); }
+    bool Uint64( uint64_t u ) { return Number( u ); }
+    bool Double( double d ) { return Number( d ); }
+
+    bool Key( const Ch* str, SizeType length, bool copy ) {
+        curr_key = keys.find( str, length );
+        return true;
+    }
+};
+
+} // namespace
+
+/*
+    Parse the UE/cell metrics straight from the SDL buffer, which is not nil
+    terminated. Values are either binary records (see metrics_record.hpp),
+    read in place, or JSON.
+*/
+bool parse_ue_metrics( const char *buf, size_t len, ue_metrics_t &ue ) {
+    if( is_binary_record( (const uint8_t *) buf, len ) ) {
+        UeRecordView record( (const uint8_t *) buf, len );
+        if( !record.valid() ) {
+            return false;
+        }
+
+        ue.serving_cell_id = record.serving_cell_id();
+        ue.serving_rf = { record.rsrp(), record.rsrq(), record.sinr() };
+        ue.neighbors.resize( record.neighbor_count() );
+        for( size_t i = 0; i < ue.neighbors.size(); i++ ) {
+            ue.neighbors[i].cell_id = record.neighbor_cell_id( i );
+            ue.neighbors[i].rf = { record.neighbor_rsrp( i ), record.neighbor_rsrq( i ), record.neighbor_sinr( i ) };
+        }
+        return true;
+    }
+
+    UEDataHandler handler( ue );
+    Reader reader;
+    MemoryStream ms( buf, len );
+
+    return !reader.Parse( ms, handler ).IsError();
+}
+
+bool parse_cell_metrics( const char *buf, size_t len, cell_metrics_t &cell ) {
+    if( is_binary_record( (const uint8_t *) buf, len ) ) {
+        CellRecordView record( (const uint8_t *) buf, len );
+        if( !record.valid() ) {
+            return false;
+        }
+
+        cell.avail_prb_dl = record.avail_prb_dl();
+        cell.has_avail_prb_dl = true;       // always part of a binary record
+        cell.avail_prb_ul = record.avail_prb_ul();
+        cell.pdcp_bytes_dl = record.pdcp_bytes_dl();
+        cell.pdcp_bytes_ul = record.pdcp_bytes_ul();
+        return true;
+    }
+
+    CellDataHandler handler( cell );
+    Reader reader;
+    MemoryStream ms( buf, len );
+
+    return !reader.Parse( ms, handler ).IsError();
+}
+
+/*
+    Creates a cache that, when no change feed is available, polls one of
+    the key prefixes every interval, so a full pass over both namespaces
+    takes prefixes.size() * interval. Prefixes must not overlap (e.g. one
+    per leading character).
+*/
+MetricsCache::MetricsCache( std::shared_ptr<KvStore> store,
+                            const std::vector<std::string> &prefixes, std::chrono::milliseconds interval ) {
+    this->store = store;
+    this->prefixes = prefixes;
+    this->interval = interval;
+}
+
+MetricsCache::~MetricsCache( ) {
+    ue_sync.reset();
+    cell_sync.reset();
+
+    {
+        std::lock_guard<std::mutex> lock( poll_mutex );
+        stopping = true;
+    }
+    poll_cv.notify_all();
+
+    if( poller.joinable() ) {
+        poller.join();
+    }
+}
+
+/*
+    Starts keeping the cache up to date. With a change feed, only the
+    notified keys are fetched (after one initial full load); otherwise
+    the prefixes are polled in turn.
+*/
+void MetricsCache::start( ChangeFeed *feed ) {
+    if( feed != nullptr ) {
+        ue_sync = std::unique_ptr<SdlSync>( new SdlSync( *store, *feed, SDL_UE_NAMESPACE,
+            [this]( const sdl_datamap_t &changed, const sdl_keys_t &removed ) {
+                apply_changes( changed, removed, ues, parse_ue_metrics );
+            } ) );
+        cell_sync = std::unique_ptr<SdlSync>( new SdlSync( *store, *feed, SDL_CELL_NAMESPACE,
+            [this]( const sdl_datamap_t &changed, const sdl_keys_t &removed ) {
+                apply_changes( changed, removed, cells, parse_cell_metrics );
+            } ) );
+
+        ue_sync->resync();
+        cell_sync->resync();
+        return;
+    }
+
+    poller = std::thread( &MetricsCache::poll_loop, this );
+}
+
+void MetricsCache::poll_loop( ) {
+    size_t next = 0;
+    std::unique_lock<std::mutex> lock( poll_mutex );
+
+    while( !stopping && !prefixes.empty() ) {
+        lock.unlock();
+        try {
+            refresh_prefix( prefixes[next] );
+        } catch( const std::exception &e ) {
+            std::cout << "[ERROR] Unable to refresh SDL metrics with prefix \"" << prefixes[next] << "\": " << e.what() << std::endl;
+        }
+        next = ( next + 1 ) % prefixes.size();
+        lock.lock();
+
+        poll_cv.wait_for( lock, interval, [this]{ return stopping; } );
+    }
+}
+
+void MetricsCache::refresh_prefix( const std::string &prefix ) {
+    refresh( SDL_UE_NAMESPACE, prefix, ues, known_ues, parse_ue_metrics );
+    refresh( SDL_CELL_NAMESPACE, prefix, cells, known_cells, parse_cell_metrics );
+}
+
+/*
+    Reads the keys of a prefix and applies them to the cache; keys of that
+    prefix seen in the previous refresh but not anymore are removed.
+*/
+template<typename T>
+void MetricsCache::refresh( const std::string &ns, const std::string &prefix,
+                            std::unordered_map<std::string, entry<T>> &cache, known_keys_t &known,
+                            bool (*parse)( const char *, size_t, T & ) ) {
+    sdl_keys_t keys = store->find_keys( ns, prefix );
+    sdl_datamap_t data = store->get( ns, keys );
+
+    sdl_keys_t removed;
+    for( auto &k : known[prefix] ) {
+        if( keys.count( k ) == 0 ) {
+            removed.insert( removed.end(), k );
+        }
+    }
+    known[prefix] = std::move( keys );
+
+    apply_changes( data, removed, cache, parse );
+}
+
+/*
+    Updates the cache with the values that actually changed and evicts the
+    removed keys. Parsing happens outside of the exclusive lock, and values
+    whose bytes did not change are not parsed again.
+*/
+template<typename T>
+void MetricsCache::apply_changes( const sdl_datamap_t &changed, const sdl_keys_t &removed,
+                                  std::unordered_map<std::string, entry<T>> &cache,
+                                  bool (*parse)( const char *, size_t, T & ) ) {
+    std::vector<std::pair<std::string, entry<T>>> updates;
+    {
+        std::shared_lock<std::shared_mutex> lock( cache_mutex );
+
+        for( auto &kv : changed ) {
+            std::string_view value( (const char *) kv.second.data(), kv.second.size() );
+            size_t digest = std::hash<std::string_view>()( value );
+
+            auto it = cache.find( kv.first );
+            if( it != cache.end() && it->second.digest == digest ) {
+                continue;
+            }
+
+            entry<T> e { digest, T() };
+            if( parse( value.data(), value.size(), e.metrics ) ) {
+                updates.emplace_back( kv.first, std::move( e ) );
+            }
+        }
+    }
+
+    if( updates.empty() && removed.empty() ) {
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock( cache_mutex );
+    for( auto &u : updates ) {
+        cache[u.first] = std::move( u.second );
+    }
+    for( auto &k : removed ) {
+        cache.erase( k );
+    }
+}
+
+bool MetricsCache::get_ue( const std::string &ue_id, ue_metrics_t &ue ) const {
+    std::shared_lock<std::shared_mutex> lock( cache_mutex );
+
+    auto it = ues.find( ue_id );
+    if( it == ues.end() ) {
+        return false;
+    }
+    ue = it->second.metrics;
+
+    return true;
+}
+
+bool MetricsCache::get_cell( const std::string &cell_id, cell_metrics_t &cell ) const {
+    std::shared_lock<std::shared_mutex> lock( cache_mutex );
+
+    auto it = cells.find( cell_id );
+    if( it == cells.end() ) {
+        return false;
+    }
+    cell = it->second.metrics;
+
+    return true;
+}
+
+void MetricsCache::neighbor_relations( std::unordered_map<std::string, std::unordered_set<std::string>> &relations ) const {
+    std::shared_lock<std::shared_mutex> lock( cache_mutex );
+
+    for( const auto &ue : ues ) {
+        const ue_metrics_t &metrics = ue.second.metrics;
+        if( metrics.serving_cell_id.empty() || metrics.neighbors.empty() ) {
+            continue;
+        }
+
+        std::unordered_set<std::string> &neighbors = relations[metrics.serving_cell_id];
+        for( const neighbor_rf_t &neighbor : metrics.neighbors ) {
+            if( !neighbor.cell_id.empty() && neighbor.cell_id != metrics.serving_cell_id ) {
+                neighbors.insert( neighbor.cell_id );
+            }
+        }
+    }
+}
+
+size_t MetricsCache::ue_count( ) const {
+    std::shared_lock<std::shared_mutex> lock( cache_mutex );
+    return ues.size();
+}
+
+size_t MetricsCache::cell_count( ) const {
+    std::shared_lock<std::shared_mutex> lock( cache_mutex );
+    return cells.size();
+}
+
+} // namespace
@@ -0,0 +1,135 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	metrics_cache.hpp
+    Abstract:	Header for the in-process cache of UE and cell metrics stored
+                in SDL (namespaces TS-UE-metrics and TS-cell-metrics).
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _METRICS_CACHE_HPP
+#define _METRICS_CACHE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "sdl_sync.hpp"
+
+namespace ts {
+
+const std::string SDL_UE_NAMESPACE = "TS-UE-metrics";
+const std::string SDL_CELL_NAMESPACE = "TS-cell-metrics";
+
+typedef struct rf {
+    double rsrp = 0;
+    double rsrq = 0;
+    double sinr = 0;
+} rf_t;
+
+typedef struct neighbor_rf {
+    std::string cell_id;
+    rf_t rf;
+} neighbor_rf_t;
+
+typedef struct ue_metrics {
+    std::string serving_cell_id;
+    rf_t serving_rf;
+    std::vector<neighbor_rf_t> neighbors;
+} ue_metrics_t;
+
+typedef struct cell_metrics {
+    double avail_prb_dl = 0;
+    bool has_avail_prb_dl = false;      // false if the cell did not report AvailPRBDL
+    double avail_prb_ul = 0;
+    double pdcp_bytes_dl = 0;
+    double pdcp_bytes_ul = 0;
+} cell_metrics_t;
+
+bool parse_ue_metrics( const char *buf, size_t len, ue_metrics_t &ue );
+bool parse_cell_metrics( const char *buf, size_t len, cell_metrics_t &cell );
+
+class MetricsCache {
+    private:
+        template<typename T>
+        struct entry {
+            size_t digest;          // hash of the SDL value the metrics were parsed from
+            T metrics;
+        };
+
+        std::shared_ptr<KvStore> store;
+        std::vector<std::string> prefixes;
+        std::chrono::milliseconds interval;
+
+        mutable std::shared_mutex cache_mutex;
+        std::unordered_map<std::string, entry<ue_metrics_t>> ues;
+        std::unordered_map<std::string, entry<cell_metrics_t>> cells;
+
+        // keys seen in the last refresh of each prefix; only used by the poller
+        typedef std::unordered_map<std::string, sdl_keys_t> known_keys_t;
+        known_keys_t known_ues;
+        known_keys_t known_cells;
+
+        bool stopping = false;
+        std::mutex poll_mutex;
+        std::condition_variable poll_cv;
+        std::thread poller;
+
+        // notification driven sync, used instead of the poller when the store has a change feed
+        std::unique_ptr<SdlSync> ue_sync;
+        std::unique_ptr<SdlSync> cell_sync;
+
+        void poll_loop( );
+        template<typename T>
+        void refresh( const std::string &ns, const std::string &prefix,
+                      std::unordered_map<std::string, entry<T>> &cache, known_keys_t &known,
+                      bool (*parse)( const char *, size_t, T & ) );
+        template<typename T>
+        void apply_changes( const sdl_datamap_t &changed, const sdl_keys_t &removed,
+                            std::unordered_map<std::string, entry<T>> &cache,
+                            bool (*parse)( const char *, size_t, T & ) );
+
+    public:
+        MetricsCache( std::shared_ptr<KvStore> store,
+                      const std::vector<std::string> &prefixes, std::chrono::milliseconds interval );
+        ~MetricsCache();
+
+        void start( ChangeFeed *feed = nullptr );
+        void refresh_prefix( const std::string &prefix );
+
+        bool get_ue( const std::string &ue_id, ue_metrics_t &ue ) const;
+        bool get_cell( const std::string &cell_id, cell_metrics_t &cell ) const;
+        // serving cell -> cells its UEs reported in NeighborCellRF
+        void neighbor_relations( std::unordered_map<std::string, std::unordered_set<std::string>> &relations ) const;
+        size_t ue_count( ) const;
+        size_t cell_count( ) const;
+};
+
+} // namespace
+
+#endif
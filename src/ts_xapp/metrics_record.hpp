@@ -0,0 +1,281 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	metrics_record.hpp
+    Abstract:	Compact, versioned binary records of UE and cell metrics stored
+                in SDL, as an alternative to JSON strings. Hot fields are at
+                fixed offsets, so readers access them in place from the SDL
+                buffer without parsing or copying the record.
+
+                All values are little endian. Every record starts with
+
+                    0  u16  magic 0x5354 ("TS")
+                    2  u8   version
+                    3  u8   kind (1 UE, 2 cell)
+
+                UE record, version 1
+                    4  u16  neighbor count
+                    6  u16  offset of the serving cell id
+                    8  u8   length of the serving cell id
+                    9  u8   reserved (3 bytes)
+                   12  f32  serving cell RSRP
+                   16  f32  serving cell RSRQ
+                   20  f32  serving cell SINR
+                   24  u32  PRB usage DL
+                   28  u32  PRB usage UL
+                   32  u64  PDCP bytes DL
+                   40  u64  PDCP bytes UL
+                   48  i64  RF measurement timestamp (ms)
+                   56  neighbor entries of 16 bytes each:
+                         f32 RSRP, f32 RSRQ, f32 SINR, u16 cell id offset, u8 cell id length, u8 reserved
+                  ...  cell ids (not nil terminated)
+
+                Cell record, version 1
+                    4  u32  reserved
+                    8  u32  available PRBs DL
+                   12  u32  available PRBs UL
+                   16  u64  PDCP bytes DL
+                   24  u64  PDCP bytes UL
+                   32  i64  PRB measurement timestamp (ms)
+
+                Offsets are 16 bits, so a UE record is at most 64 KiB; a UE
+                whose record would be larger is stored as JSON.
+
+                New versions may only append fields; readers of an older
+                version keep working on newer records.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _METRICS_RECORD_HPP
+#define _METRICS_RECORD_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ts {
+
+const uint16_t RECORD_MAGIC = 0x5354;
+const uint8_t RECORD_VERSION = 1;
+const uint8_t RECORD_KIND_UE = 1;
+const uint8_t RECORD_KIND_CELL = 2;
+
+const size_t UE_RECORD_FIXED_SIZE = 56;
+const size_t UE_RECORD_NEIGHBOR_SIZE = 16;
+const size_t CELL_RECORD_SIZE = 40;
+const size_t UE_RECORD_MAX_SIZE = UINT16_MAX;     // largest offset a record can hold
+
+namespace record {  // little endian accessors (the supported targets are little endian)
+
+template<typename T>
+inline T load( const uint8_t *p ) {
+    T v;
+    memcpy( &v, p, sizeof( T ) );
+    return v;
+}
+
+template<typename T>
+inline void store( uint8_t *p, T v ) {
+    memcpy( p, &v, sizeof( T ) );
+}
+
+} // namespace
+
+// ---------------- writer side --------------------------------------------------
+
+typedef struct ue_record_neighbor {
+    std::string cell_id;
+    float rsrp = 0;
+    float rsrq = 0;
+    float sinr = 0;
+} ue_record_neighbor_t;
+
+typedef struct ue_record {
+    std::string serving_cell_id;
+    float rsrp = 0;
+    float rsrq = 0;
+    float sinr = 0;
+    uint32_t prb_usage_dl = 0;
+    uint32_t prb_usage_ul = 0;
+    uint64_t pdcp_bytes_dl = 0;
+    uint64_t pdcp_bytes_ul = 0;
+    int64_t timestamp_ms = 0;
+    std::vector<ue_record_neighbor_t> neighbors;
+} ue_record_t;
+
+typedef struct cell_record {
+    uint32_t avail_prb_dl = 0;
+    uint32_t avail_prb_ul = 0;
+    uint64_t pdcp_bytes_dl = 0;
+    uint64_t pdcp_bytes_ul = 0;
+    int64_t timestamp_ms = 0;
+} cell_record_t;
+
+/*
+    Encodes a UE record into out (replacing its content). Cell ids longer
+    than 255 bytes are truncated. Returns false, leaving out empty, if the
+    record is larger than UE_RECORD_MAX_SIZE; the UE must then be stored
+    as JSON.
+*/
+inline bool encode_ue_record( const ue_record_t &ue, std::vector<uint8_t> &out ) {
+    size_t strings = ue.serving_cell_id.size() > 255 ? 255 : ue.serving_cell_id.size();
+    for( auto &n : ue.neighbors ) {
+        strings += n.cell_id.size() > 255 ? 255 : n.cell_id.size();
+    }
+
+    if( UE_RECORD_FIXED_SIZE + ue.neighbors.size() * UE_RECORD_NEIGHBOR_SIZE + strings > UE_RECORD_MAX_SIZE ) {
+        out.clear();
+        return false;       // offsets would wrap
+    }
+
+    out.assign( UE_RECORD_FIXED_SIZE + ue.neighbors.size() * UE_RECORD_NEIGHBOR_SIZE + strings, 0 );
+    uint8_t *p = out.data();
+    size_t heap = UE_RECORD_FIXED_SIZE + ue.neighbors.size() * UE_RECORD_NEIGHBOR_SIZE;
+
+    auto put_string = [&]( const std::string &s, uint8_t *off_at, uint8_t *len_at ) {
+        size_t len = s.size() > 255 ? 255 : s.size();
+        record::store<uint16_t>( off_at, (uint16_t) heap );
+        *len_at = (uint8_t) len;
+        memcpy( p + heap, s.data(), len );
+        heap += len;
+    };
+
+    record::store<uint16_t>( p, RECORD_MAGIC );
+    p[2] = RECORD_VERSION;
+    p[3] = RECORD_KIND_UE;
+    record::store<uint16_t>( p + 4, (uint16_t) ue.neighbors.size() );
+    put_string( ue.serving_cell_id, p + 6, p + 8 );
+    record::store<float>( p + 12, ue.rsrp );
+    record::store<float>( p + 16, ue.rsrq );
+    record::store<float>( p + 20, ue.sinr );
+    record::store<uint32_t>( p + 24, ue.prb_usage_dl );
+    record::store<uint32_t>( p + 28, ue.prb_usage_ul );
+    record::store<uint64_t>( p + 32, ue.pdcp_bytes_dl );
+    record::store<uint64_t>( p + 40, ue.pdcp_bytes_ul );
+    record::store<int64_t>( p + 48, ue.timestamp_ms );
+
+    uint8_t *n = p + UE_RECORD_FIXED_SIZE;
+    for( auto &nb : ue.neighbors ) {
+        record::store<float>( n, nb.rsrp );
+        record::store<float>( n + 4, nb.rsrq );
+        record::store<float>( n + 8, nb.sinr );
+        put_string( nb.cell_id, n + 12, n + 14 );
+        n += UE_RECORD_NEIGHBOR_SIZE;
+    }
+
+    return true;
+}
+
+inline void encode_cell_record( const cell_record_t &cell, std::vector<uint8_t> &out ) {
+    out.assign( CELL_RECORD_SIZE, 0 );
+    uint8_t *p = out.data();
+
+    record::store<uint16_t>( p, RECORD_MAGIC );
+    p[2] = RECORD_VERSION;
+    p[3] = RECORD_KIND_CELL;
+    record::store<uint32_t>( p + 8, cell.avail_prb_dl );
+    record::store<uint32_t>( p + 12, cell.avail_prb_ul );
+    record::store<uint64_t>( p + 16, cell.pdcp_bytes_dl );
+    record::store<uint64_t>( p + 24, cell.pdcp_bytes_ul );
+    record::store<int64_t>( p + 32, cell.timestamp_ms );
+}
+
+// ---------------- reader side --------------------------------------------------
+
+// true if the buffer holds a binary record (JSON values never start with the magic)
+inline bool is_binary_record( const uint8_t *buf, size_t len ) {
+    return len >= 4 && record::load<uint16_t>( buf ) == RECORD_MAGIC;
+}
+
+/*
+    Zero-copy view of a UE record. The view points into the caller's buffer,
+    which must outlive it. valid() must be checked before any accessor.
+*/
+class UeRecordView {
+    private:
+        const uint8_t *p;
+        size_t len;
+
+        std::string_view string_at( const uint8_t *off_at, const uint8_t *len_at ) const {
+            size_t off = record::load<uint16_t>( off_at );
+            size_t n = *len_at;
+            if( off + n > len ) {
+                return std::string_view();
+            }
+            return std::string_view( (const char *) p + off, n );
+        }
+
+    public:
+        UeRecordView( const uint8_t *buf, size_t len ) : p( buf ), len( len ) { }
+
+        bool valid( ) const {
+            return len >= UE_RECORD_FIXED_SIZE && record::load<uint16_t>( p ) == RECORD_MAGIC
+                && p[2] >= 1 && p[3] == RECORD_KIND_UE
+                && len >= UE_RECORD_FIXED_SIZE + neighbor_count() * UE_RECORD_NEIGHBOR_SIZE;
+        }
+
+        uint8_t version( ) const { return p[2]; }
+        size_t neighbor_count( ) const { return record::load<uint16_t>( p + 4 ); }
+        std::string_view serving_cell_id( ) const { return string_at( p + 6, p + 8 ); }
+        float rsrp( ) const { return record::load<float>( p + 12 ); }
+        float rsrq( ) const { return record::load<float>( p + 16 ); }
+        float sinr( ) const { return record::load<float>( p + 20 ); }
+        uint32_t prb_usage_dl( ) const { return record::load<uint32_t>( p + 24 ); }
+        uint32_t prb_usage_ul( ) const { return record::load<uint32_t>( p + 28 ); }
+        uint64_t pdcp_bytes_dl( ) const { return record::load<uint64_t>( p + 32 ); }
+        uint64_t pdcp_bytes_ul( ) const { return record::load<uint64_t>( p + 40 ); }
+        int64_t timestamp_ms( ) const { return record::load<int64_t>( p + 48 ); }
+
+        std::string_view neighbor_cell_id( size_t i ) const {
+            const uint8_t *n = p + UE_RECORD_FIXED_SIZE + i * UE_RECORD_NEIGHBOR_SIZE;
+            return string_at( n + 12, n + 14 );
+        }
+        float neighbor_rsrp( size_t i ) const { return record::load<float>( p + UE_RECORD_FIXED_SIZE + i * UE_RECORD_NEIGHBOR_SIZE ); }
+        float neighbor_rsrq( size_t i ) const { return record::load<float>( p + UE_RECORD_FIXED_SIZE + i * UE_RECORD_NEIGHBOR_SIZE + 4 ); }
+        float neighbor_sinr( size_t i ) const { return record::load<float>( p + UE_RECORD_FIXED_SIZE + i * UE_RECORD_NEIGHBOR_SIZE + 8 ); }
+};
+
+class CellRecordView {
+    private:
+        const uint8_t *p;
+        size_t len;
+
+    public:
+        CellRecordView( const uint8_t *buf, size_t len ) : p( buf ), len( len ) { }
+
+        bool valid( ) const {
+            return len >= CELL_RECORD_SIZE && record::load<uint16_t>( p ) == RECORD_MAGIC
+                && p[2] >= 1 && p[3] == RECORD_KIND_CELL;
+        }
+
+        uint8_t version( ) const { return p[2]; }
+        uint32_t avail_prb_dl( ) const { return record::load<uint32_t>( p + 8 ); }
+        uint32_t avail_prb_ul( ) const { return record::load<uint32_t>( p + 12 ); }
+        uint64_t pdcp_bytes_dl( ) const { return record::load<uint64_t>( p + 16 ); }
+        uint64_t pdcp_bytes_ul( ) const { return record::load<uint64_t>( p + 24 ); }
+        int64_t timestamp_ms( ) const { return record::load<int64_t>( p + 32 ); }
+};
+
+} // namespace
+
+#endif
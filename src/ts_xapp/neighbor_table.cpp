@@ -0,0 +1,157 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	neighbor_table.cpp
+    Abstract:	Implements the neighbor relation table.
+
+    Date:       18 Oct 2026
+*/
+
+#include "neighbor_table.hpp"
+
+#include <iostream>
+
+namespace ts {
+
+namespace {
+
+const std::chrono::seconds NEIGHBOR_LOG_INTERVAL( 10 );
+
+} // namespace
+
+const std::unordered_set<std::string> *neighbor_snapshot::neighbors_of( const std::string &cell_id ) const {
+    if( measured.count( cell_id ) == 0 ) {
+        return nullptr;
+    }
+
+    auto it = neighbors.find( cell_id );
+    return it == neighbors.end() ? nullptr : &it->second;
+}
+
+NeighborTable::NeighborTable( const MetricsCache *metrics, std::chrono::milliseconds interval ) :
+    metrics( metrics ), interval( interval ), current( std::make_shared<const neighbor_snapshot_t>() ) {
+}
+
+NeighborTable::~NeighborTable( ) {
+    {
+        std::lock_guard<std::mutex> lock( refresh_mutex );
+        stopping = true;
+    }
+    refresh_cv.notify_all();
+
+    if( refresher.joinable() ) {
+        refresher.join();
+    }
+}
+
+void NeighborTable::add_e2_node( const std::vector<std::string> &cells ) {
+    std::lock_guard<std::mutex> lock( e2_mutex );
+
+    for( const std::string &cell : cells ) {
+        std::unordered_set<std::string> &neighbors = e2[cell];
+        for( const std::string &other : cells ) {
+            if( other != cell ) {
+                neighbors.insert( other );
+            }
+        }
+    }
+}
+
+void NeighborTable::start( ) {
+    refresh();
+    refresher = std::thread( &NeighborTable::refresh_loop, this );
+}
+
+void NeighborTable::refresh_loop( ) {
+    auto next_log = std::chrono::steady_clock::now() + NEIGHBOR_LOG_INTERVAL;
+    std::unique_lock<std::mutex> lock( refresh_mutex );
+
+    while( !refresh_cv.wait_for( lock, interval, [this]{ return stopping; } ) ) {
+        lock.unlock();
+        refresh();
+        if( std::chrono::steady_clock::now() >= next_log ) {
+            log_stats();
+            next_log = std::chrono::steady_clock::now() + NEIGHBOR_LOG_INTERVAL;
+        }
+        lock.lock();
+    }
+}
+
+/*
+    Merges the E2 relations with those the cached UEs reported and publishes
+    a new snapshot. Relations are rebuilt from scratch, so cells no UE
+    reports anymore drop out of the table.
+*/
+void NeighborTable::refresh( ) {
+    std::shared_ptr<neighbor_snapshot_t> snap = std::make_shared<neighbor_snapshot_t>();
+
+    if( metrics != nullptr ) {
+        metrics->neighbor_relations( snap->neighbors );
+    }
+    for( const auto &cell : snap->neighbors ) {
+        if( !cell.second.empty() ) {
+            snap->measured.insert( cell.first );
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock( e2_mutex );
+        for( const auto &cell : e2 ) {
+            snap->neighbors[cell.first].insert( cell.second.begin(), cell.second.end() );
+        }
+    }
+
+    for( const auto &cell : snap->neighbors ) {
+        snap->relations += cell.second.size();
+    }
+
+    std::lock_guard<std::mutex> lock( publish_mutex );
+    snap->version = current.load()->version + 1;
+    current.store( snap );
+}
+
+std::shared_ptr<const neighbor_snapshot_t> NeighborTable::snapshot( ) const {
+    return current.load();
+}
+
+neighbor_stats_t NeighborTable::get_stats( ) const {
+    neighbor_stats_t stats;
+    std::shared_ptr<const neighbor_snapshot_t> snap = snapshot();
+
+    stats.cells = snap->measured.size();
+    stats.relations = snap->relations;
+    stats.pruned = pruned.load( std::memory_order_relaxed );
+    stats.hinted = hinted.load( std::memory_order_relaxed );
+
+    return stats;
+}
+
+void NeighborTable::log_stats( ) {
+    neighbor_stats_t stats = get_stats();
+
+    if( stats.pruned + stats.hinted == last_logged ) {
+        return;     // the table was not used since the last time
+    }
+    last_logged = stats.pruned + stats.hinted;
+
+    std::cout << "[INFO] Neighbor table: " << stats.cells << " cells, " << stats.relations << " relations, "
+              << stats.pruned << " predicted cells pruned, " << stats.hinted << " UEs sent with candidate cells" << std::endl;
+}
+
+} // namespace
@@ -0,0 +1,128 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	neighbor_table.hpp
+    Abstract:	Header for the neighbor relation table: the cells a UE served
+                by a given cell can be handed off to. Relations come from
+                two sources:
+
+                    E2 setup    cells of the same E2 node are neighbors of
+                                each other
+                    SDL         a cell reported in the NeighborCellRF of a
+                                UE is a neighbor of the UE serving cell
+
+                A refresh thread merges both sources and publishes an
+                immutable snapshot; readers only load the current snapshot,
+                without taking any lock.
+
+                Only the cells UEs reported neighbors for have known
+                neighbors, the E2 relations are added to theirs. An E2 node
+                says nothing about cells of other nodes, so the E2 relations
+                alone would rule out every handoff between nodes. Callers
+                must not prune the candidates of a cell without known
+                neighbors.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _NEIGHBOR_TABLE_HPP
+#define _NEIGHBOR_TABLE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "metrics_cache.hpp"
+#include "snapshot_slot.hpp"
+
+namespace ts {
+
+typedef std::unordered_map<std::string, std::unordered_set<std::string>> cell_relations_t;
+
+typedef struct neighbor_snapshot {
+    cell_relations_t neighbors;     // serving cell -> neighbor cells, the serving cell excluded
+    std::unordered_set<std::string> measured;   // serving cells with neighbors reported by UEs
+    size_t relations = 0;
+    unsigned long version = 0;
+
+    // nil if the cell has no known neighbors
+    const std::unordered_set<std::string> *neighbors_of( const std::string &cell_id ) const;
+} neighbor_snapshot_t;
+
+typedef struct neighbor_stats {
+    size_t cells = 0;               // serving cells with known neighbors (reported by UEs)
+    size_t relations = 0;
+    uint64_t pruned = 0;            // predicted cells left out of handoff decisions
+    uint64_t hinted = 0;            // UEs sent to QP with their candidate cells
+} neighbor_stats_t;
+
+class NeighborTable {
+    private:
+        const MetricsCache *metrics;        // nil without the SDL metrics cache
+        std::chrono::milliseconds interval;
+
+        std::mutex e2_mutex;
+        cell_relations_t e2;
+
+        std::mutex publish_mutex;           // serializes refreshes
+        SnapshotSlot<neighbor_snapshot_t> current;
+
+        std::atomic<uint64_t> pruned { 0 };
+        std::atomic<uint64_t> hinted { 0 };
+        uint64_t last_logged = 0;
+
+        bool stopping = false;
+        std::mutex refresh_mutex;
+        std::condition_variable refresh_cv;
+        std::thread refresher;
+
+        void refresh_loop( );
+        void log_stats( );
+
+    public:
+        NeighborTable( const MetricsCache *metrics, std::chrono::milliseconds interval );
+        ~NeighborTable();
+
+        // records the cells of one E2 node, as listed in its E2 setup
+        void add_e2_node( const std::vector<std::string> &cells );
+
+        // publishes a first snapshot and starts refreshing it every interval
+        void start( );
+        void refresh( );
+
+        std::shared_ptr<const neighbor_snapshot_t> snapshot( ) const;
+
+        void count_pruned( size_t cells ) { pruned.fetch_add( cells, std::memory_order_relaxed ); }
+        void count_hinted( size_t ues ) { hinted.fetch_add( ues, std::memory_order_relaxed ); }
+
+        neighbor_stats_t get_stats( ) const;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,168 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	policy_store.cpp
+    Abstract:	Implements the store of A1 policy instances keyed by policy type
+                and policy instance id.
+
+    Date:       18 Oct 2026
+*/
+
+#include "policy_store.hpp"
+
+namespace ts {
+
+PolicyOp to_policy_op( const std::string &operation ) {
+    if( operation.compare( "CREATE" ) == 0 ) {
+        return PolicyOp::CREATE;
+    } else if( operation.compare( "UPDATE" ) == 0 ) {
+        return PolicyOp::UPDATE;
+    } else if( operation.compare( "DELETE" ) == 0 ) {
+        return PolicyOp::DELETE;
+    }
+
+    return PolicyOp::UNKNOWN;
+}
+
+PolicyStore::PolicyStore( CellIndex &cells ) : cells( cells ), current( std::make_shared<const policy_snapshot_t>() ) {
+}
+
+/*
+    Applies an A1 operation on a policy instance and publishes a new snapshot.
+    CREATE and UPDATE both install the instance (A1 re-sends CREATE for
+    existing instances on query), while DELETE removes it. Returns false and
+    sets error if the operation cannot be applied.
+*/
+bool PolicyStore::apply( PolicyOp op, const policy_t &policy, std::string &error ) {
+    policy_key_t key( policy.type_id, policy.instance_id );
+
+    if( policy.instance_id.empty() ) {
+        error = "missing policy_instance_id";
+        return false;
+    }
+
+    if( policy.scope != PolicyScope::GLOBAL && policy.cells.empty() && op != PolicyOp::DELETE ) {
+        error = "scoped policy instance " + policy.instance_id + " has no cells";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock( writer_mutex );
+
+    switch( op ) {
+        case PolicyOp::CREATE:
+        case PolicyOp::UPDATE: {
+            policy_t p = policy;
+            p.seq = ++seq;
+            instances[key] = p;
+            break;
+        }
+
+        case PolicyOp::DELETE:
+            if( instances.erase( key ) == 0 ) {
+                error = "policy instance " + policy.instance_id + " does not exist";
+                return false;
+            }
+            break;
+
+        default:
+            error = "unknown policy operation";
+            return false;
+    }
+
+    publish();
+
+    return true;
+}
+
+/*
+    Builds a new snapshot from the writer's instances and publishes it in
+    place of the current one. Must be called with writer_mutex held.
+
+    Global instances of the TS policy type set the default threshold (the
+    latest applied one wins). Scoped instances are compiled into one
+    threshold per cell, taken from the instance with the highest scope
+    precedence and, among those, the latest applied. The cells of scoped
+    instances are given their index here.
+*/
+void PolicyStore::publish( ) {
+    std::shared_ptr<policy_snapshot_t> snap = std::make_shared<policy_snapshot_t>();
+    std::vector<std::pair<int, unsigned long>> ranks;   // (scope, seq) of the instance setting each cell
+    unsigned long latest = 0;
+
+    snap->instances = instances;
+    snap->version = seq;
+    for( auto &it : instances ) {
+        const policy_t &p = it.second;
+        if( p.type_id != TS_POLICY_TYPE ) {
+            continue;
+        }
+
+        if( p.scope == PolicyScope::GLOBAL ) {
+            if( p.seq > latest ) {
+                latest = p.seq;
+                snap->downlink_threshold = p.threshold;
+            }
+            continue;
+        }
+
+        std::pair<int, unsigned long> rank( static_cast<int>( p.scope ), p.seq );
+        for( const std::string &cell_id : p.cells ) {
+            int cell = cells.intern( cell_id );
+            if( cell == NO_CELL ) {
+                continue;
+            }
+            if( (size_t) cell >= ranks.size() ) {
+                ranks.resize( cell + 1, std::make_pair( -1, 0UL ) );
+                snap->cell_thresholds.resize( cell + 1, NO_CELL_THRESHOLD );
+            }
+
+            if( ranks[cell] < rank ) {
+                snap->scoped_cells += ranks[cell].first < 0;
+                ranks[cell] = rank;
+                snap->cell_thresholds[cell] = p.threshold;
+            }
+        }
+    }
+
+    current.store( snap );
+}
+
+/*
+    Returns the effective threshold for UEs served by a cell, given by its
+    index; cells that were not indexed (NO_CELL) get the global threshold.
+*/
+int policy_snapshot::threshold_for( int cell ) const {
+    if( cell < 0 || (size_t) cell >= cell_thresholds.size() || cell_thresholds[cell] == NO_CELL_THRESHOLD ) {
+        return downlink_threshold;
+    }
+
+    return cell_thresholds[cell];
+}
+
+/*
+    Returns the current snapshot. Callers hold on to it for as long as they
+    need a consistent view, regardless of concurrent updates. Never blocks,
+    not even while a writer publishes.
+*/
+std::shared_ptr<const policy_snapshot_t> PolicyStore::snapshot( ) const {
+    return current.load();
+}
+
+} // namespace
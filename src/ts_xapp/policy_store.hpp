@@ -0,0 +1,111 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	policy_store.hpp
+    Abstract:	Header for the store of A1 policy instances. Writers apply
+                CREATE/UPDATE/DELETE operations under a lock and publish an
+                immutable snapshot; readers only load the current snapshot,
+                without taking any lock.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _POLICY_STORE_HPP
+#define _POLICY_STORE_HPP
+
+#include <climits>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cell_index.hpp"
+#include "snapshot_slot.hpp"
+
+namespace ts {
+
+const int TS_POLICY_TYPE = 20008;   // A1 policy type handled by the TS xApp
+
+enum class PolicyOp { CREATE, UPDATE, DELETE, UNKNOWN };
+
+PolicyOp to_policy_op( const std::string &operation );
+
+/*
+    Where a policy applies. The order is the precedence among overlapping
+    policies: a cell policy overrides a cell group policy, which overrides
+    a global policy.
+*/
+enum class PolicyScope { GLOBAL = 0, CELL_GROUP = 1, CELL = 2 };
+
+typedef struct policy {
+    int type_id = 0;
+    std::string instance_id;
+    int threshold = 0;              // downlink threshold in percentage
+    PolicyScope scope = PolicyScope::GLOBAL;
+    std::vector<std::string> cells; // cells the policy applies to (non global scopes)
+    unsigned long seq = 0;          // order in which this instance was last applied
+} policy_t;
+
+typedef std::pair<int, std::string> policy_key_t;  // (policy type, policy instance)
+
+/*
+    Immutable view of all policy instances at a given point in time.
+    A snapshot is never modified after it is published.
+
+    Scoped policies of type 20008 are compiled into one threshold per cell,
+    in a flat array indexed by the cell index (see cell_index.hpp), so the
+    effective threshold of a resolved serving cell costs no hashing.
+*/
+const int NO_CELL_THRESHOLD = INT_MIN;
+
+typedef struct policy_snapshot {
+    std::map<policy_key_t, policy_t> instances;
+    int downlink_threshold = 0;     // threshold of policy type 20008 for cells without a scoped policy
+    std::vector<int> cell_thresholds;   // by cell index; NO_CELL_THRESHOLD where no scoped policy applies
+    size_t scoped_cells = 0;        // cells with a scoped threshold
+    unsigned long version = 0;
+
+    int threshold_for( int cell ) const;
+} policy_snapshot_t;
+
+class PolicyStore {
+    private:
+        CellIndex &cells;
+        std::mutex writer_mutex;    // serializes writers only
+        std::map<policy_key_t, policy_t> instances;
+        unsigned long seq = 0;
+        SnapshotSlot<policy_snapshot_t> current;
+
+        void publish( );
+
+    public:
+        explicit PolicyStore( CellIndex &cells );
+
+        bool apply( PolicyOp op, const policy_t &policy, std::string &error );
+        std::shared_ptr<const policy_snapshot_t> snapshot( ) const;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,171 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	prediction_cache.cpp
+    Abstract:	Implements the per UE prediction cache.
+
+    Date:       18 Oct 2026
+*/
+
+#include "prediction_cache.hpp"
+
+#include <functional>
+#include <iostream>
+
+namespace ts {
+
+namespace {
+
+const std::chrono::seconds LOG_INTERVAL( 10 );
+
+} // namespace
+
+PredictionCache::PredictionCache( size_t capacity, std::chrono::milliseconds ttl ) :
+    shard_capacity( capacity / SHARDS > 0 ? capacity / SHARDS : 1 ), ttl( ttl ), next_log( clock::now() + LOG_INTERVAL ) { }
+
+PredictionCache::shard &PredictionCache::shard_of( const std::string &ue_id ) {
+    return shards[std::hash<std::string>()( ue_id ) % SHARDS];
+}
+
+void PredictionCache::put( const ue_prediction_t &prediction ) {
+    shard &s = shard_of( prediction.ue_id );
+    std::lock_guard<std::mutex> lock( s.mutex );
+
+    auto it = s.index.find( prediction.ue_id );
+    if( it != s.index.end() ) {
+        it->second->prediction = prediction;
+        it->second->stored_at = clock::now();
+        s.lru.splice( s.lru.begin(), s.lru, it->second );
+        return;
+    }
+
+    if( s.index.size() >= shard_capacity ) {
+        s.index.erase( s.lru.back().prediction.ue_id );
+        s.lru.pop_back();
+        evictions.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    s.lru.push_front( { prediction, clock::now() } );
+    s.index[prediction.ue_id] = s.lru.begin();
+}
+
+bool PredictionCache::get( const std::string &ue_id, ue_prediction_t &prediction ) {
+    auto now = clock::now();
+    bool found = false;
+
+    lookups.fetch_add( 1, std::memory_order_relaxed );
+    {
+        shard &s = shard_of( ue_id );
+        std::lock_guard<std::mutex> lock( s.mutex );
+
+        auto it = s.index.find( ue_id );
+        if( it != s.index.end() ) {
+            if( now - it->second->stored_at <= ttl ) {
+                prediction = it->second->prediction;
+                s.lru.splice( s.lru.begin(), s.lru, it->second );
+                found = true;
+            } else {            // expired, make room now rather than at eviction time
+                s.lru.erase( it->second );
+                s.index.erase( it );
+            }
+        }
+    }
+
+    if( found ) {
+        hits.fetch_add( 1, std::memory_order_relaxed );
+    }
+    maybe_log( now );
+
+    return found;
+}
+
+void PredictionCache::invalidate( const std::string &ue_id ) {
+    shard &s = shard_of( ue_id );
+    std::lock_guard<std::mutex> lock( s.mutex );
+
+    auto it = s.index.find( ue_id );
+    if( it != s.index.end() ) {
+        s.lru.erase( it->second );
+        s.index.erase( it );
+    }
+}
+
+void PredictionCache::take_fresh( std::vector<std::string> &ue_ids, std::vector<ue_prediction_t> &known ) {
+    size_t before = known.size();
+    size_t kept = 0;
+
+    for( size_t i = 0; i < ue_ids.size(); i++ ) {
+        ue_prediction_t prediction;
+        if( get( ue_ids[i], prediction ) ) {
+            known.push_back( std::move( prediction ) );
+            continue;
+        }
+
+        if( kept != i ) {           // moving an id onto itself would leave it empty
+            ue_ids[kept] = std::move( ue_ids[i] );
+        }
+        kept++;
+    }
+    ue_ids.resize( kept );
+
+    if( known.size() > before ) {
+        count_saved( known.size() - before, ue_ids.empty() );
+    }
+}
+
+// accounts for the QP work lookups saved
+void PredictionCache::count_saved( size_t ues, bool whole_request ) {
+    ues_saved.fetch_add( ues, std::memory_order_relaxed );
+    if( whole_request ) {
+        requests_saved.fetch_add( 1, std::memory_order_relaxed );
+    }
+}
+
+prediction_cache_stats_t PredictionCache::get_stats( ) {
+    prediction_cache_stats_t stats;
+
+    stats.lookups = lookups.load( std::memory_order_relaxed );
+    stats.hits = hits.load( std::memory_order_relaxed );
+    stats.ues_saved = ues_saved.load( std::memory_order_relaxed );
+    stats.requests_saved = requests_saved.load( std::memory_order_relaxed );
+    stats.evictions = evictions.load( std::memory_order_relaxed );
+    for( shard &s : shards ) {
+        std::lock_guard<std::mutex> lock( s.mutex );
+        stats.size += s.index.size();
+    }
+
+    return stats;
+}
+
+void PredictionCache::maybe_log( clock::time_point now ) {
+    std::unique_lock<std::mutex> lock( log_mutex, std::try_to_lock );
+    if( !lock.owns_lock() || now < next_log ) {
+        return;
+    }
+    next_log = now + LOG_INTERVAL;
+
+    prediction_cache_stats_t stats = get_stats();
+    std::cout << "[INFO] Prediction cache: " << stats.size << " UEs, " << stats.lookups << " lookups, "
+              << ( stats.lookups > 0 ? 100.0 * stats.hits / stats.lookups : 0.0 ) << "% hits, "
+              << stats.ues_saved << " UE predictions and " << stats.requests_saved << " QP requests saved, "
+              << stats.evictions << " evictions" << std::endl;
+}
+
+} // namespace
@@ -0,0 +1,115 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	prediction_cache.hpp
+    Abstract:	Header for the cache of the last prediction received for
+                each UE. An anomaly of a UE whose prediction is younger than
+                the TTL goes straight to the handoff decision, without a
+                round trip to QP.
+
+                The cache is bounded: each shard evicts its least recently
+                used UE when full. Shards have their own lock, so the
+                threads storing predictions and those looking them up
+                rarely contend.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _PREDICTION_CACHE_HPP
+#define _PREDICTION_CACHE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "handoff_workflow.hpp"
+
+namespace ts {
+
+typedef struct prediction_cache_stats {
+    uint64_t lookups = 0;
+    uint64_t hits = 0;                  // fresh predictions found
+    uint64_t ues_saved = 0;             // UEs left out of prediction requests
+    uint64_t requests_saved = 0;        // prediction requests not sent at all
+    uint64_t evictions = 0;             // UEs evicted to make room
+    size_t size = 0;
+} prediction_cache_stats_t;
+
+class PredictionCache {
+    private:
+        using clock = std::chrono::steady_clock;
+
+        static const int SHARDS = 16;
+
+        struct entry {
+            ue_prediction_t prediction;
+            clock::time_point stored_at;
+        };
+
+        struct shard {
+            std::mutex mutex;
+            std::list<entry> lru;       // most recently used first
+            std::unordered_map<std::string, std::list<entry>::iterator> index;
+        };
+
+        shard shards[SHARDS];
+        size_t shard_capacity;
+        clock::duration ttl;
+
+        std::atomic<uint64_t> lookups { 0 };
+        std::atomic<uint64_t> hits { 0 };
+        std::atomic<uint64_t> ues_saved { 0 };
+        std::atomic<uint64_t> requests_saved { 0 };
+        std::atomic<uint64_t> evictions { 0 };
+
+        std::mutex log_mutex;
+        clock::time_point next_log;
+
+        shard &shard_of( const std::string &ue_id );
+        void count_saved( size_t ues, bool whole_request );
+        void maybe_log( clock::time_point now );
+
+    public:
+        PredictionCache( size_t capacity, std::chrono::milliseconds ttl );
+
+        void put( const ue_prediction_t &prediction );
+        // true, and a copy of the prediction, if the UE has one younger than the TTL
+        bool get( const std::string &ue_id, ue_prediction_t &prediction );
+        // forgets the prediction of a UE, e.g. once it is handed off to another cell
+        void invalidate( const std::string &ue_id );
+
+        /*
+            Moves the UEs of ue_ids that have a fresh prediction out of it,
+            keeping the order of the others, and appends their predictions
+            to known.
+        */
+        void take_fresh( std::vector<std::string> &ue_ids, std::vector<ue_prediction_t> &known );
+
+        prediction_cache_stats_t get_stats( );
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,156 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	priority_scheduler.cpp
+    Abstract:	Implements the message scheduler.
+
+    Date:       18 Oct 2026
+*/
+
+#include "priority_scheduler.hpp"
+
+#include <iostream>
+
+namespace ts {
+
+namespace {
+
+const char *CLASS_NAMES[] = { "control", "data" };
+
+} // namespace
+
+PriorityScheduler::PriorityScheduler( const sched_opts_t &opts ) : opts( opts ) {
+    dispatcher = std::thread( &PriorityScheduler::run, this );
+}
+
+PriorityScheduler::~PriorityScheduler() {
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        stopping = true;
+    }
+    cv.notify_one();
+    dispatcher.join();
+}
+
+bool PriorityScheduler::submit( MsgClass cls, sched_handler_t handler, const char *payload, int len ) {
+    int c = (int) cls;
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+
+        if( queues[c].size() >= opts.budget[c] ) {
+            stats[c].dropped++;
+            return false;
+        }
+
+        queues[c].push_back( { handler, std::string( payload, len ), clock::now() } );
+        if( queues[c].size() > stats[c].high_water ) {
+            stats[c].high_water = queues[c].size();
+        }
+    }
+    cv.notify_one();
+
+    return true;
+}
+
+// takes the oldest message of the highest priority class that has one
+void PriorityScheduler::run( ) {
+    auto next_log = clock::now() + opts.stats_interval;
+
+    while( true ) {
+        entry e;
+        {
+            std::unique_lock<std::mutex> lock( mutex );
+
+            auto ready = [this]( ) {
+                for( auto &q : queues ) {
+                    if( !q.empty() ) {
+                        return true;
+                    }
+                }
+                return false;
+            };
+            cv.wait_for( lock, std::chrono::seconds( 1 ), [&]{ return stopping || ready(); } );
+            if( stopping ) {
+                return;
+            }
+
+            for( int c = 0; c < MSG_CLASSES; c++ ) {
+                if( !queues[c].empty() ) {
+                    e = std::move( queues[c].front() );
+                    queues[c].pop_front();
+
+                    uint64_t waited = std::chrono::duration_cast<std::chrono::microseconds>( clock::now() - e.queued_at ).count();
+                    if( waited > stats[c].max_wait_us ) {
+                        stats[c].max_wait_us = waited;
+                    }
+                    stats[c].dispatched++;
+                    break;
+                }
+            }
+        }
+
+        if( e.handler != nullptr ) {
+            e.handler( e.payload.data(), e.payload.size() );
+        }
+
+        if( opts.stats_interval.count() > 0 && clock::now() >= next_log ) {
+            log_stats();
+            next_log = clock::now() + opts.stats_interval;
+        }
+    }
+}
+
+sched_class_stats_t PriorityScheduler::get_stats( MsgClass cls ) const {
+    std::lock_guard<std::mutex> lock( mutex );
+
+    sched_class_stats_t s = stats[(int) cls];
+    s.queued = queues[(int) cls].size();
+    return s;
+}
+
+double PriorityScheduler::backlog( MsgClass cls ) const {
+    std::lock_guard<std::mutex> lock( mutex );
+
+    size_t budget = opts.budget[(int) cls];
+    return budget > 0 ? (double) queues[(int) cls].size() / budget : 1.0;
+}
+
+void PriorityScheduler::log_stats( ) {
+    sched_class_stats_t s[MSG_CLASSES];
+    uint64_t dispatched = 0;
+
+    for( int c = 0; c < MSG_CLASSES; c++ ) {
+        s[c] = get_stats( (MsgClass) c );
+        dispatched += s[c].dispatched + s[c].dropped;
+    }
+    if( dispatched == last_logged ) {
+        return;     // nothing happened since the last time
+    }
+    last_logged = dispatched;
+
+    std::cout << "[INFO] Message scheduler:";
+    for( int c = 0; c < MSG_CLASSES; c++ ) {
+        std::cout << " " << CLASS_NAMES[c] << " " << s[c].queued << "/" << opts.budget[c] << " queued (max " << s[c].high_water
+                  << "), " << s[c].dispatched << " dispatched, " << s[c].dropped << " dropped, max wait " << s[c].max_wait_us << " us;";
+    }
+    std::cout << std::endl;
+}
+
+} // namespace
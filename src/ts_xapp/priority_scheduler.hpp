@@ -0,0 +1,106 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	priority_scheduler.hpp
+    Abstract:	Header for the message scheduler that sits in front of the
+                handlers. The messaging thread only copies each message to
+                the queue of its class and returns; a dispatcher thread
+                always empties the control class (A1 policies) before it
+                takes the next data message (anomalies and predictions).
+                A policy therefore waits for at most the data message being
+                handled, not for the whole backlog.
+
+                Each class has a budget: messages arriving while its queue
+                holds that many are dropped and counted, so a flood of one
+                class cannot grow the queues without bound.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _PRIORITY_SCHEDULER_HPP
+#define _PRIORITY_SCHEDULER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace ts {
+
+enum class MsgClass { CONTROL = 0, DATA = 1 };     // in priority order
+
+const int MSG_CLASSES = 2;
+
+typedef void (*sched_handler_t)( const char *payload, int len );
+
+typedef struct sched_opts {
+    size_t budget[MSG_CLASSES] = { 1024, 8192 };    // messages each class may queue
+    std::chrono::seconds stats_interval { 10 };     // 0 disables the periodic stats log
+} sched_opts_t;
+
+typedef struct sched_class_stats {
+    size_t queued = 0;
+    size_t high_water = 0;              // most messages ever queued
+    uint64_t dispatched = 0;
+    uint64_t dropped = 0;               // arrived over budget
+    uint64_t max_wait_us = 0;           // longest time a message waited in the queue
+} sched_class_stats_t;
+
+class PriorityScheduler {
+    private:
+        using clock = std::chrono::steady_clock;
+
+        struct entry {
+            sched_handler_t handler = nullptr;
+            std::string payload;
+            clock::time_point queued_at;
+        };
+
+        sched_opts_t opts;
+
+        mutable std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<entry> queues[MSG_CLASSES];
+        sched_class_stats_t stats[MSG_CLASSES];
+        bool stopping = false;
+        uint64_t last_logged = 0;           // messages dispatched at the last stats log
+        std::thread dispatcher;
+
+        void run( );
+        void log_stats( );
+
+    public:
+        explicit PriorityScheduler( const sched_opts_t &opts );
+        ~PriorityScheduler();
+
+        // queues a message for handler; false if the class is over budget and the message was dropped
+        bool submit( MsgClass cls, sched_handler_t handler, const char *payload, int len );
+
+        sched_class_stats_t get_stats( MsgClass cls ) const;
+        // occupancy of the queue of a class, from 0 (empty) to 1 (at its budget)
+        double backlog( MsgClass cls ) const;
+};
+
+} // namespace
+
+#endif
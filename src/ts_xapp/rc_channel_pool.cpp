@@ -0,0 +1,160 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	rc_channel_pool.cpp
+    Abstract:	Implements a pool of gRPC channels to the RC xApp. Each channel
+                holds its own HTTP/2 connection, so control requests are not
+                serialized behind a single connection. Channels are selected
+                either round-robin or by E2 node, and unhealthy channels are
+                skipped until they reconnect.
+
+    Date:       18 Oct 2026
+*/
+
+#include "rc_channel_pool.hpp"
+
+#include <iostream>
+#include <chrono>
+#include <functional>
+
+#include <grpcpp/create_channel.h>
+#include <grpcpp/security/credentials.h>
+#include <grpcpp/support/channel_arguments.h>
+
+namespace ts {
+
+/*
+    Creates opts.size channels to target. Each channel gets a distinct
+    argument set and a local subchannel pool; otherwise gRPC would share
+    one subchannel (i.e. one TCP connection) among all of them.
+*/
+RcChannelPool::RcChannelPool( const std::string &target, const rc_pool_opts_t &opts ) {
+    int size = opts.size;
+    if( size <= 0 ) {
+        size = std::thread::hardware_concurrency();
+        if( size <= 0 ) {
+            size = 1;
+        }
+    }
+
+    sharding = opts.sharding;
+    health_interval_ms = opts.health_interval_ms;
+
+    for( int i = 0; i < size; i++ ) {
+        grpc::ChannelArguments args;
+        args.SetInt( GRPC_ARG_KEEPALIVE_TIME_MS, opts.keepalive_time_ms );
+        args.SetInt( GRPC_ARG_KEEPALIVE_TIMEOUT_MS, opts.keepalive_timeout_ms );
+        args.SetInt( GRPC_ARG_KEEPALIVE_PERMIT_WITHOUT_CALLS, opts.keepalive_without_calls ? 1 : 0 );
+        args.SetInt( GRPC_ARG_HTTP2_MAX_PINGS_WITHOUT_DATA, 0 );
+        args.SetInt( GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1 );
+        args.SetInt( "ts.channel_index", i );
+
+        std::unique_ptr<slot> s( new slot() );
+        s->channel = grpc::CreateCustomChannel( target, grpc::InsecureChannelCredentials(), args );
+        s->stub = rc::MsgComm::NewStub( s->channel, grpc::StubOptions() );
+        slots.push_back( std::move( s ) );
+    }
+
+    std::cout << "[INFO] Created " << slots.size() << " gRPC channel(s) to " << target << std::endl;
+
+    if( health_interval_ms > 0 ) {
+        health_thread = std::thread( &RcChannelPool::health_loop, this );
+    }
+}
+
+RcChannelPool::~RcChannelPool( ) {
+    {
+        std::lock_guard<std::mutex> lock( health_mutex );
+        stopping = true;
+    }
+    health_cv.notify_all();
+
+    if( health_thread.joinable() ) {
+        health_thread.join();
+    }
+}
+
+size_t RcChannelPool::size( ) {
+    return slots.size();
+}
+
+/*
+    Refreshes the health flag of each channel based on its connectivity state.
+    Idle channels are asked to connect, so a channel that went down is brought
+    back before being selected again.
+*/
+void RcChannelPool::check_health( ) {
+    for( size_t i = 0; i < slots.size(); i++ ) {
+        grpc_connectivity_state state = slots[i]->channel->GetState( true );
+        bool healthy = ( state != GRPC_CHANNEL_TRANSIENT_FAILURE && state != GRPC_CHANNEL_SHUTDOWN );
+
+        if( slots[i]->healthy.exchange( healthy ) != healthy ) {
+            std::cout << "[INFO] gRPC channel " << i << " is now " << ( healthy ? "healthy" : "unhealthy" ) << std::endl;
+        }
+    }
+}
+
+void RcChannelPool::health_loop( ) {
+    std::unique_lock<std::mutex> lock( health_mutex );
+
+    while( !stopping ) {
+        lock.unlock();
+        check_health();
+        lock.lock();
+
+        health_cv.wait_for( lock, std::chrono::milliseconds( health_interval_ms ), [this]{ return stopping; } );
+    }
+}
+
+/*
+    Returns the first healthy slot starting at start, or start itself
+    when no channel is healthy (the request then fails on that channel).
+*/
+size_t RcChannelPool::first_healthy( size_t start ) {
+    size_t n = slots.size();
+
+    for( size_t i = 0; i < n; i++ ) {
+        size_t idx = ( start + i ) % n;
+        if( slots[idx]->healthy.load( std::memory_order_relaxed ) ) {
+            return idx;
+        }
+    }
+
+    return start;
+}
+
+/*
+    Returns the stub to send a control request for the given E2 node.
+    With E2NODE sharding all requests of a node go through the same channel
+    (keeping their order); otherwise channels are used round-robin.
+*/
+rc::MsgComm::Stub *RcChannelPool::get_stub( const std::string &e2node_id ) {
+    size_t start;
+
+    if( sharding == ChannelSharding::E2NODE && !e2node_id.empty() ) {
+        start = std::hash<std::string>()( e2node_id ) % slots.size();
+    } else {
+        start = next.fetch_add( 1, std::memory_order_relaxed ) % slots.size();
+    }
+
+    return slots[ first_healthy( start ) ]->stub.get();
+}
+
+} // namespace
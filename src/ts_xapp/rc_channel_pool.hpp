@@ -0,0 +1,89 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	rc_channel_pool.hpp
+    Abstract:	Header for the pool of gRPC channels (and stubs) used to send
+                control messages to the RC xApp.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _RC_CHANNEL_POOL_HPP
+#define _RC_CHANNEL_POOL_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <grpcpp/channel.h>
+#include "protobuf/rc.grpc.pb.h"
+
+namespace ts {
+
+// how a channel is selected from the pool for each control request
+enum class ChannelSharding { ROUND_ROBIN, E2NODE };
+
+typedef struct rc_pool_opts {
+    int size = 1;                   // number of channels; <= 0 means one per core
+    ChannelSharding sharding = ChannelSharding::ROUND_ROBIN;
+    // interval between HTTP/2 keepalive pings; gRPC servers refuse pings more often than every 5 min by default
+    int keepalive_time_ms = 300000;
+    int keepalive_timeout_ms = 5000;
+    bool keepalive_without_calls = false;  // ping idle channels too; the server must permit it
+    int health_interval_ms = 1000;  // 0 disables the health checker thread
+} rc_pool_opts_t;
+
+class RcChannelPool {
+    private:
+        struct slot {
+            std::shared_ptr<grpc::Channel> channel;
+            std::unique_ptr<rc::MsgComm::Stub> stub;
+            std::atomic<bool> healthy { true };
+        };
+
+        std::vector<std::unique_ptr<slot>> slots;
+        ChannelSharding sharding;
+        std::atomic<unsigned int> next { 0 };
+
+        int health_interval_ms;
+        bool stopping = false;
+        std::mutex health_mutex;
+        std::condition_variable health_cv;
+        std::thread health_thread;
+
+        void health_loop( );
+        size_t first_healthy( size_t start );
+
+    public:
+        RcChannelPool( const std::string &target, const rc_pool_opts_t &opts );
+        ~RcChannelPool();
+
+        size_t size( );
+        void check_health( );
+        rc::MsgComm::Stub *get_stub( const std::string &e2node_id );
+};
+
+} // namespace
+
+#endif
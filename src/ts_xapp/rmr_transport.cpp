@@ -0,0 +1,86 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	rmr_transport.cpp
+    Abstract:	Implements the messaging interface on top of RMR. Replies
+                return the received message to its sender, and each thread
+                reuses the same message buffer to send, as RMR hands a buffer
+                back after every send.
+
+    Date:       18 Oct 2026
+*/
+
+#include "rmr_transport.hpp"
+
+namespace ts {
+
+namespace {
+
+// replies through the message being handled
+class MessageReplier : public Replier {
+    private:
+        xapp::Message &mbuf;
+        const void *payload;        // payload of mbuf, no need to copy it when echoed back
+
+    public:
+        MessageReplier( xapp::Message &mbuf, const void *payload ) : mbuf( mbuf ), payload( payload ) { }
+
+        bool reply( int mtype, const void *data, int len ) override {
+            return mbuf.Send_response( mtype, xapp::Message::NO_SUBID, len,
+                                       data == payload ? nullptr : (unsigned char *) data );
+        }
+};
+
+} // namespace
+
+RmrTransport::RmrTransport( const char *port, bool wait_for_routes ) {
+    xfw = std::unique_ptr<xapp::Xapp>( new xapp::Xapp( port, wait_for_routes ) );
+}
+
+void RmrTransport::dispatch( xapp::Message &mbuf, int mtype, int subid, int len,
+                             xapp::Msg_component payload, void *data ) {
+    MessageReplier replier( mbuf, payload.get() );
+    ( *(msg_handler_t *) data )( mtype, (const char *) payload.get(), len, replier );
+}
+
+void RmrTransport::add_handler( int mtype, msg_handler_t handler ) {
+    handlers.push_back( handler );
+    xfw->Add_msg_cb( mtype, dispatch, &handlers.back() );
+}
+
+bool RmrTransport::send( int mtype, const void *payload, int len ) {
+    thread_local std::unique_ptr<xapp::Message> msg;
+
+    if( !msg || msg->Get_available_size() < len ) {
+        msg = xfw->Alloc_msg( len > 2048 ? len : 2048 );
+    }
+
+    return msg->Send_msg( mtype, xapp::Message::NO_SUBID, len, (unsigned char *) payload );
+}
+
+void RmrTransport::run( int nthreads ) {
+    xfw->Run( nthreads );
+}
+
+void RmrTransport::stop( ) {
+    xfw->Halt();
+}
+
+} // namespace
@@ -0,0 +1,59 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	rmr_transport.hpp
+    Abstract:	Header for the RMR implementation of the messaging interface,
+                built on the xApp framework.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _RMR_TRANSPORT_HPP
+#define _RMR_TRANSPORT_HPP
+
+#include <list>
+#include <memory>
+
+#include <ricxfcpp/xapp.hpp>
+
+#include "transport.hpp"
+
+namespace ts {
+
+class RmrTransport : public Transport {
+    private:
+        std::unique_ptr<xapp::Xapp> xfw;
+        std::list<msg_handler_t> handlers;      // callback data points to them, so they must not move
+
+        static void dispatch( xapp::Message &mbuf, int mtype, int subid, int len,
+                              xapp::Msg_component payload, void *data );
+
+    public:
+        RmrTransport( const char *port, bool wait_for_routes );
+
+        void add_handler( int mtype, msg_handler_t handler ) override;
+        bool send( int mtype, const void *payload, int len ) override;
+        void run( int nthreads ) override;
+        void stop( ) override;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,233 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	sdl_sync.cpp
+    Abstract:	Implements the SDL backed and in-memory key/value stores, and
+                the notification driven sync of a namespace.
+
+    Date:       18 Oct 2026
+*/
+
+#include "sdl_sync.hpp"
+
+#include <chrono>
+#include <iostream>
+
+namespace ts {
+
+namespace {
+
+// wait before fetching again keys the store failed to return
+const std::chrono::milliseconds SYNC_RETRY_BACKOFF( 100 );
+
+}
+
+// ---------------- SDL ---------------------------------------------------------
+
+SdlKvStore::SdlKvStore( std::unique_ptr<shareddatalayer::SyncStorage> sdl ) {
+    this->sdl = std::move( sdl );
+}
+
+sdl_keys_t SdlKvStore::find_keys( const std::string &ns, const std::string &prefix ) {
+    return sdl->findKeys( ns, prefix );
+}
+
+sdl_datamap_t SdlKvStore::get( const std::string &ns, const sdl_keys_t &keys ) {
+    return sdl->get( ns, keys );
+}
+
+void SdlKvStore::set( const std::string &ns, const sdl_datamap_t &data ) {
+    sdl->set( ns, data );
+}
+
+void SdlKvStore::remove( const std::string &ns, const sdl_keys_t &keys ) {
+    sdl->remove( ns, keys );
+}
+
+// ---------------- in-memory stand-in ------------------------------------------
+
+sdl_keys_t InMemorySdl::find_keys( const std::string &ns, const std::string &prefix ) {
+    sdl_keys_t keys;
+    std::lock_guard<std::mutex> lock( data_mutex );
+
+    sdl_datamap_t &data = namespaces[ns];
+    for( auto it = data.lower_bound( prefix ); it != data.end(); it++ ) {
+        if( it->first.compare( 0, prefix.size(), prefix ) != 0 ) {
+            break;
+        }
+        keys.insert( keys.end(), it->first );
+    }
+
+    return keys;
+}
+
+sdl_datamap_t InMemorySdl::get( const std::string &ns, const sdl_keys_t &keys ) {
+    sdl_datamap_t result;
+    std::lock_guard<std::mutex> lock( data_mutex );
+
+    sdl_datamap_t &data = namespaces[ns];
+    for( auto &k : keys ) {
+        auto it = data.find( k );
+        if( it != data.end() ) {
+            result.emplace_hint( result.end(), k, it->second );
+        }
+    }
+
+    return result;
+}
+
+void InMemorySdl::set( const std::string &ns, const sdl_datamap_t &data ) {
+    sdl_keys_t keys;
+    {
+        std::lock_guard<std::mutex> lock( data_mutex );
+
+        sdl_datamap_t &stored = namespaces[ns];
+        for( auto &kv : data ) {
+            stored[kv.first] = kv.second;
+            keys.insert( keys.end(), kv.first );
+        }
+    }
+
+    notify( ns, keys );
+}
+
+void InMemorySdl::remove( const std::string &ns, const sdl_keys_t &keys ) {
+    {
+        std::lock_guard<std::mutex> lock( data_mutex );
+
+        sdl_datamap_t &stored = namespaces[ns];
+        for( auto &k : keys ) {
+            stored.erase( k );
+        }
+    }
+
+    notify( ns, keys );
+}
+
+subscription_t InMemorySdl::subscribe( const std::string &ns, change_cb_t cb ) {
+    std::lock_guard<std::mutex> lock( subs_mutex );
+    subscribers.emplace( ns, std::make_pair( ++last_sub, cb ) );
+
+    return last_sub;
+}
+
+// notify holds the same lock while calling back, so no callback is running once this returns
+void InMemorySdl::unsubscribe( subscription_t sub ) {
+    std::lock_guard<std::mutex> lock( subs_mutex );
+
+    for( auto it = subscribers.begin(); it != subscribers.end(); it++ ) {
+        if( it->second.first == sub ) {
+            subscribers.erase( it );
+            return;
+        }
+    }
+}
+
+// subscribers are called without holding the data lock, so they may read the store
+void InMemorySdl::notify( const std::string &ns, const sdl_keys_t &keys ) {
+    std::lock_guard<std::mutex> lock( subs_mutex );
+
+    auto range = subscribers.equal_range( ns );
+    for( auto it = range.first; it != range.second; it++ ) {
+        it->second.second( ns, keys );
+    }
+}
+
+// ---------------- incremental sync --------------------------------------------
+
+SdlSync::SdlSync( KvStore &store, ChangeFeed &feed, const std::string &ns, apply_cb_t apply )
+    : store( store ), feed( feed ), ns( ns ), apply( apply ) {
+
+    sub = feed.subscribe( ns, [this]( const std::string &, const sdl_keys_t &keys ) { on_change( keys ); } );
+    worker = std::thread( &SdlSync::sync_loop, this );
+}
+
+SdlSync::~SdlSync( ) {
+    feed.unsubscribe( sub );        // before anything the callback touches goes away
+
+    {
+        std::lock_guard<std::mutex> lock( dirty_mutex );
+        stopping = true;
+    }
+    dirty_cv.notify_all();
+
+    if( worker.joinable() ) {
+        worker.join();
+    }
+}
+
+/*
+    Marks the whole namespace as dirty; used on startup and whenever
+    notifications might have been lost.
+*/
+void SdlSync::resync( ) {
+    on_change( store.find_keys( ns, "" ) );
+}
+
+void SdlSync::on_change( const sdl_keys_t &keys ) {
+    {
+        std::lock_guard<std::mutex> lock( dirty_mutex );
+        dirty.insert( keys.begin(), keys.end() );
+    }
+    dirty_cv.notify_one();
+}
+
+/*
+    Fetches the dirty keys in one get. Keys that the store no longer has
+    were removed; everything else changed. If the get fails, the keys are
+    put back in the dirty set and fetched again after a short backoff.
+*/
+void SdlSync::sync_loop( ) {
+    std::unique_lock<std::mutex> lock( dirty_mutex );
+
+    while( true ) {
+        dirty_cv.wait( lock, [this]{ return stopping || !dirty.empty(); } );
+        if( stopping ) {
+            return;
+        }
+
+        sdl_keys_t keys;
+        keys.swap( dirty );
+        lock.unlock();
+
+        try {
+            sdl_datamap_t changed = store.get( ns, keys );
+            sdl_keys_t removed;
+            for( auto &k : keys ) {
+                if( changed.count( k ) == 0 ) {
+                    removed.insert( removed.end(), k );
+                }
+            }
+            apply( changed, removed );
+
+        } catch( const std::exception &e ) {
+            std::cout << "[ERROR] Unable to sync " << keys.size() << " key(s) of SDL namespace " << ns << ": " << e.what() << std::endl;
+
+            lock.lock();
+            dirty.insert( keys.begin(), keys.end() );
+            dirty_cv.wait_for( lock, SYNC_RETRY_BACKOFF, [this]{ return stopping; } );
+            continue;
+        }
+
+        lock.lock();
+    }
+}
+
+} // namespace
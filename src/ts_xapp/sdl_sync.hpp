@@ -0,0 +1,152 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	sdl_sync.hpp
+    Abstract:	Header for the SDL access layer: a key/value store interface
+                (backed by SDL or by an in-memory stand-in), a feed of change
+                notifications, and the incremental sync that fetches only the
+                keys reported as changed.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _SDL_SYNC_HPP
+#define _SDL_SYNC_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sdl/syncstorage.hpp>
+
+namespace ts {
+
+// same types used by SDL
+typedef std::vector<uint8_t> sdl_data_t;
+typedef std::set<std::string> sdl_keys_t;
+typedef std::map<std::string, sdl_data_t> sdl_datamap_t;
+
+class KvStore {
+    public:
+        virtual ~KvStore() { }
+        virtual sdl_keys_t find_keys( const std::string &ns, const std::string &prefix ) = 0;
+        virtual sdl_datamap_t get( const std::string &ns, const sdl_keys_t &keys ) = 0;
+        virtual void set( const std::string &ns, const sdl_datamap_t &data ) = 0;
+        virtual void remove( const std::string &ns, const sdl_keys_t &keys ) = 0;
+};
+
+// receives the keys of a namespace that were set or removed
+typedef std::function<void( const std::string &ns, const sdl_keys_t &keys )> change_cb_t;
+
+typedef uint64_t subscription_t;
+
+/*
+    Once unsubscribe returns, the callback is not running and is never
+    called again, so its owner can go away. It must not be called from
+    within a callback.
+*/
+class ChangeFeed {
+    public:
+        virtual ~ChangeFeed() { }
+        virtual subscription_t subscribe( const std::string &ns, change_cb_t cb ) = 0;
+        virtual void unsubscribe( subscription_t sub ) = 0;
+};
+
+/*
+    KvStore on top of SDL. The SDL C++ API does not expose change
+    notifications, so this store has no ChangeFeed.
+*/
+class SdlKvStore : public KvStore {
+    private:
+        std::unique_ptr<shareddatalayer::SyncStorage> sdl;
+
+    public:
+        SdlKvStore( std::unique_ptr<shareddatalayer::SyncStorage> sdl );
+
+        sdl_keys_t find_keys( const std::string &ns, const std::string &prefix ) override;
+        sdl_datamap_t get( const std::string &ns, const sdl_keys_t &keys ) override;
+        void set( const std::string &ns, const sdl_datamap_t &data ) override;
+        void remove( const std::string &ns, const sdl_keys_t &keys ) override;
+};
+
+/*
+    In-process stand-in for SDL. Every set and remove notifies the
+    subscribers of the namespace with the keys involved.
+*/
+class InMemorySdl : public KvStore, public ChangeFeed {
+    private:
+        std::mutex data_mutex;
+        std::map<std::string, sdl_datamap_t> namespaces;
+        std::mutex subs_mutex;
+        std::multimap<std::string, std::pair<subscription_t, change_cb_t>> subscribers;
+        subscription_t last_sub = 0;
+
+        void notify( const std::string &ns, const sdl_keys_t &keys );
+
+    public:
+        sdl_keys_t find_keys( const std::string &ns, const std::string &prefix ) override;
+        sdl_datamap_t get( const std::string &ns, const sdl_keys_t &keys ) override;
+        void set( const std::string &ns, const sdl_datamap_t &data ) override;
+        void remove( const std::string &ns, const sdl_keys_t &keys ) override;
+        subscription_t subscribe( const std::string &ns, change_cb_t cb ) override;
+        void unsubscribe( subscription_t sub ) override;
+};
+
+// receives the values that changed and the keys that were removed
+typedef std::function<void( const sdl_datamap_t &changed, const sdl_keys_t &removed )> apply_cb_t;
+
+/*
+    Keeps a local copy of a namespace in sync. Notified keys are coalesced
+    into a dirty set, and a worker fetches only those keys from the store.
+*/
+class SdlSync {
+    private:
+        KvStore &store;
+        ChangeFeed &feed;
+        std::string ns;
+        apply_cb_t apply;
+        subscription_t sub;
+
+        std::mutex dirty_mutex;
+        std::condition_variable dirty_cv;
+        sdl_keys_t dirty;
+        bool stopping = false;
+        std::thread worker;
+
+        void on_change( const sdl_keys_t &keys );
+        void sync_loop( );
+
+    public:
+        SdlSync( KvStore &store, ChangeFeed &feed, const std::string &ns, apply_cb_t apply );
+        ~SdlSync();
+
+        void resync( );
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,90 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	snapshot_slot.hpp
+    Abstract:	Publication point of an immutable snapshot, read on the hot
+                path and replaced rarely. std::atomic_load on a shared_ptr
+                takes a lock from a global pool in libstdc++; here readers
+                never lock.
+
+                The slot holds two pointers and a reader count for each.
+                A reader announces itself on the current side, checks the
+                side did not change meanwhile, and copies the pointer (an
+                atomic reference count increment). A writer fills the side
+                readers left, waiting for the last stragglers of an older
+                publication to leave it, then flips the current side.
+                Readers only retry when a publication races with them.
+
+                Writers must be serialized by the caller.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _SNAPSHOT_SLOT_HPP
+#define _SNAPSHOT_SLOT_HPP
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace ts {
+
+template <typename T>
+class SnapshotSlot {
+    private:
+        std::shared_ptr<const T> sides[2];
+        mutable std::atomic<int> readers[2];
+        std::atomic<int> side { 0 };
+
+    public:
+        explicit SnapshotSlot( std::shared_ptr<const T> initial ) {
+            sides[0] = std::move( initial );
+            readers[0].store( 0 );
+            readers[1].store( 0 );
+        }
+
+        std::shared_ptr<const T> load( ) const {
+            for( ;; ) {
+                int s = side.load();
+                readers[s].fetch_add( 1 );
+                if( side.load() == s ) {
+                    std::shared_ptr<const T> snap = sides[s];
+                    readers[s].fetch_sub( 1 );
+                    return snap;
+                }
+                readers[s].fetch_sub( 1 );     // a publication flipped the side meanwhile
+            }
+        }
+
+        // serialized by the caller
+        void store( std::shared_ptr<const T> snap ) {
+            int next = 1 - side.load();
+            while( readers[next].load() != 0 ) {
+                std::this_thread::yield();      // readers of the publication before last, leaving soon
+            }
+
+            sides[next] = std::move( snap );
+            side.store( next );
+        }
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,105 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	spsc_ring.hpp
+    Abstract:	Bounded single-producer single-consumer ring. Items are
+                moved in and out of preallocated slots; the producer and the
+                consumer each own one index and keep a cached copy of the
+                other one, so they only touch each other's cache line when
+                the ring looks full or empty.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _SPSC_RING_HPP
+#define _SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace ts {
+
+template <typename T>
+class SpscRing {
+    private:
+        std::unique_ptr<T[]> slots;
+        size_t mask;
+
+        alignas( 64 ) std::atomic<size_t> head { 0 };     // next position to pop, written by the consumer
+        size_t cached_tail = 0;                           // consumer's copy of tail
+        alignas( 64 ) std::atomic<size_t> tail { 0 };     // next position to push, written by the producer
+        size_t cached_head = 0;                           // producer's copy of head
+
+    public:
+        // the capacity is rounded up to a power of two
+        explicit SpscRing( size_t capacity ) {
+            size_t size = 2;
+            while( size < capacity ) {
+                size <<= 1;
+            }
+            slots = std::unique_ptr<T[]>( new T[size] );
+            mask = size - 1;
+        }
+
+        // producer only; false, and item untouched, if the ring is full
+        bool push( T &&item ) {
+            size_t t = tail.load( std::memory_order_relaxed );
+
+            if( t - cached_head > mask ) {
+                cached_head = head.load( std::memory_order_acquire );
+                if( t - cached_head > mask ) {
+                    return false;
+                }
+            }
+
+            slots[t & mask] = std::move( item );
+            tail.store( t + 1, std::memory_order_release );
+            return true;
+        }
+
+        // consumer only; false if the ring is empty
+        bool pop( T &item ) {
+            size_t h = head.load( std::memory_order_relaxed );
+
+            if( h == cached_tail ) {
+                cached_tail = tail.load( std::memory_order_acquire );
+                if( h == cached_tail ) {
+                    return false;
+                }
+            }
+
+            item = std::move( slots[h & mask] );
+            head.store( h + 1, std::memory_order_release );
+            return true;
+        }
+
+        // occupancy, exact from either end and approximate from any other thread
+        size_t size( ) const {
+            size_t h = head.load( std::memory_order_acquire );     // first, so that tail >= h
+            return tail.load( std::memory_order_acquire ) - h;
+        }
+
+        size_t capacity( ) const { return mask + 1; }
+};
+
+} // namespace
+
+#endif
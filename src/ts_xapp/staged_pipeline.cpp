@@ -0,0 +1,205 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	staged_pipeline.cpp
+    Abstract:	Implements the staged message pipeline.
+
+    Date:       18 Oct 2026
+*/
+
+#include "staged_pipeline.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <iostream>
+
+#include <rmr/RIC_message_types.h>
+
+namespace ts {
+
+namespace {
+
+const char *STAGE_NAMES[] = { "decode", "decide", "egress" };
+
+void pin_thread( std::thread &t, const char *name, int cpu ) {
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    CPU_SET( cpu, &set );
+
+    int rc = pthread_setaffinity_np( t.native_handle(), sizeof( set ), &set );
+    if( rc != 0 ) {
+        std::cout << "[ERROR] Unable to pin the " << name << " stage to CPU " << cpu << ", error " << rc << std::endl;
+    }
+}
+
+} // namespace
+
+StagedPipeline::StagedPipeline( const staged_opts_t &opts, const staged_hooks_t &hooks ) :
+    opts( opts ), hooks( hooks ), to_decode( opts.capacity ), to_decide( opts.capacity ), to_egress( opts.capacity ) {
+
+    threads.emplace_back( [this]{
+        stage_loop( to_decode, counters[0], [this]( inbound &msg ) { decode( msg ); } );
+    } );
+    threads.emplace_back( [this]{
+        stage_loop( to_decide, counters[1], [this]( work &item ) { decide( item ); } );
+    } );
+    threads.emplace_back( [this]{
+        stage_loop( to_egress, counters[2], [this]( work &item ) { egress( item ); } );
+    } );
+
+    for( size_t i = 0; i < threads.size() && !opts.cpus.empty(); i++ ) {
+        pin_thread( threads[i], STAGE_NAMES[i], opts.cpus[i % opts.cpus.size()] );
+    }
+}
+
+StagedPipeline::~StagedPipeline() {
+    stopping.store( true );
+    for( auto &t : threads ) {
+        t.join();
+    }
+}
+
+// waits for room in the ring of the next stage
+template <typename T>
+void StagedPipeline::push( SpscRing<T> &ring, stage_counters &next, T &&item ) {
+    if( !ring.push( std::move( item ) ) ) {
+        next.stalls.fetch_add( 1, std::memory_order_relaxed );
+        while( !ring.push( std::move( item ) ) ) {
+            if( stopping.load( std::memory_order_relaxed ) ) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    size_t queued = ring.size();
+    if( queued > next.high_water.load( std::memory_order_relaxed ) ) {     // only the producer writes it
+        next.high_water.store( queued, std::memory_order_relaxed );
+    }
+}
+
+template <typename T, typename F>
+void StagedPipeline::stage_loop( SpscRing<T> &ring, stage_counters &self, F process ) {
+    T item;
+    int idle = 0;
+    bool reporter = &self == &counters[0];
+    auto next_log = std::chrono::steady_clock::now() + opts.stats_interval;
+
+    while( !stopping.load( std::memory_order_relaxed ) ) {
+        if( ring.pop( item ) ) {
+            process( item );
+            uint64_t n = self.processed.fetch_add( 1, std::memory_order_relaxed );
+            idle = 0;
+            if( ( n & 1023 ) != 0 ) {
+                continue;       // under load, the clock is only read every 1024 messages
+            }
+        } else if( ++idle < 1000 ) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for( std::chrono::microseconds( 50 ) );
+        }
+
+        if( reporter && opts.stats_interval.count() > 0 && std::chrono::steady_clock::now() >= next_log ) {
+            log_stats();
+            next_log = std::chrono::steady_clock::now() + opts.stats_interval;
+        }
+    }
+}
+
+void StagedPipeline::submit( int mtype, const char *payload, int len ) {
+    inbound msg;
+    msg.mtype = mtype;
+    msg.payload.assign( payload, len );
+
+    push( to_decode, counters[0], std::move( msg ) );
+}
+
+void StagedPipeline::decode( inbound &msg ) {
+    work item;
+    item.mtype = msg.mtype;
+
+    if( msg.mtype == TS_QOE_PREDICTION ) {
+        if( hooks.decode_prediction( msg.payload.data(), msg.payload.size(), item.prediction ) ) {
+            push( to_decide, counters[1], std::move( item ) );
+        }
+        return;
+    }
+
+    std::vector<ue_prediction_t> known;
+    if( !hooks.decode_anomaly( msg.payload.data(), msg.payload.size(), item.ues, known ) ) {
+        return;
+    }
+
+    // known predictions go to the decision as if QP had just sent them
+    for( ue_prediction_t &prediction : known ) {
+        work predicted;
+        predicted.mtype = TS_QOE_PREDICTION;
+        predicted.prediction = std::move( prediction );
+        push( to_decide, counters[1], std::move( predicted ) );
+    }
+    if( !item.ues.empty() ) {
+        push( to_decide, counters[1], std::move( item ) );
+    }
+}
+
+// anomalies go through untouched, so that egress keeps the order of the messages
+void StagedPipeline::decide( work &item ) {
+    if( item.mtype == TS_QOE_PREDICTION && !hooks.choose_target( item.prediction, item.target_cell_id ) ) {
+        return;
+    }
+
+    push( to_egress, counters[2], std::move( item ) );
+}
+
+void StagedPipeline::egress( work &item ) {
+    if( item.mtype == TS_QOE_PREDICTION ) {
+        hooks.send_control( item.prediction.ue_id, item.prediction.serving_cell_id, item.target_cell_id );
+    } else {
+        hooks.request_predictions( item.ues );
+    }
+}
+
+std::vector<stage_stats_t> StagedPipeline::get_stats( ) const {
+    std::vector<stage_stats_t> stats( 3 );
+    size_t queued[] = { to_decode.size(), to_decide.size(), to_egress.size() };
+
+    for( int i = 0; i < 3; i++ ) {
+        stats[i].name = STAGE_NAMES[i];
+        stats[i].queued = queued[i];
+        stats[i].capacity = to_decode.capacity();
+        stats[i].high_water = counters[i].high_water.load( std::memory_order_relaxed );
+        stats[i].processed = counters[i].processed.load( std::memory_order_relaxed );
+        stats[i].stalls = counters[i].stalls.load( std::memory_order_relaxed );
+    }
+
+    return stats;
+}
+
+void StagedPipeline::log_stats( ) {
+    std::cout << "[INFO] Pipeline stages:";
+    for( const stage_stats_t &s : get_stats() ) {
+        std::cout << " " << s.name << " " << s.queued << "/" << s.capacity << " queued (max " << s.high_water << "), "
+                  << s.processed << " processed, " << s.stalls << " stall(s);";
+    }
+    std::cout << std::endl;
+}
+
+} // namespace
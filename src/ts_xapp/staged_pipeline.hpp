@@ -0,0 +1,139 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	staged_pipeline.hpp
+    Abstract:	Header for the staged message pipeline. Anomalies and
+                predictions go through three stages, each one on its own
+                thread, optionally pinned to a CPU:
+
+                    decode  parses the JSON payload
+                    decide  picks the handoff target of a prediction
+                    egress  sends prediction and control requests
+
+                Stages are linked by bounded SPSC rings. Each ring has one
+                producer: the messaging thread feeds decode, so messages
+                must be submitted from a single thread. When a ring is full
+                its producer waits, which pushes back up to RMR.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _STAGED_PIPELINE_HPP
+#define _STAGED_PIPELINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "handoff_workflow.hpp"
+#include "spsc_ring.hpp"
+
+namespace ts {
+
+typedef struct staged_opts {
+    size_t capacity = 4096;             // messages each ring holds
+    std::vector<int> cpus;              // CPU of each stage, in stage order; empty leaves them unpinned
+    std::chrono::seconds stats_interval { 10 };         // 0 disables the periodic stats log
+} staged_opts_t;
+
+typedef struct staged_hooks {
+    // decode stage
+    std::function<bool( const char *payload, int len, ue_prediction_t & )> decode_prediction;
+    // UEs to request predictions for, and UEs whose prediction is already known
+    std::function<bool( const char *payload, int len, std::vector<std::string> &,
+                        std::vector<ue_prediction_t> & )> decode_anomaly;
+    // decide stage
+    std::function<bool( const ue_prediction_t &, std::string & )> choose_target;
+    // egress stage
+    std::function<void( const std::vector<std::string> & )> request_predictions;
+    std::function<bool( const std::string &ue_id, const std::string &serving_cell_id,
+                        const std::string &target_cell_id )> send_control;
+} staged_hooks_t;
+
+typedef struct stage_stats {
+    const char *name;
+    size_t queued = 0;                  // messages in the ring in front of the stage
+    size_t capacity = 0;
+    size_t high_water = 0;              // most messages ever queued
+    uint64_t processed = 0;
+    uint64_t stalls = 0;                // times the producer found the ring full and had to wait
+} stage_stats_t;
+
+class StagedPipeline {
+    private:
+        struct inbound {
+            int mtype = 0;
+            std::string payload;
+        };
+
+        struct work {
+            int mtype = 0;
+            ue_prediction_t prediction;
+            std::vector<std::string> ues;
+            std::string target_cell_id;     // empty if the UE stays in its cell
+        };
+
+        struct stage_counters {
+            std::atomic<size_t> high_water { 0 };
+            std::atomic<uint64_t> processed { 0 };
+            std::atomic<uint64_t> stalls { 0 };
+        };
+
+        staged_opts_t opts;
+        staged_hooks_t hooks;
+
+        SpscRing<inbound> to_decode;
+        SpscRing<work> to_decide;
+        SpscRing<work> to_egress;
+        stage_counters counters[3];
+
+        std::atomic<bool> stopping { false };
+        std::vector<std::thread> threads;
+
+        template <typename T>
+        void push( SpscRing<T> &ring, stage_counters &next, T &&item );
+        template <typename T, typename F>
+        void stage_loop( SpscRing<T> &ring, stage_counters &self, F process );
+
+        void decode( inbound &msg );
+        void decide( work &item );
+        void egress( work &item );
+        void log_stats( );
+
+    public:
+        StagedPipeline( const staged_opts_t &opts, const staged_hooks_t &hooks );
+        ~StagedPipeline();
+
+        // queues an anomaly or prediction message; single producer, waits if the decode ring is full
+        void submit( int mtype, const char *payload, int len );
+
+        // one entry per stage, in stage order
+        std::vector<stage_stats_t> get_stats( ) const;
+        // occupancy of the decode ring, from 0 (empty) to 1 (full)
+        double backlog( ) const { return (double) to_decode.size() / to_decode.capacity(); }
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,68 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	transport.hpp
+    Abstract:	Messaging interface used by the TS xApp. Messages are routed
+                by type, as RMR does, and a handler can reply to the sender
+                of the message it handles. RmrTransport (rmr_transport.hpp)
+                sends through RMR, LoopbackTransport (loopback_transport.hpp)
+                delivers to other endpoints in the same process.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _TRANSPORT_HPP
+#define _TRANSPORT_HPP
+
+#include <functional>
+
+namespace ts {
+
+// sends a message back to the sender of the message being handled
+class Replier {
+    public:
+        virtual ~Replier() { }
+        virtual bool reply( int mtype, const void *payload, int len ) = 0;
+};
+
+/*
+    The payload is only valid until the handler returns, and replying might
+    reuse its buffer, so it must be copied first if it is needed afterwards.
+*/
+typedef std::function<void( int mtype, const char *payload, int len, Replier &replier )> msg_handler_t;
+
+class Transport {
+    public:
+        virtual ~Transport() { }
+
+        // handlers must be added before run is called
+        virtual void add_handler( int mtype, msg_handler_t handler ) = 0;
+
+        // sends to the endpoint the message type is routed to; false if it could not be sent
+        virtual bool send( int mtype, const void *payload, int len ) = 0;
+
+        // handles inbound messages on nthreads threads, returns after stop
+        virtual void run( int nthreads ) = 0;
+        virtual void stop( ) = 0;
+};
+
+} // namespace
+
+#endif
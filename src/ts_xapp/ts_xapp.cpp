@@ -48,6 +48,8 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <atomic>
 #include<deque>
 #include <rapidjson/document.h>
 #include <rapidjson/writer.h>
@@ -76,6 +78,25 @@
 #include "protobuf/rc.grpc.pb.h"
 
 #include "utils/restclient.hpp"
+#include "rc_channel_pool.hpp"
+#include "cell_index.hpp"
+#include "policy_store.hpp"
+#include "a1_responder.hpp"
+#include "message_handlers.hpp"
+#include "metrics_cache.hpp"
+#include "handoff_decision.hpp"
+#include "capture_log.hpp"
+#include "rmr_transport.hpp"
+#include "loopback_transport.hpp"
+#include "loopback_sim.hpp"
+#include "handoff_workflow.hpp"
+#include "staged_pipeline.hpp"
+#include "priority_scheduler.hpp"
+#include "load_shedder.hpp"
+#include "prediction_cache.hpp"
+#include "neighbor_table.hpp"
+#include "handoff_budget.hpp"
+#include "batch_assign.hpp"
 
 
 using namespace rapidjson;
@@ -90,453 +111,146 @@ using Keys = std::set<Key>;
 
 
 // ----------------------------------------------------------
-std::unique_ptr<Xapp> xfw;
-std::unique_ptr<rc::MsgComm::Stub> rc_stub;
+std::unique_ptr<ts::Transport> transport;  // RMR, or loopback endpoints; nil while replaying a capture
+std::unique_ptr<ts::RcChannelPool> rc_pool;
 
-int downlink_threshold = 0;  // A1 policy type 20008 (in percentage)
+ts::CellIndex cell_index;      // dense index of the cells seen in policies and predictions
+ts::PolicyStore policy_store( cell_index );   // A1 policy instances, including type 20008 (threshold in percentage)
+std::unique_ptr<ts::A1Responder> a1_responder;  // sends A1 policy statuses in batches
+std::unique_ptr<ts::MetricsCache> metrics_cache;  // UE and cell metrics from SDL, nil if disabled
+std::unique_ptr<ts::NeighborTable> neighbor_table;  // candidate target cells of each serving cell, nil if disabled
+std::unique_ptr<ts::HandoffBudget> handoff_budget;  // caps the handoffs into each cell per interval, nil if disabled
+std::unique_ptr<ts::BatchAssigner> batch_assigner;  // assigns the UEs of a window to cells jointly, nil if disabled
 
 // scoped enum to identify which API is used to send control messages
 enum class TsControlApi { REST, gRPC };
 TsControlApi ts_control_api;  // api to send control messages
 string ts_control_ep;         // api target endpoint
 
-typedef struct nodeb {
-  string ran_name;
-  struct {
-    string plmn_id;
-    string nb_id;
-  } global_nb_id;
-} nodeb_t;
-
 unordered_map<string, shared_ptr<nodeb_t>> cell_map; // maps each cell to its nodeb
 
-/* struct UEData {
-  string serving_cell;
-  int serving_cell_rsrp;
-}; */
-
-
-//https://stackoverflow.com/a/34571089/15098882
-
-static std::string base64_decode(const std::string &in) {
-
-	std::string out;
-
-	std::vector<int> T(256, -1);
-	for (int i = 0; i < 64; i++) T["ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"[i]] = i;
-
-	int val = 0, valb = -8;
-	for (unsigned char c : in) {
-		if (T[c] == -1) break;
-		val = (val << 6) + T[c];
-		valb += 6;
-		if (valb >= 0) {
-			out.push_back(char((val >> valb) & 0xFF));
-			valb -= 8;
-		}
-	}
-	return out;
-}
-
-struct PolicyHandler : public BaseReaderHandler<UTF8<>, PolicyHandler> {
-  /*
-    Assuming we receive the following payload from A1 Mediator
-    {"operation": "CREATE", "policy_type_id": 20008, "policy_instance_id": "tsapolicy145", "payload": {"threshold": 5}}
-  */
-  unordered_map<string, string> cell_pred;
-  std::string ue_id;
-  bool ue_id_found = false;
-  string curr_key = "";
-  string curr_value = "";
-  int policy_type_id;
-  int policy_instance_id;
-  int threshold;
-  std::string operation;
-  bool found_threshold = false;
-
-  bool Null() { return true; }
-  bool Bool(bool b) { return true; }
-  bool Int(int i) {
-
-    if (curr_key.compare("policy_type_id") == 0) {
-      policy_type_id = i;
-    } else if (curr_key.compare("policy_instance_id") == 0) {
-      policy_instance_id = i;
-    } else if (curr_key.compare("threshold") == 0) {
-      found_threshold = true;
-      threshold = i;
-    }
-
-    return true;
-  }
-  bool Uint(unsigned u) {
-
-    if (curr_key.compare("policy_type_id") == 0) {
-      policy_type_id = u;
-    } else if (curr_key.compare("policy_instance_id") == 0) {
-      policy_instance_id = u;
-    } else if (curr_key.compare("threshold") == 0) {
-      found_threshold = true;
-      threshold = u;
-    }
-
-    return true;
-  }
-  bool Int64(int64_t i) {  return true; }
-  bool Uint64(uint64_t u) {  return true; }
-  bool Double(double d) {  return true; }
-  bool String(const char* str, SizeType length, bool copy) {
-
-    if (curr_key.compare("operation") != 0) {
-      operation = str;
-    }
+std::unique_ptr<ts::CaptureWriter> capture;  // inbound messages are appended to it, nil if disabled
+bool dry_run = false;                 // replay and loopback runs: handoffs are counted, no control request is sent
+std::atomic<unsigned long> dry_run_handoffs { 0 };  // handoffs decided in a dry run
 
-    return true;
-  }
-  bool StartObject() {
+std::unique_ptr<ts::PriorityScheduler> scheduler;  // A1 policies are handled before anomalies and predictions, nil if disabled
+std::unique_ptr<ts::StagedPipeline> staged;  // decodes, decides and sends on a thread per stage, nil if inline
+std::unique_ptr<ts::PredictionCache> prediction_cache;  // last prediction of each UE, nil if disabled
+std::unique_ptr<ts::LoadShedder> shedder;  // drops stale anomalies and sheds them under backlog, nil if disabled
 
-    return true;
-  }
-  bool Key(const char* str, SizeType length, bool copy) {
+#ifdef TS_HANDOFF_WORKFLOWS
+std::unique_ptr<ts::HandoffEngine> handoff_engine;  // runs a workflow per anomalous UE, nil if disabled
+#endif
 
-    curr_key = str;
 
-    return true;
-  }
-  bool EndObject(SizeType memberCount) {  return true; }
-  bool StartArray() {  return true; }
-  bool EndArray(SizeType elementCount) {  return true; }
-
-};
-
-struct PredictionHandler : public BaseReaderHandler<UTF8<>, PredictionHandler> {
-  unordered_map<string, int> cell_pred_down;
-  unordered_map<string, int> cell_pred_up;
-  std::string ue_id;
-  bool ue_id_found = false;
-  string curr_key = "";
-  string curr_value = "";
-  string serving_cell_id;
-  bool down_val = true;
-  bool Null() {  return true; }
-  bool Bool(bool b) {  return true; }
-  bool Int(int i) {  return true; }
-  bool Uint(unsigned u) {
-    // Currently, we assume the first cell in the prediction message is the serving cell
-    if ( serving_cell_id.empty() ) {
-      serving_cell_id = curr_key;
-    }
+void handle_policy( const char *payload, int len ) {
+  string arg ( payload, len ); // RMR payload might not have a nil terminanted char
 
-    if (down_val) {
-      cell_pred_down[curr_key] = u;
-      down_val = false;
-    } else {
-      cell_pred_up[curr_key] = u;
-      down_val = true;
-    }
+  cout << "[INFO] Payload is " << arg << endl;
 
-    return true;
+  PolicyHandler handler;
+  Reader reader;
+  StringStream ss(arg.c_str());
+  reader.Parse(ss,handler);
 
+  ts::PolicyOp op = ts::to_policy_op( handler.operation );
+  if ( op != ts::PolicyOp::DELETE && !handler.found_threshold ) {
+    cout << "[ERROR] A1 policy instance \"" << handler.policy_instance_id << "\" has no threshold\n";
+    a1_responder->enqueue( handler.policy_type_id, handler.policy_instance_id, ts::A1_STATUS_ERROR );
+    return;
   }
-  bool Int64(int64_t i) {  return true; }
-  bool Uint64(uint64_t u) {  return true; }
-  bool Double(double d) {  return true; }
-  bool String(const char* str, SizeType length, bool copy) {
 
-    return true;
+  // cells are not mapped to the slices they serve, a slice scope could not be enforced
+  if ( op != ts::PolicyOp::DELETE && !handler.slice_id.empty() ) {
+    cout << "[ERROR] A1 policy instance \"" << handler.policy_instance_id << "\" is scoped to slice \""
+         << handler.slice_id << "\", slice scopes are not supported\n";
+    a1_responder->enqueue( handler.policy_type_id, handler.policy_instance_id, ts::A1_STATUS_ERROR );
+    return;
   }
-  bool StartObject() {  return true; }
-  bool Key(const char* str, SizeType length, bool copy) {
-    if (!ue_id_found) {
 
-      ue_id = str;
-      ue_id_found = true;
-    } else {
-      curr_key = str;
-    }
-    return true;
-  }
-  bool EndObject(SizeType memberCount) {  return true; }
-  bool StartArray() {  return true; }
-  bool EndArray(SizeType elementCount) {  return true; }
-};
-
-struct AnomalyHandler : public BaseReaderHandler<UTF8<>, AnomalyHandler> {
-  /*
-    Assuming we receive the following payload from AD
-    [{"du-id": 1010, "ue-id": "Train passenger 2", "measTimeStampRf": 1620835470108, "Degradation": "RSRP RSSINR"}]
-  */
-  vector<string> prediction_ues;
-  string curr_key = "";
-
-  bool Key(const Ch* str, SizeType len, bool copy) {
-    curr_key = str;
-    return true;
+  ts::policy_t policy;
+  policy.type_id = handler.policy_type_id;
+  policy.instance_id = handler.policy_instance_id;
+  policy.threshold = handler.threshold;
+  policy.cells = handler.cells;
+  if ( handler.cells.size() == 1 ) {
+    policy.scope = ts::PolicyScope::CELL;
+  } else if ( handler.cells.size() > 1 ) {
+    policy.scope = ts::PolicyScope::CELL_GROUP;
   }
 
-  bool String(const Ch* str, SizeType len, bool copy) {
-    // We are only interested in the "ue-id"
-    if ( curr_key.compare( "ue-id") == 0 ) {
-      prediction_ues.push_back( str );
-    }
-    return true;
+  string error;
+  if ( !policy_store.apply( op, policy, error ) ) {
+    cout << "[ERROR] Unable to apply " << handler.operation << " on A1 policy instance \""
+         << handler.policy_instance_id << "\": " << error << endl;
+    a1_responder->enqueue( handler.policy_type_id, handler.policy_instance_id, ts::A1_STATUS_ERROR );
+    return;
   }
-};
 
-struct NodebListHandler : public BaseReaderHandler<UTF8<>, NodebListHandler> {
-  vector<string> nodeb_list;
-  string curr_key = "";
+  a1_responder->enqueue( handler.policy_type_id, handler.policy_instance_id,
+                         op == ts::PolicyOp::DELETE ? ts::A1_STATUS_DELETED : ts::A1_STATUS_OK );
 
-  bool Key(const Ch* str, SizeType length, bool copy) {
-    curr_key = str;
-    return true;
-  }
+  auto policies = policy_store.snapshot();
+  cout << "[INFO] Applied " << handler.operation << " on A1 policy instance \"" << handler.policy_instance_id
+       << "\", default threshold is now " << policies->downlink_threshold << "%, "
+       << policies->scoped_cells << " cell(s) have a scoped threshold\n";
 
-  bool String(const Ch* str, SizeType length, bool copy) {
-    if( curr_key.compare( "inventoryName" ) == 0 ) {
-      nodeb_list.push_back( str );
-    }
-    return true;
-  }
-};
-
-struct NodebHandler : public BaseReaderHandler<UTF8<>, NodebHandler> {
-	string curr_key = "";
-	shared_ptr<nodeb_t> nodeb = make_shared<nodeb_t>();
-	std::string meid;
-	std::vector<string> cells;
-
-	bool Key(const Ch* str, SizeType length, bool copy) {
-		curr_key = str;
-		return true;
-	}
-
-	bool String(const Ch* str, SizeType length, bool copy) {
-
-		if (curr_key.compare("ranName") == 0) {
-			//std::cout << str << "\n";
-			nodeb->ran_name = str;
-			meid= str;
-			//std::cout << "\n meid = " << meid;
-
-		}
-		else if (curr_key.compare("plmnId") == 0) {
-			//std::cout << str << "\n";
-			nodeb->global_nb_id.plmn_id = str;
-		}
-		else if (curr_key.compare("nbId") == 0) {
-			//std::cout <<str<< "\n";
-			nodeb->global_nb_id.nb_id = str;
-		}
-		else if (curr_key.compare("e2nodeComponentRequestPart") == 0) {
-			//std::cout << str<<"\n";
-			auto message = base64_decode(str);
-			//std::cout << message<<"\n";
-			int len = meid.length();
-			//std::cout << "\n meid = " << meid;
-			int counter = 0;
-				for (int i = 0; i <len; i++ ){
-					if (meid[i] == '_') {
-						counter++;
-					}
-					if( counter == 3) {
-						counter = i + 1;
-						break;
-					}
-				}
-				std::string last_matching_bits = meid.substr(counter, meid.length());
-				len = last_matching_bits.size();
-				char b;
-
-				for (int i = 0; i < len; i++) {
-					b = last_matching_bits[i];
-					b = toupper(b);
-					// b = to lower(b); //alternately
-					last_matching_bits[i] = b;
-				}
-				len = message.length();
-				//std::cout << "\nlast_matching_bits = " << last_matching_bits;
-				int matching_len = last_matching_bits.length();;
-
-					for (int i = 0; i <= len - matching_len; i++ ){
-						//std::cout << "\n" << message.substr(i, matching_len);
-
-						if (message.substr(i,matching_len)== last_matching_bits){
-							//std::cout << "\nmatched!\n";
-							cells.push_back(message.substr(i,10));//cell id is 36 bit long , last  4 bit unused
-
-						}
-					}
-					len = cells.size();
-					for (int i = 0; i < len; i++) {
-						cell_map[cells[i]] = nodeb;
-					}
-
-		}
-		return true;
-	}
-
-};
-
-/* struct UEDataHandler : public BaseReaderHandler<UTF8<>, UEDataHandler> {
-  unordered_map<string, string> cell_pred;
-  std::string serving_cell_id;
-  int serving_cell_rsrp;
-  int serving_cell_rsrq;
-  int serving_cell_sinr;
-  bool in_serving_array = false;
-  int rf_meas_index = 0;
-
-  bool in_serving_report_object = false;
-
-  string curr_key = "";
-  string curr_value = "";
-  bool Null() { return true; }
-  bool Bool(bool b) { return true; }
-  bool Int(int i) {
+}
 
-    return true;
+void policy_callback( int mtype, const char *payload, int len, ts::Replier &replier ) {
+  if ( capture ) {
+    capture->append( mtype, payload, len );
   }
 
-  bool Uint(unsigned i) {
-
-    if (in_serving_report_object) {
-      if (curr_key.compare("rsrp") == 0) {
-	serving_cell_rsrp = i;
-      } else if (curr_key.compare("rsrq") == 0) {
-	serving_cell_rsrq = i;
-      } else if (curr_key.compare("rssinr") == 0) {
-	serving_cell_sinr = i;
-      }
-    }
-
-    return true; }
-  bool Int64(int64_t i) {
-
-    return true; }
-  bool Uint64(uint64_t i) {
-
-    return true; }
-  bool Double(double d) { return true; }
-  bool String(const char* str, SizeType length, bool copy) {
-
-    if (curr_key.compare("ServingCellID") == 0) {
-      serving_cell_id = str;
-    }
+  cout << "[INFO] Policy Callback got a message, type=" << mtype << ", length=" << len << "\n";
 
-    return true;
-  }
-  bool StartObject() {
-    if (curr_key.compare("ServingCellRF") == 0) {
-      in_serving_report_object = true;
+  if ( scheduler ) {
+    if ( !scheduler->submit( ts::MsgClass::CONTROL, handle_policy, payload, len ) ) {
+      cout << "[ERROR] Too many A1 policy messages queued, dropping one\n";
     }
-
-    return true; }
-  bool Key(const char* str, SizeType length, bool copy) {
-
-    curr_key = str;
-    return true;
+  } else {
+    handle_policy( payload, len );
   }
-  bool EndObject(SizeType memberCount) {
-    if (curr_key.compare("ServingCellRF") == 0) {
-      in_serving_report_object = false;
-    }
-    return true; }
-  bool StartArray() {
-
-    if (curr_key.compare("ServingCellRF") == 0) {
-      in_serving_array = true;
-    }
+}
 
-    return true;
+// sends a batch of A1 policy statuses to the A1 Mediator
+void send_policy_responses( const vector<string> &responses ) {
+  if ( !transport ) {   // replaying a capture
+    return;
   }
-  bool EndArray(SizeType elementCount) {
 
-    if (curr_key.compare("servingCellRF") == 0) {
-      in_serving_array = false;
-      rf_meas_index = 0;
+  for( const string &resp : responses ) {
+    if ( ! transport->send( A1_POLICY_RESP, resp.c_str(), resp.size() ) ) { // msg type 20011
+      cout << "[ERROR] Unable to send A1 policy response " << resp << endl;
     }
-
-    return true; }
-}; */
-
-
-/* unordered_map<string, UEData> get_sdl_ue_data() {
-
-  fprintf(stderr, "In get_sdl_ue_data()\n");
-
-  unordered_map<string, string> ue_data;
-
-  unordered_map<string, UEData> return_ue_data_map;
-
-  std::string prefix3="";
-  Keys K2 = sdl->findKeys(nsu, prefix3);
-  DataMap Dk2 = sdl->get(nsu, K2);
-
-  string ue_json;
-  string ue_id;
-
-  for(auto si=K2.begin();si!=K2.end();++si){
-    std::vector<uint8_t> val_v = Dk2[(*si)]; // 4 lines to unpack a string
-    char val[val_v.size()+1];                               // from Data
-    int i;
-
-    for(i=0;i<val_v.size();++i) val[i] = (char)(val_v[i]);
-    val[i]='\0';
-      ue_id.assign((std::string)*si);
-
-      ue_json.assign(val);
-      ue_data[ue_id] =  ue_json;
-  }
-
-  for (auto map_iter = ue_data.begin(); map_iter != ue_data.end(); map_iter++) {
-    UEDataHandler handler;
-    Reader reader;
-    StringStream ss(map_iter->second.c_str());
-    reader.Parse(ss,handler);
-
-    string ueID = map_iter->first;
-    string serving_cell_id = handler.serving_cell_id;
-    int serv_rsrp = handler.serving_cell_rsrp;
-
-    return_ue_data_map[ueID] = {serving_cell_id, serv_rsrp};
-
   }
 
-  return return_ue_data_map;
-} */
-
-void policy_callback( Message& mbuf, int mtype, int subid, int len, Msg_component payload,  void* data ) {
-  string arg ((const char*)payload.get(), len); // RMR payload might not have a nil terminanted char
-
-  cout << "[INFO] Policy Callback got a message, type=" << mtype << ", length=" << len << "\n";
-  cout << "[INFO] Payload is " << arg << endl;
+  cout << "[INFO] Sent " << responses.size() << " A1 policy response(s)\n";
+}
 
-  PolicyHandler handler;
-  Reader reader;
-  StringStream ss(arg.c_str());
-  reader.Parse(ss,handler);
+// asks the A1 Mediator to send all instances of our policy type again (e.g. after a restart)
+void send_policy_query( ) {
+  string query = ts::A1Responder::build_query( ts::TS_POLICY_TYPE );
 
-  //Set the threshold value
-  if (handler.found_threshold) {
-    cout << "[INFO] Setting Threshold for A1-P value: " << handler.threshold << "%\n";
-    downlink_threshold = handler.threshold;
+  cout << "[INFO] Sending A1 policy query " << query << endl;
+  if ( ! transport->send( A1_POLICY_QUERY, query.c_str(), query.size() ) ) { // msg type 20012
+    cout << "[ERROR] Unable to send A1 policy query\n";
   }
-
 }
 
-// sends a handover message through REST
-void send_rest_control_request( string ue_id, string serving_cell_id, string target_cell_id ) {
+// sends a handover message through REST, returns true if it was accepted
+bool send_rest_control_request( string ue_id, string serving_cell_id, string target_cell_id ) {
   time_t now;
-  string str_now;
-  static unsigned int seq_number = 0; // static counter, not thread-safe
+  char str_now[32];
+  static std::atomic<unsigned int> seq_number { 0 }; // control requests may be sent by several workflow threads
+  bool accepted = false;
 
   // building a handoff control message
   now = time( nullptr );
-  str_now = ctime( &now );
-  str_now.pop_back(); // removing the \n character
+  ctime_r( &now, str_now );
+  str_now[ strcspn( str_now, "\n" ) ] = 0; // removing the \n character
 
-  seq_number++;       // static counter, not thread-safe
+  unsigned int seq = ++seq_number;
 
   rapidjson::StringBuffer s;
   rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(s);
@@ -544,7 +258,7 @@ void send_rest_control_request( string ue_id, string serving_cell_id, string tar
   writer.Key( "command" );
   writer.String( "HandOff" );
   writer.Key( "seqNo" );
-  writer.Int( seq_number );
+  writer.Int( seq );
   writer.Key( "ue" );
   writer.String( ue_id.c_str() );
   writer.Key( "fromCell" );
@@ -552,7 +266,7 @@ void send_rest_control_request( string ue_id, string serving_cell_id, string tar
   writer.Key( "toCell" );
   writer.String( target_cell_id.c_str() );
   writer.Key( "timestamp" );
-  writer.String( str_now.c_str() );
+  writer.String( str_now );
   writer.Key( "reason" );
   writer.String( "HandOff Control Request from TS xApp" );
   writer.Key( "ttl" );
@@ -589,6 +303,7 @@ void send_rest_control_request( string ue_id, string serving_cell_id, string tar
         rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(s);
         document.Accept( writer );
         cout << "[INFO] HandOff reply is " << s.GetString() << endl;
+        accepted = true;
 
     } else {
         cout << "[ERROR] Unexpected HTTP code " << resp.status_code << " from " << \
@@ -601,10 +316,11 @@ void send_rest_control_request( string ue_id, string serving_cell_id, string tar
 
   }
 
+  return accepted;
 }
 
-// sends a handover message to RC xApp through gRPC
-void send_grpc_control_request( string ue_id, string target_cell_id ) {
+// sends a handover message to RC xApp through gRPC, returns true if it succeeded
+bool send_grpc_control_request( string ue_id, string target_cell_id ) {
   grpc::ClientContext context;
 
   rc::RicControlGrpcRsp response;
@@ -644,7 +360,7 @@ void send_grpc_control_request( string ue_id, string target_cell_id ) {
     gumi->set_plmnidentity(data->second->global_nb_id.plmn_id);
   } else {
     cout << "[INFO] Cannot find RAN name corresponding to cell id = "<<target_cell_id<<endl;
-    return;
+    return false;
     request->set_e2nodeid( "unknown_e2nodeid" );
     request->set_plmnid( "unknown_plmnid" );
     request->set_ranname( "unknown_ranname" );
@@ -653,11 +369,14 @@ void send_grpc_control_request( string ue_id, string target_cell_id ) {
   request->set_riccontrolackreqval( rc::RICControlAckEnum::RIC_CONTROL_ACK_UNKWON );
   //request->set_riccontrolackreqval( api::RIC_CONTROL_ACK_UNKWON);  // not yet used in api.proto
  cout<<"\nin ts xapp grpc message content \n"<< request->DebugString()<<"\n"; 
+  // requests of the same E2 node share a channel when the pool is sharded by E2 node
+  rc::MsgComm::Stub *rc_stub = rc_pool->get_stub( data->second->global_nb_id.nb_id );
   grpc::Status status = rc_stub->SendRICControlReqServiceGrpc( &context, *request, &response );
 
   if( status.ok() ) {
     if( response.rspcode() == 0 ) {
       cout << "[INFO] Control Request succeeded with code=0, description=" << response.description() << endl;
+      return true;
     } else {
       cout << "[ERROR] Control Request failed with code=" << response.rspcode()
            << ", description=" << response.description() << endl;
@@ -668,12 +387,146 @@ void send_grpc_control_request( string ue_id, string target_cell_id ) {
          << status.error_code() << ", error_msg=" << status.error_message() << endl;
   }
 
+  return false;
 }
 
-void prediction_callback( Message& mbuf, int mtype, int subid, int len, Msg_component payload,  void* data ) {
-  string json ((char *)payload.get(), len); // RMR payload might not have a nil terminanted char
+// sends the control request of a handoff with the configured api; in a dry run, only counts it
+bool send_control_request( const string &ue_id, const string &serving_cell_id, const string &target_cell_id ) {
+  if ( prediction_cache ) {
+    prediction_cache->invalidate( ue_id );  // it was predicted in the cell the UE is leaving
+  }
+
+  if ( dry_run ) {
+    dry_run_handoffs++;
+    return true;
+  }
+
+  if ( ts_control_api == TsControlApi::REST ) {
+    return send_rest_control_request( ue_id, serving_cell_id, target_cell_id );
+  } else {
+    return send_grpc_control_request( ue_id, target_cell_id );
+  }
+}
+
+// true if SDL reports no available DL PRBs in the cell; cells that do not report them are never full
+bool cell_is_full( const string &cell_id ) {
+  if ( !metrics_cache ) {
+    return false;
+  }
+
+  ts::cell_metrics_t cell;  // local copy of SDL data, no round trip to SDL
+  return metrics_cache->get_cell( cell_id, cell ) && cell.has_avail_prb_dl && cell.avail_prb_dl <= 0;
+}
+
+// the predictions of the serving cell and its neighbors; all of them without a neighbor table or neighbors reported by UEs
+const unordered_map<string, int> &neighbor_cells( const ts::ue_prediction_t &prediction, unordered_map<string, int> &candidates ) {
+  if ( neighbor_table ) {
+    auto neighbors = neighbor_table->snapshot();
+    const unordered_set<string> *cells = neighbors->neighbors_of( prediction.serving_cell_id );
+    if ( cells != nullptr ) {   // the serving cell has known neighbors
+      size_t outside = 0;
+      for ( const auto &cell : prediction.downlink ) {
+        if ( cell.first != prediction.serving_cell_id && cells->count( cell.first ) == 0 ) {
+          outside++;
+        }
+      }
+
+      if ( outside > 0 ) {
+        for ( const auto &cell : prediction.downlink ) {
+          if ( cell.first == prediction.serving_cell_id || cells->count( cell.first ) > 0 ) {
+            candidates.insert( cell );
+          }
+        }
+        neighbor_table->count_pruned( outside );
+        return candidates;
+      }
+    }
+  }
+
+  return prediction.downlink;
+}
+
+// threshold of the policies of the serving cell; the cell was resolved to its index when the prediction was decoded
+int serving_threshold( const ts::ue_prediction_t &prediction ) {
+  int cell = prediction.serving_cell >= 0 ? prediction.serving_cell : cell_index.find( prediction.serving_cell_id );
+
+  // the snapshot is immutable and loading it is lock-free
+  return policy_store.snapshot()->threshold_for( cell );
+}
+
+/*
+  Decision about CONTROL message
+  (1) Identify UE Id in Prediction message
+  (2) Iterate through Prediction message.
+      If one of the cells has a higher throughput prediction than serving cell, send a CONTROL request
+      We assume the first cell in the prediction message is the serving cell
+      We are only considering download throughput
+  With a neighbor table, cells that are not neighbors of the serving cell are left out first.
+  With a handoff budget, a target cell over its budget is passed over for the next best one.
+  Returns true, and the cell to hand the UE off to, if a CONTROL request should be sent.
+*/
+bool choose_target( const ts::ue_prediction_t &prediction, string &target_cell_id ) {
+  int downlink_threshold = serving_threshold( prediction );
+
+  unordered_map<string, int> candidates;
+  const unordered_map<string, int> *downlink = &neighbor_cells( prediction, candidates );
+
+  ts::handoff_decision_t decision;
+  if ( !ts::decide_handoff( *downlink, prediction.serving_cell_id, downlink_threshold, decision ) ) {
+    cout << "[ERROR] Prediction for UE " << prediction.ue_id << " has no serving cell throughput\n";
+    return false;
+  }
+
+  if ( !decision.handoff ) {
+    cout << "[INFO] The current serving cell \"" << prediction.serving_cell_id << "\" is the best one" << endl;
+    return false;
+  }
+
+  if ( !handoff_budget ) {
+    if ( cell_is_full( decision.highest_cell_id ) ) {
+      cout << "[INFO] Target cell \"" << decision.highest_cell_id << "\" has no available DL PRBs, skipping handoff of UE "
+           << prediction.ue_id << endl;
+      return false;
+    }
+
+    target_cell_id = decision.highest_cell_id;
+    return true;
+  }
+
+  vector<pair<string, int>> targets;
+  ts::rank_targets( *downlink, decision, targets );
+  for ( size_t i = 0; i < targets.size(); i++ ) {
+    if ( cell_is_full( targets[i].first ) || !handoff_budget->admit( targets[i].first ) ) {
+      continue;
+    }
+
+    if ( i > 0 ) {
+      handoff_budget->count_fallback();
+      cout << "[INFO] Target cell \"" << targets[0].first << "\" is over its handoff budget or has no available DL PRBs, "
+           << "handing UE " << prediction.ue_id << " off to \"" << targets[i].first << "\" instead" << endl;
+    }
+    target_cell_id = targets[i].first;
+    return true;
+  }
+
+  cout << "[INFO] No target cell of UE " << prediction.ue_id << " has handoff budget and available DL PRBs left, skipping handoff\n";
+  return false;
+}
+
+// sends the control request of a handoff assigned by a batch, unless the target cell is over its handoff budget
+bool send_batch_handoff( const string &ue_id, const string &serving_cell_id, const string &target_cell_id ) {
+  if ( handoff_budget && !handoff_budget->admit( target_cell_id ) ) {
+    cout << "[INFO] Target cell \"" << target_cell_id << "\" is over its handoff budget, skipping handoff of UE " << ue_id << endl;
+    return false;
+  }
+
+  return send_control_request( ue_id, serving_cell_id, target_cell_id );
+}
+
+// parses a prediction sent by the QP Driver xApp
+bool decode_prediction( const char *payload, int len, ts::ue_prediction_t &prediction ) {
+  string json ( payload, len ); // RMR payload might not have a nil terminanted char
 
-  cout << "[INFO] Prediction Callback got a message, type=" << mtype << ", length=" << len << "\n";
   cout << "[INFO] Payload is " << json << endl;
 
   PredictionHandler handler;
@@ -685,73 +538,117 @@ void prediction_callback( Message& mbuf, int mtype, int subid, int len, Msg_comp
     cout << "[ERROR] Got an exception on stringstream read parse\n";
   }
 
-  // We are only considering download throughput
-  unordered_map<string, int> throughput_map = handler.cell_pred_down;
+  prediction.ue_id = handler.ue_id;
+  prediction.serving_cell_id = handler.serving_cell_id;
+  prediction.serving_cell = prediction.serving_cell_id.empty() ? ts::NO_CELL : cell_index.intern( prediction.serving_cell_id );
+  prediction.downlink = std::move( handler.cell_pred_down );
 
-  // Decision about CONTROL message
-  // (1) Identify UE Id in Prediction message
-  // (2) Iterate through Prediction message.
-  //     If one of the cells has a higher throughput prediction than serving cell, send a CONTROL request
-  //     We assume the first cell in the prediction message is the serving cell
+  if ( prediction_cache && !prediction.ue_id.empty() && !prediction.downlink.empty() ) {
+    prediction_cache->put( prediction );
+  }
 
-  int serving_cell_throughput = 0;
-  int highest_throughput = 0;
-  string highest_throughput_cell_id;
+  return true;
+}
 
-  // Getting the current serving cell throughput prediction
-  auto cell = throughput_map.find( handler.serving_cell_id );
-  serving_cell_throughput = cell->second;
+/*
+  Decides whether the UE of a prediction should be handed off, and sends the control request if so.
+  In batch mode, a UE that qualifies for a handoff waits for the next batch to be assigned its target.
+*/
+void act_on_prediction( const ts::ue_prediction_t &prediction ) {
+  if ( batch_assigner ) {
+    unordered_map<string, int> candidates;
+    const unordered_map<string, int> &downlink = neighbor_cells( prediction, candidates );
+    int downlink_threshold = serving_threshold( prediction );
+
+    ts::handoff_decision_t decision;
+    if ( ts::decide_handoff( downlink, prediction.serving_cell_id, downlink_threshold, decision ) && decision.handoff ) {
+      batch_assigner->add( prediction.ue_id, prediction.serving_cell_id, decision.serving_throughput, decision.handoff_above, downlink );
+    }
+    return;
+  }
 
-   // Iterating to identify the highest throughput prediction
-  for (auto map_iter = throughput_map.begin(); map_iter != throughput_map.end(); map_iter++) {
+  string target_cell_id;
+  if ( choose_target( prediction, target_cell_id ) ) {
+    send_control_request( prediction.ue_id, prediction.serving_cell_id, target_cell_id );
+  }
+}
 
-    string curr_cellid = map_iter->first;
-    int curr_throughput = map_iter->second;
+void handle_prediction( const char *payload, int len ) {
+  ts::ue_prediction_t prediction;
+  decode_prediction( payload, len, prediction );
 
-    if ( highest_throughput < curr_throughput ) {
-      highest_throughput = curr_throughput;
-      highest_throughput_cell_id = curr_cellid;
-    }
+#ifdef TS_HANDOFF_WORKFLOWS
+  if ( handoff_engine ) {   // the workflow of the UE decides and sends the control request
+    handoff_engine->on_prediction( std::move( prediction ) );
+    return;
+  }
+#endif
 
+  act_on_prediction( prediction );
+}
+
+// hands a prediction to the staged pipeline, or handles it right away
+void dispatch_prediction( const char *payload, int len ) {
+  if ( staged ) {
+    staged->submit( TS_QOE_PREDICTION, payload, len );
+  } else {
+    handle_prediction( payload, len );
   }
+}
 
-  float thresh = 0;
-  if( downlink_threshold > 0 ) {  // we also take into account the threshold in A1 policy type 20008
-    thresh = serving_cell_throughput * (downlink_threshold / 100.0);
+void prediction_callback( int mtype, const char *payload, int len, ts::Replier &replier ) {
+  if ( capture ) {
+    capture->append( mtype, payload, len );
   }
 
-  if ( highest_throughput > ( serving_cell_throughput + thresh ) ) {
+  cout << "[INFO] Prediction Callback got a message, type=" << mtype << ", length=" << len << "\n";
 
-    // sending a control request message
-    if ( ts_control_api == TsControlApi::REST ) {
-      send_rest_control_request( handler.ue_id, handler.serving_cell_id, highest_throughput_cell_id );
-    } else {
-      send_grpc_control_request( handler.ue_id, highest_throughput_cell_id );
+  if ( scheduler ) {
+    if ( !scheduler->submit( ts::MsgClass::DATA, dispatch_prediction, payload, len ) ) {
+      cout << "[ERROR] Too many data messages queued, dropping a prediction message\n";
     }
-
   } else {
-    cout << "[INFO] The current serving cell \"" << handler.serving_cell_id << "\" is the best one" << endl;
+    dispatch_prediction( payload, len );
   }
-
 }
 
-void send_prediction_request( vector<string> ues_to_predict ) {
-  std::unique_ptr<Message> msg;
-  Msg_component payload;           // special type of unique pointer to the payload
-
-  int sz;
-  int i;
-  size_t plen;
-  Msg_component send_payload;
+/*
+  Builds the candidate cells of each UE whose serving cell is known, e.g.
+  {"ue": ["serving cell", "neighbor cell", ...], ...}. Returns an empty string if no UE has candidates.
+*/
+string build_candidate_cells( const vector<string> &ues ) {
+  auto neighbors = neighbor_table->snapshot();
+  string hints;
+  size_t hinted = 0;
+
+  for ( const string &ue_id : ues ) {
+    ts::ue_metrics_t ue;
+    if ( !metrics_cache->get_ue( ue_id, ue ) ) {
+      continue;
+    }
+    const unordered_set<string> *cells = neighbors->neighbors_of( ue.serving_cell_id );
+    if ( cells == nullptr ) {
+      continue;
+    }
 
-  msg = xfw->Alloc_msg( 2048 );
+    hints += ( hinted == 0 ? "{" : ", " );
+    hints += "\"" + ue_id + "\": [\"" + ue.serving_cell_id + "\"";
+    for ( const string &cell : *cells ) {
+      hints += ", \"" + cell + "\"";
+    }
+    hints += "]";
+    hinted++;
+  }
 
-  sz = msg->Get_available_size();  // we'll reuse a message if we received one back; ensure it's big enough
-  if( sz < 2048 ) {
-    fprintf( stderr, "[ERROR] message returned did not have enough size: %d [%d]\n", sz, i );
-    exit( 1 );
+  if ( hinted > 0 ) {
+    hints += "}";
+    neighbor_table->count_hinted( hinted );
   }
 
+  return hints;
+}
+
+void send_prediction_request( vector<string> ues_to_predict ) {
   string ues_list = "[";
 
   for (int i = 0; i < ues_to_predict.size(); i++) {
@@ -762,30 +659,48 @@ void send_prediction_request( vector<string> ues_to_predict ) {
     }
   }
 
-  string message_body = "{\"UEPredictionSet\": " + ues_list + "}";
+  string message_body = "{\"UEPredictionSet\": " + ues_list;
+  if ( neighbor_table && metrics_cache ) {  // lets QP predict only the cells a UE can be handed off to
+    string candidates = build_candidate_cells( ues_to_predict );
+    if ( !candidates.empty() ) {
+      message_body += ", \"CandidateCells\": " + candidates;
+    }
+  }
+  message_body += "}";
+
+  if ( !transport ) {   // replaying a capture
+    return;
+  }
+
+  cout << "[INFO] Prediction Request length=" << message_body.size() << ", payload=" << message_body << endl;
 
-  send_payload = msg->Get_payload(); // direct access to payload
-  snprintf( (char *) send_payload.get(), 2048, "%s", message_body.c_str() );
+  if ( ! transport->send( TS_UE_LIST, message_body.c_str(), message_body.size() ) ) { // msg type 30000
+    fprintf( stderr, "[ERROR] unable to send prediction request\n" );
+  }
 
-  plen = strlen( (char *)send_payload.get() );
+}
 
-  cout << "[INFO] Prediction Request length=" << plen << ", payload=" << send_payload.get() << endl;
+// occupancy of the queue anomalies wait in, from 0 (empty) to 1 (full); 0 when they are handled on arrival
+double data_backlog( ) {
+  double backlog = 0;
 
-  // payload updated in place, nothing to copy from, so payload parm is nil
-  if ( ! msg->Send_msg( TS_UE_LIST, Message::NO_SUBID, plen, NULL )) { // msg type 30000
-    fprintf( stderr, "[ERROR] send failed: %d\n", msg->Get_state() );
+  if ( scheduler ) {
+    backlog = scheduler->backlog( ts::MsgClass::DATA );
+  }
+  if ( staged ) {
+    backlog = max( backlog, staged->backlog() );
   }
 
+  return backlog;
 }
 
-/* This function works with Anomaly Detection(AD) xApp. It is invoked when anomalous UEs are send by AD xApp.
- * It parses the payload received from AD xApp, sends an ACK with same UEID as payload to AD xApp, and
- * sends a prediction request to the QP Driver xApp.
- */
-void ad_callback( Message& mbuf, int mtype, int subid, int len, Msg_component payload, void* data ) {
-  string json ((char *)payload.get(), len); // RMR payload might not have a nil terminanted char
+/*
+  Parses the anomalous UEs sent by AD xApp, leaving out those the load shedder drops.
+  UEs with a fresh cached prediction go to known, the others to ues.
+*/
+bool decode_anomaly( const char *payload, int len, vector<string> &ues, vector<ts::ue_prediction_t> &known ) {
+  string json ( payload, len ); // RMR payload might not have a nil terminanted char
 
-  cout << "[INFO] AD Callback got a message, type=" << mtype << ", length=" << len << "\n";
   cout << "[INFO] Payload is " << json << "\n";
 
   AnomalyHandler handler;
@@ -793,10 +708,89 @@ void ad_callback( Message& mbuf, int mtype, int subid, int len, Msg_component pa
   StringStream ss(json.c_str());
   reader.Parse(ss,handler);
 
-  // just sending ACK to the AD xApp
-  mbuf.Send_response( TS_ANOMALY_ACK, Message::NO_SUBID, len, nullptr );  // msg type 30004
+  if ( !shedder ) {
+    ues = std::move( handler.prediction_ues );
+  } else {
+    long long now_ms = chrono::duration_cast<chrono::milliseconds>( chrono::system_clock::now().time_since_epoch() ).count();
+    double backlog = data_backlog();
+    for ( const anomaly_t &anomaly : handler.anomalies ) {
+      if ( shedder->admit( anomaly.meas_ts_ms, now_ms, backlog ) ) {
+        ues.push_back( anomaly.ue_id );
+      }
+    }
+  }
+
+  if ( prediction_cache && !ues.empty() ) {   // no QP round trip for UEs predicted within the TTL
+    prediction_cache->take_fresh( ues, known );
+  }
+
+  return true;
+}
+
+// parses the anomalous UEs sent by AD xApp and sends a prediction request to the QP Driver xApp
+void handle_anomaly( const char *payload, int len ) {
+  vector<string> ues;
+  vector<ts::ue_prediction_t> known;
+  decode_anomaly( payload, len, ues, known );
+
+#ifdef TS_HANDOFF_WORKFLOWS
+  if ( handoff_engine ) {   // requests the predictions of the UEs without a running workflow
+    for ( ts::ue_prediction_t &prediction : known ) {
+      handoff_engine->start_predicted( std::move( prediction ) );
+    }
+    if ( !ues.empty() ) {
+      handoff_engine->start( ues );
+    }
+    return;
+  }
+#endif
+
+  for ( const ts::ue_prediction_t &prediction : known ) {
+    act_on_prediction( prediction );
+  }
+  if ( !ues.empty() ) {
+    send_prediction_request( ues );
+  }
+}
+
+// hands anomalies to the staged pipeline, or handles them right away
+void dispatch_anomaly( const char *payload, int len ) {
+  if ( staged ) {
+    staged->submit( TS_ANOMALY_UPDATE, payload, len );
+  } else {
+    handle_anomaly( payload, len );
+  }
+}
+
+/* This function works with Anomaly Detection(AD) xApp. It is invoked when anomalous UEs are send by AD xApp.
+ * It sends an ACK with same UEID as payload to AD xApp, and handles the anomalous UEs.
+ * Anomalies dropped because too many data messages are queued are not acknowledged.
+ */
+void ad_callback( int mtype, const char *payload, int len, ts::Replier &replier ) {
+  if ( capture ) {
+    capture->append( mtype, payload, len );
+  }
+
+  cout << "[INFO] AD Callback got a message, type=" << mtype << ", length=" << len << "\n";
+
+  if ( scheduler ) {
+    // the scheduler keeps its own copy of the payload
+    if ( !scheduler->submit( ts::MsgClass::DATA, dispatch_anomaly, payload, len ) ) {
+      cout << "[ERROR] Too many data messages queued, dropping an anomaly message\n";
+      return;
+    }
+
+    replier.reply( TS_ANOMALY_ACK, payload, len );  // msg type 30004
 
-  send_prediction_request(handler.prediction_ues);
+  } else {
+    // the payload must be copied first, sending the ACK might reuse the message buffer
+    string json ( payload, len );
+
+    // just sending ACK to the AD xApp
+    replier.reply( TS_ANOMALY_ACK, payload, len );  // msg type 30004
+
+    dispatch_anomaly( json.c_str(), len );
+  }
 }
 
 vector<string> get_nodeb_list( restclient::RestClient& client ) {
@@ -856,6 +850,13 @@ bool build_cell_mapping() {
         Reader reader;
         StringStream ss( response.body.c_str() );
         reader.Parse( ss, handler );
+
+        for( const string &cell : handler.cells ) {
+          cell_map[cell] = handler.nodeb;
+        }
+        if( neighbor_table ) {
+          neighbor_table->add_e2_node( handler.cells );
+        }
       } catch (...) {
         cout << "[ERROR] Got an exception on parsing nodeb (stringstream read parse)\n";
         return false;
@@ -870,10 +871,183 @@ bool build_cell_mapping() {
   return true;
 }
 
+// splits a comma separated list of SDL key prefixes; defaults to one prefix per alphanumeric character
+vector<string> get_sdl_prefixes( string list ) {
+  vector<string> prefixes;
+  stringstream ss( list );
+  string prefix;
+
+  while ( getline( ss, prefix, ',' ) ) {
+    if ( !prefix.empty() ) {
+      prefixes.push_back( prefix );
+    }
+  }
+
+  if ( prefixes.empty() ) {
+    for ( const char *c = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"; *c; c++ ) {
+      prefixes.push_back( string( 1, *c ) );
+    }
+  }
+
+  return prefixes;
+}
+
+// splits a comma separated list of CPU numbers
+vector<int> get_cpu_list( string list ) {
+  vector<int> cpus;
+  stringstream ss( list );
+  string cpu;
+
+  while ( getline( ss, cpu, ',' ) ) {
+    if ( !cpu.empty() ) {
+      cpus.push_back( atoi( cpu.c_str() ) );
+    }
+  }
+
+  return cpus;
+}
+
+// prints the percentiles of the time spent on each message type during a replay
+void print_replay_stats( ts::replay_stats_t &stats, double speed ) {
+  if ( stats.messages == 0 ) {
+    cout << "[INFO] The capture has no messages\n";
+    return;
+  }
+
+  cout << "[INFO] Replayed " << stats.messages << " messages in " << stats.elapsed_s << " s ("
+       << (unsigned long) ( stats.messages / stats.elapsed_s ) << " msgs/s), speed "
+       << ( speed > 0 ? to_string( speed ) + "x" : string( "max" ) ) << ", max lag " << stats.max_lag_ms
+       << " ms, " << dry_run_handoffs << " handoff(s) decided\n";
+
+  for ( auto &type : stats.latency_ns ) {
+    vector<uint32_t> &lat = type.second;
+    sort( lat.begin(), lat.end() );
+    auto pct = [&lat]( double p ) { return lat[ (size_t) ( p * ( lat.size() - 1 ) ) ] / 1000.0; };
+
+    cout << "[INFO] msg type " << type.first << ": " << lat.size() << " messages, latency us p50 " << pct( 0.5 )
+         << ", p90 " << pct( 0.9 ) << ", p99 " << pct( 0.99 ) << ", max " << pct( 1.0 ) << endl;
+  }
+}
+
+// feeds a capture to the message handlers, without RMR; nothing is sent out of the xApp
+int replay_capture( const string &path, double speed ) {
+  ts::CaptureReader reader;
+  string error;
+
+  if ( !reader.open( path, error ) ) {
+    cout << "[ERROR] " << error << endl;
+    return 1;
+  }
+
+  a1_responder = std::unique_ptr<ts::A1Responder>(
+      new ts::A1Responder( "trafficxapp", std::chrono::milliseconds( 5 ), send_policy_responses ) );
+
+  ts::replay_stats_t stats = ts::replay( reader, speed, []( const ts::capture_record_t &record ) {
+    switch ( record.mtype ) {
+      case A1_POLICY_REQ:
+        handle_policy( record.payload, record.len );
+        break;
+      case TS_QOE_PREDICTION:
+        handle_prediction( record.payload, record.len );
+        break;
+      case TS_ANOMALY_UPDATE:
+        handle_anomaly( record.payload, record.len );
+        break;
+      default:
+        cout << "[ERROR] Unexpected message type " << record.mtype << " in capture\n";
+    }
+  } );
+
+  print_replay_stats( stats, speed );
+
+  return 0;
+}
+
+void add_handlers( ts::Transport &t ) {
+  t.add_handler( A1_POLICY_REQ, policy_callback );          // msg type 20010
+  t.add_handler( TS_QOE_PREDICTION, prediction_callback );  // msg type 30002
+  t.add_handler( TS_ANOMALY_UPDATE, ad_callback );          // msg type 30003
+}
+
+// runs the AD -> TS -> QP -> TS pipeline in this process, over loopback endpoints; handoffs are only counted
+int run_loopback( ts::pipeline_opts_t opts ) {
+  ts::LoopbackBus bus;
+
+  if ( staged || scheduler ) {
+    opts.threaded = true;   // requests are sent from other threads, endpoints cannot be polled in turn
+  }
+#ifdef TS_HANDOFF_WORKFLOWS
+  if ( handoff_engine ) {
+    opts.threaded = true;   // workflows send prediction requests from their own thread, endpoints cannot be polled in turn
+  }
+#endif
+
+  ts::LoopbackTransport *endpoint = new ts::LoopbackTransport( bus, "ts", ts::pipeline_capacity( opts ) );
+
+  transport = std::unique_ptr<ts::Transport>( endpoint );
+  add_handlers( *transport );
+
+  // policies are routed to TS too
+  a1_responder = std::unique_ptr<ts::A1Responder>(
+      new ts::A1Responder( "trafficxapp", std::chrono::milliseconds( 5 ), send_policy_responses ) );
+
+  ts::pipeline_stats_t stats = ts::run_pipeline( bus, *endpoint, opts );
+  batch_assigner.reset();   // solves the last batch, so its handoffs are counted
+  a1_responder.reset();     // sends the last statuses while the bus is still there
+
+  cout << "[INFO] Loopback pipeline: " << stats.anomalies << " anomalies in " << stats.elapsed_s << " s ("
+       << (unsigned long) ( stats.anomalies / stats.elapsed_s ) << " anomalies/s, "
+       << ( opts.threaded ? "a thread per xApp" : "single thread" ) << "), " << stats.acks << " acked, "
+       << stats.prediction_requests << " prediction requests, " << stats.predictions << " predictions, "
+       << dry_run_handoffs << " handoff(s) decided, " << stats.refused << " message(s) refused by full queues\n";
+
+  return 0;
+}
+
 extern int main( int argc, char** argv ) {
   int nthreads = 1;
   char*	port = (char *) "4560";
-  shared_ptr<grpc::Channel> channel;
+  string replay_file;
+  double replay_speed = 1;
+  bool loopback = false;
+  ts::pipeline_opts_t pipeline;
+  int opt;
+
+  while ( ( opt = getopt( argc, argv, "r:x:l:u:c:H:w:t" ) ) != -1 ) {
+    switch ( opt ) {
+      case 'r':
+        replay_file = optarg;
+        dry_run = true;
+        break;
+      case 'x':
+        replay_speed = atof( optarg );  // 0 replays as fast as possible
+        break;
+      case 'l':
+        loopback = true;
+        dry_run = true;
+        pipeline.anomalies = strtoull( optarg, nullptr, 10 );
+        break;
+      case 'u':
+        pipeline.ues_per_msg = atoi( optarg );
+        break;
+      case 'c':
+        pipeline.ncells = atoi( optarg );
+        break;
+      case 'H':
+        pipeline.handoff_pct = atoi( optarg );
+        break;
+      case 'w':
+        pipeline.window = atoi( optarg );
+        break;
+      case 't':
+        pipeline.threaded = true;
+        break;
+      default:
+        cerr << "usage: " << argv[0] << " [-r capture_file [-x speed]]\n"
+             << "       " << argv[0] << " -l anomalies [-u ues_per_msg] [-c cells] [-H handoff_pct] [-w window] [-t]\n";
+        exit( 1 );
+    }
+  }
 
   Config *config = new Config();
   string api = config->Get_control_str("ts_control_api");
@@ -886,22 +1060,188 @@ extern int main( int argc, char** argv ) {
     ts_control_api = TsControlApi::REST;
   } else {
     ts_control_api = TsControlApi::gRPC;
+  }
+
+  int sdl_refresh_ms = config->Get_control_value( "ts_sdl_refresh_ms", 0 );
+  if ( sdl_refresh_ms > 0 ) {
+    shared_ptr<ts::KvStore> sdl = make_shared<ts::SdlKvStore>( shareddatalayer::SyncStorage::create() );
+    metrics_cache = std::unique_ptr<ts::MetricsCache>( new ts::MetricsCache( sdl,
+        get_sdl_prefixes( config->Get_control_str( "ts_sdl_prefixes", "" ) ), std::chrono::milliseconds( sdl_refresh_ms ) ) );
+    metrics_cache->start();
+  }
+
+  int neighbor_refresh_ms = config->Get_control_value( "ts_neighbor_refresh_ms", 0 );
+  if ( neighbor_refresh_ms > 0 ) {
+    neighbor_table = std::unique_ptr<ts::NeighborTable>(
+        new ts::NeighborTable( metrics_cache.get(), std::chrono::milliseconds( neighbor_refresh_ms ) ) );
+  }
 
+  // the E2 setup of each node maps its cells for gRPC, and relates them in the neighbor table
+  if ( ( ts_control_api == TsControlApi::gRPC || ( neighbor_table && metrics_cache ) ) && !dry_run ) {
     if( !build_cell_mapping() ) {
       cout << "[ERROR] unable to map cells to nodeb\n";
     }
+  }
+
+  if ( neighbor_table ) {
+    neighbor_table->start();
+    cout << "[INFO] Neighbor table enabled, " << neighbor_table->get_stats().relations << " relations, refreshed every "
+         << neighbor_refresh_ms << " ms" << ( metrics_cache ? "" : " (no cell is pruned, UE neighbors need ts_sdl_refresh_ms)" ) << endl;
+  }
+
+  if ( ts_control_api == TsControlApi::gRPC && !dry_run ) {
+    ts::rc_pool_opts_t opts;
+    opts.size = config->Get_control_value( "ts_grpc_channels", 0 );
+    opts.health_interval_ms = config->Get_control_value( "ts_grpc_health_interval_ms", 1000 );
+    opts.keepalive_time_ms = config->Get_control_value( "ts_grpc_keepalive_ms", 300000 );
+    opts.keepalive_without_calls = config->Get_control_value( "ts_grpc_keepalive_without_calls", 0 ) != 0;
+    if ( config->Get_control_str( "ts_grpc_sharding", "round-robin" ).compare( "e2node" ) == 0 ) {
+      opts.sharding = ts::ChannelSharding::E2NODE;
+    }
+    rc_pool = std::unique_ptr<ts::RcChannelPool>( new ts::RcChannelPool( ts_control_ep, opts ) );
+  }
+
+  int prediction_timeout_ms = config->Get_control_value( "ts_prediction_timeout_ms", 0 );
+  if ( prediction_timeout_ms > 0 ) {
+#ifdef TS_HANDOFF_WORKFLOWS
+    ts::workflow_opts_t opts;
+    opts.prediction_timeout = std::chrono::milliseconds( prediction_timeout_ms );
+    opts.control_timeout = std::chrono::milliseconds( (int) config->Get_control_value( "ts_control_timeout_ms", 2000 ) );
+    opts.control_workers = config->Get_control_value( "ts_control_workers", 4 );
+
+    ts::workflow_hooks_t hooks;
+    hooks.request_predictions = send_prediction_request;
+    hooks.choose_target = choose_target;
+    hooks.send_control = send_control_request;
+
+    handoff_engine = std::unique_ptr<ts::HandoffEngine>( new ts::HandoffEngine( opts, hooks ) );
+    cout << "[INFO] Handoff workflows enabled, prediction timeout " << prediction_timeout_ms << " ms, control timeout "
+         << opts.control_timeout.count() << " ms, " << opts.control_workers << " control worker(s)\n";
+#else
+    cout << "[ERROR] ts_prediction_timeout_ms is set, but handoff workflows need a build with -DCOROUTINES=1\n";
+#endif
+  }
 
-    channel = grpc::CreateChannel(ts_control_ep, grpc::InsecureChannelCredentials());
-    rc_stub = rc::MsgComm::NewStub(channel, grpc::StubOptions());
+  int pipeline_capacity = config->Get_control_value( "ts_pipeline_capacity", 0 );
+#ifdef TS_HANDOFF_WORKFLOWS
+  if ( pipeline_capacity > 0 && handoff_engine ) {
+    cout << "[INFO] Handoff workflows are enabled, ts_pipeline_capacity is ignored\n";
+    pipeline_capacity = 0;
+  }
+#endif
+  if ( pipeline_capacity > 0 && replay_file.empty() ) {  // replays call the handlers directly
+    ts::staged_opts_t opts;
+    opts.capacity = pipeline_capacity;
+    opts.cpus = get_cpu_list( config->Get_control_str( "ts_pipeline_cpus", "" ) );
+
+    ts::staged_hooks_t hooks;
+    hooks.decode_prediction = decode_prediction;
+    hooks.decode_anomaly = decode_anomaly;
+    hooks.choose_target = choose_target;
+    hooks.request_predictions = send_prediction_request;
+    hooks.send_control = send_control_request;
+
+    staged = std::unique_ptr<ts::StagedPipeline>( new ts::StagedPipeline( opts, hooks ) );
+    cout << "[INFO] Staged pipeline enabled, " << opts.capacity << " messages per stage, "
+         << ( opts.cpus.empty() ? "stages not pinned" : "stages pinned" ) << endl;
+  }
+
+  int prediction_ttl_ms = config->Get_control_value( "ts_prediction_ttl_ms", 0 );
+  if ( prediction_ttl_ms > 0 ) {
+    size_t size = config->Get_control_value( "ts_prediction_cache_size", 100000 );
+    prediction_cache = std::unique_ptr<ts::PredictionCache>(
+        new ts::PredictionCache( size, std::chrono::milliseconds( prediction_ttl_ms ) ) );
+    cout << "[INFO] Prediction cache enabled, " << size << " UEs, TTL " << prediction_ttl_ms << " ms\n";
+  }
+
+  int handoff_budget_per_cell = config->Get_control_value( "ts_handoff_budget", 0 );
+  if ( handoff_budget_per_cell > 0 ) {
+    ts::budget_opts_t opts;
+    opts.handoffs = handoff_budget_per_cell;
+    opts.interval = std::chrono::milliseconds( (int) config->Get_control_value( "ts_handoff_budget_interval_ms", 1000 ) );
+    opts.max_cells = config->Get_control_value( "ts_handoff_budget_cells", 4096 );
+
+    handoff_budget = std::unique_ptr<ts::HandoffBudget>( new ts::HandoffBudget( opts ) );
+    cout << "[INFO] Handoff budget enabled, " << opts.handoffs << " handoff(s) per cell every "
+         << opts.interval.count() << " ms, up to " << opts.max_cells << " cells\n";
+  }
+
+  int batch_window_ms = config->Get_control_value( "ts_batch_window_ms", 0 );
+#ifdef TS_HANDOFF_WORKFLOWS
+  if ( batch_window_ms > 0 && handoff_engine ) {
+    cout << "[INFO] Handoff workflows are enabled, ts_batch_window_ms is ignored\n";
+    batch_window_ms = 0;
+  }
+#endif
+  if ( batch_window_ms > 0 && staged ) {   // the decide stage picks the target of each UE
+    cout << "[INFO] The staged pipeline is enabled, ts_batch_window_ms is ignored\n";
+    batch_window_ms = 0;
+  }
+  if ( batch_window_ms > 0 && replay_file.empty() ) {  // replays count handoffs as messages are handled
+    ts::batch_opts_t opts;
+    opts.window = std::chrono::milliseconds( batch_window_ms );
+    opts.max_ues = config->Get_control_value( "ts_batch_max_ues", 10000 );
+    opts.cell_capacity = config->Get_control_value( "ts_batch_cell_capacity", 0 );
+    opts.threads = config->Get_control_value( "ts_batch_threads", 0 );
+
+    ts::batch_hooks_t hooks;
+    hooks.cell_open = []( const string &cell_id ) { return !cell_is_full( cell_id ); };
+    hooks.send_control = send_batch_handoff;
+
+    batch_assigner = std::unique_ptr<ts::BatchAssigner>( new ts::BatchAssigner( opts, hooks ) );
+    cout << "[INFO] Batch decisions enabled, window " << batch_window_ms << " ms or " << opts.max_ues << " UEs, "
+         << ( opts.cell_capacity > 0 ? to_string( opts.cell_capacity ) : string( "unlimited" ) ) << " handoff(s) per cell and batch\n";
+  }
+
+  int max_age_ms = config->Get_control_value( "ts_anomaly_max_age_ms", 0 );
+  int shed_start_pct = config->Get_control_value( "ts_shed_backlog_pct", 0 );
+  if ( ( max_age_ms > 0 || shed_start_pct > 0 ) && replay_file.empty() ) {  // captured anomalies are all old
+    ts::shed_opts_t opts;
+    opts.max_age_ms = max_age_ms;
+    opts.shed_start = shed_start_pct / 100.0;
+
+    shedder = std::unique_ptr<ts::LoadShedder>( new ts::LoadShedder( opts ) );
+    cout << "[INFO] Anomaly load shedding enabled, max age " << max_age_ms << " ms, shedding above "
+         << shed_start_pct << "% backlog\n";
+  }
+
+  int data_budget = config->Get_control_value( "ts_sched_data_budget", 0 );
+  if ( data_budget > 0 && replay_file.empty() ) {
+    ts::sched_opts_t opts;
+    opts.budget[(int) ts::MsgClass::CONTROL] = config->Get_control_value( "ts_sched_control_budget", 1024 );
+    opts.budget[(int) ts::MsgClass::DATA] = data_budget;
+
+    scheduler = std::unique_ptr<ts::PriorityScheduler>( new ts::PriorityScheduler( opts ) );
+    cout << "[INFO] Priority scheduling enabled, budget " << opts.budget[(int) ts::MsgClass::CONTROL]
+         << " control and " << data_budget << " data messages\n";
+  }
+
+  if ( !replay_file.empty() ) {
+    return replay_capture( replay_file, replay_speed );
+  }
+  if ( loopback ) {
+    return run_loopback( pipeline );
+  }
+
+  string capture_file = config->Get_control_str( "ts_capture_file", "" );
+  if ( !capture_file.empty() ) {
+    capture = std::unique_ptr<ts::CaptureWriter>( new ts::CaptureWriter( capture_file ) );
+    if ( capture->is_open() ) {
+      cout << "[INFO] Capturing inbound messages to " << capture_file << endl;
+    } else {
+      cout << "[ERROR] Unable to open capture file " << capture_file << ": " << strerror( errno ) << endl;
+      capture.reset();
+    }
   }
 
   fprintf( stderr, "[INFO] listening on port %s\n", port );
-  xfw = std::unique_ptr<Xapp>( new Xapp( port, true ) );
+  transport = std::unique_ptr<ts::Transport>( new ts::RmrTransport( port, true ) );
+  add_handlers( *transport );
 
-  xfw->Add_msg_cb( A1_POLICY_REQ, policy_callback, NULL );          // msg type 20010
-  xfw->Add_msg_cb( TS_QOE_PREDICTION, prediction_callback, NULL );  // msg type 30002
-  xfw->Add_msg_cb( TS_ANOMALY_UPDATE, ad_callback, NULL ); /*Register a callback function for msg type 30003*/
+  a1_responder = std::unique_ptr<ts::A1Responder>(
+      new ts::A1Responder( "trafficxapp", std::chrono::milliseconds( 5 ), send_policy_responses ) );
+  send_policy_query();  // rehydrates policy instances; replies arrive as A1_POLICY_REQ
 
-  xfw->Run( nthreads );
+  transport->run( nthreads );
 
 }
@@ -0,0 +1,80 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	a1_responder_test.cpp
+    Abstract:	Tests that the A1 policy statuses queued within the linger
+                window are sent as one batch, with one response per policy
+                instance. Included by unit_test.cpp.
+
+    Date:       18 Oct 2026
+*/
+
+static int a1_responder_test( ) {
+    int errors = 0;
+    std::mutex mutex;
+    std::vector<std::vector<std::string>> batches;
+
+    auto batch_count = [&]( ) {
+        std::lock_guard<std::mutex> lock( mutex );
+        return batches.size();
+    };
+    auto response = [&]( const std::string &instance, const std::string &status ) {
+        return ts::A1Responder::build_response( "trafficxapp", 20008, instance, status );
+    };
+
+    errors += fail_not_if( response( "tsapolicy145", ts::A1_STATUS_OK ) ==
+                           "{\"policy_type_id\":20008,\"policy_instance_id\":\"tsapolicy145\",\"handler_id\":\"trafficxapp\",\"status\":\"OK\"}",
+                           "response payload" );
+    errors += fail_not_if( ts::A1Responder::build_query( 20008 ) == "{\"policy_type_id\":20008}", "query payload" );
+
+    {
+        ts::A1Responder responder( "trafficxapp", std::chrono::milliseconds( 200 ), [&]( const std::vector<std::string> &payloads ) {
+            std::lock_guard<std::mutex> lock( mutex );
+            batches.push_back( payloads );
+        } );
+
+        // a burst of policies: the statuses of an instance sent twice are coalesced, the latest one wins
+        responder.enqueue( 20008, "b", ts::A1_STATUS_OK );
+        responder.enqueue( 20008, "a", ts::A1_STATUS_OK );
+        responder.enqueue( 20008, "c", ts::A1_STATUS_ERROR );
+        responder.enqueue( 20008, "a", ts::A1_STATUS_DELETED );
+
+        errors += fail_not_if( wait_for( [&]{ return batch_count() == 1; } ), "a burst is sent as one batch" );
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            errors += fail_not_if( batches[0] == std::vector<std::string>( { response( "a", ts::A1_STATUS_DELETED ),
+                                                                             response( "b", ts::A1_STATUS_OK ),
+                                                                             response( "c", ts::A1_STATUS_ERROR ) } ),
+                                   "one response per instance, with its latest status" );
+        }
+
+        responder.enqueue( 20008, "a", ts::A1_STATUS_OK );
+        errors += fail_not_if( wait_for( [&]{ return batch_count() == 2; } ), "a later status goes in a new batch" );
+
+        responder.enqueue( 20008, "d", ts::A1_STATUS_OK );
+    }       // the pending status is sent on destruction, without waiting for the window
+
+    std::lock_guard<std::mutex> lock( mutex );
+    errors += fail_not_equal( batches.size(), 3u, "batches" );
+    errors += fail_not_if( batches.size() == 3 && batches[1] == std::vector<std::string>( { response( "a", ts::A1_STATUS_OK ) } ) &&
+                           batches[2] == std::vector<std::string>( { response( "d", ts::A1_STATUS_OK ) } ), "later batches" );
+
+    return errors;
+}
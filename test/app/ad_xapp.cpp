@@ -21,7 +21,9 @@
 /*
 	Mnemonic:	ad_xapp.cpp
 	Abstract:   Simulates the AD xApp sending an anomaly dectection message to
-                the TS xApp. It sends one message and exits.
+                the TS xApp. By default it sends one message and exits; with a
+                target rate it becomes an open-loop generator that reports
+                the ACK round trip latency.
 
 	Date:		20 May 2021
 	Author:		Alexandre Huff
@@ -33,6 +35,14 @@
 #include <unistd.h>
 #include <string.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <vector>
+
 #include <rmr/RIC_message_types.h>
 #include "ricxfcpp/xapp.hpp"
 
@@ -41,14 +51,66 @@ using namespace xapp;
 
 unique_ptr<Xapp> xfw;
 
+enum class Arrivals { CONSTANT, POISSON, BURST };
+
+/*
+    Generator options. Without a rate, the original single message is sent.
+*/
+struct ad_config {
+    double rate = 0;            // anomaly messages per second
+    Arrivals arrivals = Arrivals::POISSON;
+    int burst = 10;             // messages per burst, sent back to back
+    int population = 1000;      // distinct UEs
+    int ues_per_msg = 1;
+    int duration_sec = 10;
+    int nthreads = 1;
+    bool numeric_ids = false;   // the gRPC control path requires numeric UE ids
+    string trace_file;          // send time and UE id of each anomaly, for end-to-end latency
+};
+
+ad_config config;
+
+typedef chrono::steady_clock clock_type;
+
+// send times indexed by sequence number; a slot is reused after RTT_SLOTS messages
+const size_t RTT_SLOTS = 1 << 20;
+vector<atomic<int64_t>> sent_at( RTT_SLOTS );
+
+atomic<unsigned long> sent( 0 );
+atomic<unsigned long> send_errors( 0 );
+atomic<unsigned long> acked( 0 );
+
+mutex rtt_mutex;
+vector<uint32_t> rtt_us;
+
+int64_t now_us( ) {
+    return chrono::duration_cast<chrono::microseconds>( clock_type::now().time_since_epoch() ).count();
+}
+
 void ts_callback( Message& mbuf, int mtype, int subid, int len, Msg_component payload,  void* data ) {
-    string json ((char *)payload.get(), len);
+    if ( config.rate <= 0 ) {
+        string json ((char *)payload.get(), len);
 
-    cout << "[AD] TS Callback got a message, type=" << mtype << ", length=" << len << "\n";
-    cout << "[AD] Payload  is  " << json << endl;
+        cout << "[AD] TS Callback got a message, type=" << mtype << ", length=" << len << "\n";
+        cout << "[AD] Payload  is  " << json << endl;
 
-    // we only send one message, so we expect to receive only one as well
-    xfw->Stop();
+        // we only send one message, so we expect to receive only one as well
+        xfw->Stop();
+        return;
+    }
+
+    // the ACK echoes the anomaly message, which carries its sequence number
+    string json ((char *)payload.get(), len);
+    size_t pos = json.find( "\"seq\": " );
+    if ( pos == string::npos ) {
+        return;
+    }
+    unsigned long seq = strtoul( json.c_str() + pos + 7, NULL, 10 );
+    int64_t rtt = now_us() - sent_at[seq % RTT_SLOTS].load();
+
+    acked++;
+    lock_guard<mutex> lock( rtt_mutex );
+    rtt_us.push_back( (uint32_t) max<int64_t>( rtt, 0 ) );
 }
 
 // this thread just sends out one anomaly message to the TS xApp
@@ -83,8 +145,163 @@ void ad_loop() {
         cout << "[ERROR] Unable to send a message to TS xApp, state: " << msg->Get_state() << endl;
 }
 
-int main(int argc, char const *argv[]) {
-    int nthreads = 1;
+/*
+    An anomaly array of ues_per_msg UEs drawn from the population, e.g.
+    [{"du-id": 1010, "ue-id": "Train passenger 2", "measTimeStampRf": 1620835470108, "Degradation": "RSRP RSSINR", "seq": 7}]
+    The UE ids are appended to ues.
+*/
+string anomaly_message( unsigned long seq, mt19937 &gen, vector<string> &ues ) {
+    uniform_int_distribution<int> ue_dist( 1, config.population );
+    long meas_ms = chrono::duration_cast<chrono::milliseconds>( chrono::system_clock::now().time_since_epoch() ).count();
+    string body = "[";
+
+    for ( int i = 0; i < config.ues_per_msg; i++ ) {
+        int ue = ue_dist( gen );
+        string ue_id = config.numeric_ids ? to_string( 12344 + ue ) : "Train passenger " + to_string( ue );   // numeric ids as written by populatedb
+        body += ( i == 0 ? "" : ", " );
+        body += "{\"du-id\": " + to_string( 1000 + ue % 16 ) + ", \"ue-id\": \"" + ue_id +
+                "\", \"measTimeStampRf\": " + to_string( meas_ms ) + ", \"Degradation\": \"RSRP RSSINR\", \"seq\": " + to_string( seq ) + "}";
+        ues.push_back( move( ue_id ) );
+    }
+    body += "]";
+
+    return body;
+}
+
+/*
+    Open loop: messages leave on schedule whether or not the previous ones
+    were acknowledged. When the sender falls behind, it catches up without
+    sleeping rather than lowering the offered rate.
+*/
+void load_loop() {
+    mt19937 gen( (unsigned int) time( 0 ) );
+    exponential_distribution<double> poisson_gap( config.rate );
+    unique_ptr<Message> msg = xfw->Alloc_msg( 2048 );
+
+    sleep( 1 ); // just wait receiver thread starting up
+
+    auto start = clock_type::now();
+    auto end = start + chrono::seconds( config.duration_sec );
+    auto next = start;
+    unsigned long seq = 0;
+
+    // kept in memory while sending, written at the end
+    vector<pair<int64_t, string>> trace;
+    vector<string> ues;
+
+    while ( next < end ) {
+        this_thread::sleep_until( next );
+
+        int count = config.arrivals == Arrivals::BURST ? config.burst : 1;
+        for ( int i = 0; i < count; i++, seq++ ) {
+            ues.clear();
+            string body = anomaly_message( seq, gen, ues );
+            int len = body.size();
+
+            if ( msg == NULL || msg->Get_available_size() < len ) {
+                msg = xfw->Alloc_msg( len );
+            }
+
+            sent_at[seq % RTT_SLOTS].store( now_us() );
+            if ( msg != NULL && msg->Send_msg( TS_ANOMALY_UPDATE, Message::NO_SUBID, len, (unsigned char *) body.c_str() ) ) { // msg type 30003
+                sent++;
+                if ( !config.trace_file.empty() ) {
+                    int64_t wall_us = chrono::duration_cast<chrono::microseconds>( chrono::system_clock::now().time_since_epoch() ).count();
+                    for ( auto &ue : ues ) {
+                        trace.emplace_back( wall_us, move( ue ) );
+                    }
+                }
+            } else {
+                send_errors++;
+            }
+        }
+
+        double gap;
+        switch ( config.arrivals ) {
+            case Arrivals::POISSON: gap = poisson_gap( gen ); break;
+            case Arrivals::BURST: gap = config.burst / config.rate; break;
+            default: gap = 1.0 / config.rate; break;
+        }
+        next += chrono::duration_cast<clock_type::duration>( chrono::duration<double>( gap ) );
+    }
+
+    double elapsed = chrono::duration<double>( clock_type::now() - start ).count();
+    sleep( 1 ); // late ACKs
+
+    vector<uint32_t> rtts;
+    {
+        lock_guard<mutex> lock( rtt_mutex );
+        rtts.swap( rtt_us );
+    }
+    sort( rtts.begin(), rtts.end() );
+    auto pct = [&rtts]( double p ) -> uint32_t {
+        return rtts.empty() ? 0 : rtts[ min( rtts.size() - 1, (size_t) ( p * rtts.size() ) ) ];
+    };
+
+    cout << "[AD] sent " << sent.load() << " messages (" << sent.load() * config.ues_per_msg << " anomalies) in " << elapsed << " s, "
+         << sent.load() / elapsed << " msgs/s, send errors " << send_errors.load() << ", acked " << acked.load() << endl;
+    cout << "[AD] ACK RTT us: p50 " << pct( 0.50 ) << ", p90 " << pct( 0.90 ) << ", p99 " << pct( 0.99 )
+         << ", p99.9 " << pct( 0.999 ) << ", max " << ( rtts.empty() ? 0 : rtts.back() ) << endl;
+
+    if ( !config.trace_file.empty() ) {
+        ofstream out( config.trace_file );
+        for ( auto &t : trace ) {
+            out << t.first << " " << t.second << "\n";
+        }
+    }
+
+    xfw->Stop();
+}
+
+void usage( const char *prog ) {
+    cout << "usage: " << prog << " [-r rate] [-a poisson|burst|constant] [-b burst] [-p population] [-u ues-per-msg] [-d seconds] [-t threads] [-n] [-o trace-file]\n"
+         << "  without -r, one anomaly message is sent and the program exits on its ACK\n"
+         << "  -r  anomaly messages per second\n"
+         << "  -a  arrival pattern (default poisson)\n"
+         << "  -b  messages per burst (default 10)\n"
+         << "  -p  number of distinct UEs (default 1000)\n"
+         << "  -u  UEs in each anomaly message (default 1)\n"
+         << "  -d  duration in seconds (default 10)\n"
+         << "  -t  threads receiving ACKs (default 1)\n"
+         << "  -n  numeric UE ids, as used by the gRPC control path\n"
+         << "  -o  write the wall clock send time (us) and id of each UE to a file" << endl;
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+
+    while ( ( opt = getopt( argc, argv, "r:a:b:p:u:d:t:no:h" ) ) != -1 ) {
+        switch ( opt ) {
+            case 'r': config.rate = atof( optarg ); break;
+            case 'a':
+                if ( strcmp( optarg, "poisson" ) == 0 ) {
+                    config.arrivals = Arrivals::POISSON;
+                } else if ( strcmp( optarg, "burst" ) == 0 ) {
+                    config.arrivals = Arrivals::BURST;
+                } else if ( strcmp( optarg, "constant" ) == 0 ) {
+                    config.arrivals = Arrivals::CONSTANT;
+                } else {
+                    usage( argv[0] );
+                    return 1;
+                }
+                break;
+            case 'b': config.burst = atoi( optarg ); break;
+            case 'p': config.population = atoi( optarg ); break;
+            case 'u': config.ues_per_msg = atoi( optarg ); break;
+            case 'd': config.duration_sec = atoi( optarg ); break;
+            case 't': config.nthreads = atoi( optarg ); break;
+            case 'n': config.numeric_ids = true; break;
+            case 'o': config.trace_file = optarg; break;
+            default:
+                usage( argv[0] );
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if ( config.rate < 0 || config.burst < 1 || config.population < 1 || config.ues_per_msg < 1 || config.duration_sec < 1 || config.nthreads < 1 ) {
+        usage( argv[0] );
+        return 1;
+    }
 
     char* port = (char *) "4570";
 
@@ -94,9 +311,13 @@ int main(int argc, char const *argv[]) {
     xfw->Add_msg_cb( TS_ANOMALY_ACK, ts_callback, NULL ); /*Register a callback function for msg type 30004*/
 
     std::thread ad_thread;
-    ad_thread = std::thread(&ad_loop);
+    if ( config.rate > 0 ) {
+        ad_thread = std::thread(&load_loop);
+    } else {
+        ad_thread = std::thread(&ad_loop);
+    }
 
-    xfw->Run( nthreads );
+    xfw->Run( config.nthreads );
 
     ad_thread.join();
 
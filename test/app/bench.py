@@ -0,0 +1,340 @@
+#!/usr/bin/env python3
+# ==================================================================================
+#	Copyright (c) 2021 AT&T Intellectual Property.
+#
+#    Licensed under the Apache License, Version 2.0 (the "License");
+#    you may not use this file except in compliance with the License.
+#    You may obtain a copy of the License at
+#
+#        http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing, software
+#    distributed under the License is distributed on an "AS IS" BASIS,
+#    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#    See the License for the specific language governing permissions and
+#    limitations under the License.
+# ==================================================================================
+#
+#
+# 	Mnemonic:	bench.py
+# 	Abstract:   End-to-end benchmark of the AD -> TS -> QP -> control pipeline.
+#               Runs the TS xApp, the QP simulator and a control endpoint on
+#               this host with RMR static routes, drives them with the AD
+#               generator, and writes a JSON report with the handoff rate,
+#               the anomaly to control latency and the CPU and memory used
+#               by each component.
+#
+#               The control endpoint is rest_server (ts_control_api "rest"),
+#               or rc_xapp (ts_control_api "grpc"); the gRPC path resolves
+#               target cells through the E2 manager, so it needs --e2mgr.
+#
+#               Latency is measured from the moment AD sends an anomaly to the
+#               moment the control request for that UE reaches the endpoint,
+#               by joining the traces both write (wall clock of this host).
+#
+# 	Date:		18 Oct 2026
+
+
+import argparse
+import bisect
+import datetime
+import json
+import os
+import platform
+import re
+import shutil
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+REPO_DIR = os.path.abspath(os.path.join(SCRIPT_DIR, "..", ".."))
+CLK_TCK = os.sysconf("SC_CLK_TCK")
+
+# RMR ports of the components
+TS_PORT = 4560
+AD_PORT = 4570
+QP_PORT = 4580
+
+
+def parse_args():
+    p = argparse.ArgumentParser(description="End-to-end benchmark of the Traffic Steering pipeline")
+    p.add_argument("--ts-xapp", default=os.path.join(REPO_DIR, "build", "src", "ts_xapp", "ts_xapp"), help="TS xApp binary")
+    p.add_argument("--bin-dir", default=os.path.join(SCRIPT_DIR, "build"), help="directory with ad_xapp, qp_xapp, rc_xapp and rest_server")
+    p.add_argument("--descriptor", default=os.path.join(REPO_DIR, "xapp-descriptor", "config-file.json"), help="TS xApp config file")
+    p.add_argument("--control", choices=["rest", "grpc"], default="rest", help="control API of the TS xApp")
+    p.add_argument("--e2mgr", help="E2 manager base URL, required by the gRPC control path")
+    p.add_argument("--rate", type=float, default=1000, help="anomaly messages per second")
+    p.add_argument("--arrivals", choices=["poisson", "burst", "constant"], default="poisson")
+    p.add_argument("--burst", type=int, default=10, help="messages per burst")
+    p.add_argument("--population", type=int, default=10000, help="distinct UEs")
+    p.add_argument("--ues-per-msg", type=int, default=1, help="UEs in each anomaly message")
+    p.add_argument("--duration", type=int, default=30, help="seconds of load")
+    p.add_argument("--handoff-pct", type=int, default=50, help="share of UEs the QP simulator predicts to hand off")
+    p.add_argument("--cells", type=int, default=3, help="cells in each prediction")
+    p.add_argument("--qp-latency", type=int, default=0, help="QP reply latency, in ms")
+    p.add_argument("--qp-threads", type=int, default=1)
+    p.add_argument("--control-delay", type=int, default=0, help="control endpoint response delay, in ms")
+    p.add_argument("--control-threads", type=int, default=2)
+    p.add_argument("--output", default="bench-results.json", help="JSON report")
+    p.add_argument("--keep", action="store_true", help="keep the work directory with logs and traces")
+    return p.parse_args()
+
+
+class Component:
+    """ A process of the benchmark and its resource usage """
+
+    def __init__(self, name, cmd, workdir, env):
+        self.name = name
+        self.log = os.path.join(workdir, name + ".log")
+        with open(self.log, "w") as log:
+            self.proc = subprocess.Popen(cmd, stdout=log, stderr=subprocess.STDOUT, env=env, cwd=workdir)
+        self.cpu_start = None
+        self.cpu_end = None
+        self.peak_rss_kb = None
+
+    def cpu_ticks(self):
+        try:
+            with open("/proc/%d/stat" % self.proc.pid) as f:
+                fields = f.read().rsplit(")", 1)[1].split()
+            return int(fields[11]) + int(fields[12])        # utime + stime
+        except (OSError, IndexError):
+            return None
+
+    def status_kb(self, key):
+        try:
+            with open("/proc/%d/status" % self.proc.pid) as f:
+                for line in f:
+                    if line.startswith(key + ":"):
+                        return int(line.split()[1])
+        except OSError:
+            pass
+        return None
+
+    def mark_start(self):
+        self.cpu_start = self.cpu_ticks()
+
+    def mark_end(self):
+        self.cpu_end = self.cpu_ticks()
+        self.peak_rss_kb = self.status_kb("VmHWM")
+
+    def usage(self, seconds):
+        cpu_sec = None
+        if self.cpu_start is not None and self.cpu_end is not None:
+            cpu_sec = (self.cpu_end - self.cpu_start) / CLK_TCK
+        return {
+            "cpu_sec": cpu_sec,
+            "cpu_pct": round(100 * cpu_sec / seconds, 1) if cpu_sec is not None and seconds > 0 else None,
+            "peak_rss_kb": self.peak_rss_kb,
+        }
+
+    def stop(self, timeout=5):
+        if self.proc.poll() is None:
+            self.proc.send_signal(signal.SIGTERM)
+            try:
+                self.proc.wait(timeout)
+            except subprocess.TimeoutExpired:
+                self.proc.kill()
+                self.proc.wait()
+
+
+def write_routes(path):
+    with open(path, "w") as f:
+        f.write("newrt|start\n")
+        f.write("mse | 20010 | -1 | 127.0.0.1:%d\n" % TS_PORT)
+        f.write("mse | 30002 | -1 | 127.0.0.1:%d\n" % TS_PORT)
+        f.write("mse | 30003 | -1 | 127.0.0.1:%d\n" % TS_PORT)
+        f.write("mse | 30004 | -1 | 127.0.0.1:%d\n" % AD_PORT)
+        f.write("mse | 30000 | -1 | 127.0.0.1:%d\n" % QP_PORT)
+        f.write("newrt|end\n")
+
+
+def write_config(args, path):
+    with open(args.descriptor) as f:
+        config = json.load(f)
+    if args.control == "rest":
+        config["controls"]["ts_control_api"] = "rest"
+        config["controls"]["ts_control_ep"] = "http://127.0.0.1:5000/api/echo"
+    else:
+        config["controls"]["ts_control_api"] = "grpc"
+        config["controls"]["ts_control_ep"] = "127.0.0.1:50051"
+    with open(path, "w") as f:
+        json.dump(config, f, indent=4)
+
+
+def read_trace(path):
+    """ lines of "time-us ue-id" """
+    trace = []
+    if os.path.exists(path):
+        with open(path) as f:
+            for line in f:
+                parts = line.rstrip("\n").split(" ", 1)
+                if len(parts) == 2:
+                    trace.append((int(parts[0]), parts[1]))
+    return trace
+
+
+def percentile(values, p):
+    if not values:
+        return None
+    return values[min(len(values) - 1, int(p * len(values)))]
+
+
+def join_latencies(sends, controls):
+    """ latency of each control from the latest anomaly sent for the same UE before it """
+    by_ue = {}
+    for t, ue in sends:
+        by_ue.setdefault(ue, []).append(t)
+    for times in by_ue.values():
+        times.sort()
+
+    latencies = []
+    for t, ue in controls:
+        times = by_ue.get(ue)
+        if not times:
+            continue
+        i = bisect.bisect_right(times, t) - 1
+        if i >= 0:
+            latencies.append(t - times[i])
+    latencies.sort()
+    return latencies
+
+
+def parse_ad_output(log):
+    """ the summary printed by ad_xapp at the end of the run """
+    result = {}
+    with open(log) as f:
+        text = f.read()
+    m = re.search(r"sent (\d+) messages \((\d+) anomalies\) in ([\d.]+) s, ([\d.]+) msgs/s, send errors (\d+), acked (\d+)", text)
+    if m:
+        result.update(messages=int(m.group(1)), anomalies=int(m.group(2)), seconds=float(m.group(3)),
+                      msgs_per_sec=float(m.group(4)), send_errors=int(m.group(5)), acked=int(m.group(6)))
+    m = re.search(r"ACK RTT us: p50 (\d+), p90 (\d+), p99 (\d+), p99.9 (\d+), max (\d+)", text)
+    if m:
+        result["ack_rtt_us"] = dict(zip(["p50", "p90", "p99", "p999", "max"], map(int, m.groups())))
+    return result
+
+
+def git_revision():
+    try:
+        return subprocess.check_output(["git", "describe", "--always", "--dirty"], cwd=REPO_DIR,
+                                       stderr=subprocess.DEVNULL).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def main():
+    args = parse_args()
+    if args.control == "grpc" and not args.e2mgr:
+        sys.exit("the gRPC control path resolves target cells through the E2 manager, --e2mgr is required")
+    for binary in [args.ts_xapp] + [os.path.join(args.bin_dir, b) for b in ("ad_xapp", "qp_xapp", "rest_server", "rc_xapp")]:
+        if not os.access(binary, os.X_OK) and not (binary.endswith("rc_xapp") and args.control == "rest") \
+                and not (binary.endswith("rest_server") and args.control == "grpc"):
+            sys.exit("missing binary " + binary)
+
+    workdir = tempfile.mkdtemp(prefix="ts-bench-")
+    write_routes(os.path.join(workdir, "routes.rt"))
+    write_config(args, os.path.join(workdir, "config-file.json"))
+
+    env = dict(os.environ)
+    env["RMR_SEED_RT"] = os.path.join(workdir, "routes.rt")
+    env["RMR_RTG_SVC"] = "-1"                   # static routes only
+    env["XAPP_DESCRIPTOR_PATH"] = workdir
+    if args.e2mgr:
+        env["SERVICE_E2MGR_HTTP_BASE_URL"] = args.e2mgr
+
+    control_trace = os.path.join(workdir, "control.trace")
+    ad_trace = os.path.join(workdir, "ad.trace")
+    components = []
+    try:
+        if args.control == "rest":
+            components.append(Component("control", [os.path.join(args.bin_dir, "rest_server"), "-p", "5000",
+                                                    "-t", str(args.control_threads), "-d", str(args.control_delay),
+                                                    "-o", control_trace], workdir, env))
+        else:
+            components.append(Component("control", [os.path.join(args.bin_dir, "rc_xapp"), "-a",
+                                                    "-t", str(args.control_threads), "-d", str(args.control_delay),
+                                                    "-o", control_trace], workdir, env))
+        components.append(Component("qp", [os.path.join(args.bin_dir, "qp_xapp"), "-q", "-c", str(args.cells),
+                                           "-H", str(args.handoff_pct), "-l", str(args.qp_latency),
+                                           "-t", str(args.qp_threads)], workdir, env))
+        components.append(Component("ts", [args.ts_xapp], workdir, env))
+        time.sleep(2)                           # route tables loaded, control channel up
+
+        for c in components:
+            if c.proc.poll() is not None:
+                sys.exit("%s exited early, see %s" % (c.name, c.log))
+            c.mark_start()
+
+        ad_cmd = [os.path.join(args.bin_dir, "ad_xapp"), "-r", str(args.rate), "-a", args.arrivals, "-b", str(args.burst),
+                  "-p", str(args.population), "-u", str(args.ues_per_msg), "-d", str(args.duration), "-o", ad_trace]
+        if args.control == "grpc":
+            ad_cmd.append("-n")
+        ad = Component("ad", ad_cmd, workdir, env)
+        start = time.time()
+        ad.mark_start()
+        while ad.proc.poll() is None:
+            ad.mark_end()                       # last sample before it exits
+            time.sleep(0.2)
+        elapsed = time.time() - start
+
+        time.sleep(1)                           # in flight controls
+        for c in components:
+            c.mark_end()
+        load_sec = args.duration
+    finally:
+        for c in reversed(components):
+            c.stop()
+
+    sends = read_trace(ad_trace)
+    controls = read_trace(control_trace)
+    latencies = join_latencies(sends, controls)
+
+    # controls caused by the load window only
+    handoffs = len(controls)
+    if sends:
+        first, last = sends[0][0], max(t for t, _ in sends)
+        handoffs = sum(1 for t, _ in controls if first <= t <= last + 1000000)
+
+    report = {
+        "schema": 1,
+        "timestamp": datetime.datetime.utcnow().strftime("%Y-%m-%dT%H:%M:%SZ"),
+        "revision": git_revision(),
+        "host": {"name": platform.node(), "cpus": os.cpu_count(), "kernel": platform.release()},
+        "params": {k: v for k, v in vars(args).items() if k not in ("output", "keep")},
+        "results": {
+            "anomalies_sent": len(sends),
+            "controls": handoffs,
+            "handoffs_per_sec": round(handoffs / load_sec, 1),
+            "anomaly_to_control_us": {
+                "matched": len(latencies),
+                "p50": percentile(latencies, 0.50),
+                "p99": percentile(latencies, 0.99),
+                "p999": percentile(latencies, 0.999),
+                "max": latencies[-1] if latencies else None,
+            },
+            "ad": parse_ad_output(ad.log),
+            "components": {c.name: c.usage(elapsed) for c in components + [ad]},
+        },
+    }
+
+    with open(args.output, "w") as f:
+        json.dump(report, f, indent=2)
+
+    r = report["results"]
+    print("anomalies sent %d, controls %d, handoffs/s %.1f" % (r["anomalies_sent"], r["controls"], r["handoffs_per_sec"]))
+    print("anomaly to control us: %s" % json.dumps(r["anomaly_to_control_us"]))
+    for name, usage in r["components"].items():
+        print("%-8s cpu %s%%, peak rss %s kB" % (name, usage["cpu_pct"], usage["peak_rss_kb"]))
+    print("report written to %s" % args.output)
+
+    if args.keep:
+        print("logs and traces in %s" % workdir)
+    else:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -33,8 +33,15 @@
 #include <unistd.h>
 #include <string.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdlib>
 #include <ctime>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <vector>
 
 #include <rapidjson/document.h>
 #include <rapidjson/writer.h>
@@ -51,55 +58,289 @@ using namespace rapidjson;
 
 unique_ptr<Xapp> xfw;
 
+/*
+    Load testing options. The defaults reproduce the original behavior:
+    three cells with random predictions, replies sent right away, one
+    thread and every message logged.
+*/
+struct qp_config {
+    int ncells = 3;             // cells in each prediction, the first one is the serving cell
+    int handoff_pct = -1;       // share of UEs predicted to be better off in a neighbor cell, -1 for random predictions
+    int latency_ms = 0;         // added to every reply
+    int jitter_ms = 0;          // on top of latency, uniform in [0, jitter] or exponential with that mean
+    bool exp_jitter = false;
+    int nthreads = 1;
+    bool verbose = true;
+};
+
+qp_config config;
+
+atomic<unsigned long> requests( 0 );
+atomic<unsigned long> replies( 0 );
+atomic<unsigned long> handoffs( 0 );
+atomic<unsigned long> send_errors( 0 );
+
+// rand() is not thread safe
+mt19937 &rng( ) {
+    static atomic<unsigned int> seq( 0 );
+    thread_local mt19937 gen( (unsigned int) time( 0 ) + 7919 * seq++ );
+    return gen;
+}
+
+int uniform( int lo, int hi ) {
+    return uniform_int_distribution<int>( lo, hi )( rng() );
+}
+
+/*
+    Builds the prediction of one UE, e.g.
+    {"ueid-user1": {"CID1": [10, 20], "CID2": [30, 40], "CID3": [50, 60]}}
+    With a handoff share, the downlink prediction of a neighbor cell is well
+    above the serving cell (at least twice, so A1 thresholds up to 100% still
+    trigger the handoff) for that share of UEs, and below it for the others.
+*/
+string build_prediction( const string &ueid ) {
+    vector<int> down( config.ncells );
+    vector<int> up( config.ncells );
+
+    if ( config.handoff_pct < 0 ) {
+        for ( int i = 0; i < config.ncells; i++ ) {
+            down[i] = uniform( 0, 99 );
+            up[i] = uniform( 0, 99 );
+        }
+    } else {
+        bool handoff = config.ncells > 1 && uniform( 0, 99 ) < config.handoff_pct;
+        int best = handoff ? uniform( 1, config.ncells - 1 ) : -1;
+
+        down[0] = uniform( 10, 50 );
+        for ( int i = 0; i < config.ncells; i++ ) {
+            if ( i == best ) {
+                down[i] = down[0] * 2 + uniform( 1, 50 );
+            } else if ( i > 0 ) {
+                down[i] = uniform( 0, down[0] - 1 );
+            }
+            up[i] = uniform( 0, 99 );
+        }
+
+        if ( handoff ) {
+            handoffs++;
+        }
+    }
+
+    string body = "{\"" + ueid + "\": {";
+    for ( int i = 0; i < config.ncells; i++ ) {
+        body += "\"CID" + to_string( i + 1 ) + "\": [" + to_string( down[i] ) + ", " + to_string( up[i] ) + "]";
+        body += ( i == config.ncells - 1 ) ? "}}" : ", ";
+    }
+
+    return body;
+}
+
+int reply_delay_ms( ) {
+    int delay = config.latency_ms;
+
+    if ( config.jitter_ms > 0 ) {
+        if ( config.exp_jitter ) {
+            delay += (int) exponential_distribution<double>( 1.0 / config.jitter_ms )( rng() );
+        } else {
+            delay += uniform( 0, config.jitter_ms );
+        }
+    }
+
+    return delay;
+}
+
+/*
+    Replies waiting for their delay to expire. The request buffer belongs to
+    the framework once the callback returns, so delayed replies are routed
+    to TS (message type 30002) from a buffer of the sender thread.
+*/
+class DelayedSender {
+    private:
+        typedef pair<chrono::steady_clock::time_point, string> reply_t;
+
+        struct later {
+            bool operator()( const reply_t &a, const reply_t &b ) const { return a.first > b.first; }
+        };
+
+        mutex mtx;
+        condition_variable cv;
+        priority_queue<reply_t, vector<reply_t>, later> pending;
+        thread sender;
+
+        void send_loop( ) {
+            unique_ptr<Message> msg = xfw->Alloc_msg( 2048 );
+            unique_lock<mutex> lock( mtx );
+
+            while ( true ) {
+                if ( pending.empty() ) {
+                    cv.wait( lock );
+                    continue;
+                }
+                if ( chrono::steady_clock::now() < pending.top().first ) {
+                    cv.wait_until( lock, pending.top().first );
+                    continue;
+                }
+
+                string body = pending.top().second;
+                pending.pop();
+                lock.unlock();
+
+                int len = body.size();
+                if ( msg == NULL || msg->Get_available_size() < len ) {
+                    msg = xfw->Alloc_msg( len );
+                }
+                if ( config.verbose ) {
+                    cout << "[QP] Sending a message to TS, length=" << len << "\n";
+                    cout << "[QP] Message body " << body << endl;
+                }
+                if ( msg != NULL && msg->Send_msg( TS_QOE_PREDICTION, Message::NO_SUBID, len, (unsigned char *) body.c_str() ) ) {
+                    replies++;
+                } else {
+                    send_errors++;
+                    if ( config.verbose ) {
+                        cout << "[ERROR] unable to send a message to TS xApp, state: " << ( msg ? msg->Get_state() : -1 ) << endl;
+                    }
+                }
+
+                lock.lock();
+            }
+        }
+
+    public:
+        DelayedSender( ) {
+            sender = thread( &DelayedSender::send_loop, this );
+            sender.detach();    // runs as long as the simulator
+        }
+
+        void enqueue( int delay_ms, string &&body ) {
+            {
+                lock_guard<mutex> lock( mtx );
+                pending.emplace( chrono::steady_clock::now() + chrono::milliseconds( delay_ms ), move( body ) );
+            }
+            cv.notify_one();
+        }
+};
+
+unique_ptr<DelayedSender> delayed_sender;
+
 
 void prediction_callback( Message& mbuf, int mtype, int subid, int len, Msg_component payload,  void* data ) {
     string json ((char *) payload.get(), len);
 
-    cout << "[QP] Prediction Callback got a message, type=" << mtype << ", length=" << len << "\n";
-    cout << "[QP] Payload is " << json << endl;
+    requests++;
+    if ( config.verbose ) {
+        cout << "[QP] Prediction Callback got a message, type=" << mtype << ", length=" << len << "\n";
+        cout << "[QP] Payload is " << json << endl;
+    }
 
     Document document;
     document.Parse(json.c_str());
+    if ( document.HasParseError() || !document.IsObject() || !document.HasMember( "UEPredictionSet" ) || !document["UEPredictionSet"].IsArray() ) {
+        cout << "[ERROR] invalid prediction request: " << json << endl;
+        return;
+    }
 
     const Value& uePred = document["UEPredictionSet"];
-    if ( uePred.Size() > 0 ) {
-        string ueid = uePred[0].GetString();
-        // we want to create "{"ueid-user1": {"CID1": [10, 20], "CID2": [30, 40], "CID3": [50, 60]}}";
-        string body = "{\"" + ueid + "\": {";
-        for ( int i = 1; i <= 3; i++ ) {
-            int down = rand() % 100;
-            int up = rand() % 100;
-            if ( i != 3 ) {
-                body += "\"CID" + to_string(i) + "\": [" + to_string(down) + ", " + to_string(up) + "], ";
-            } else {
-                body += "\"CID" + to_string(i) + "\": [" + to_string(down) + ", " + to_string(up) + "]}}";
-            }
+    bool immediate = config.latency_ms == 0 && config.jitter_ms == 0 && uePred.Size() == 1;
+
+    // one prediction per UE; the prediction message only carries one UE
+    for ( SizeType u = 0; u < uePred.Size(); u++ ) {
+        if ( !uePred[u].IsString() ) {
+            continue;
+        }
+        string body = build_prediction( uePred[u].GetString() );
+
+        if ( !immediate ) {
+            delayed_sender->enqueue( reply_delay_ms(), move( body ) );
+            continue;
         }
 
         int len = body.size();
 
-        cout << "[QP] Sending a message to TS, length=" << len << "\n";
-        cout << "[QP] Message body " << body << endl;
+        if ( config.verbose ) {
+            cout << "[QP] Sending a message to TS, length=" << len << "\n";
+            cout << "[QP] Message body " << body << endl;
+        }
 
         // payload updated in place, nothing to copy from, so payload parm is nil
-        if ( ! mbuf.Send_response( TS_QOE_PREDICTION, Message::NO_SUBID, len, (unsigned char *) body.c_str() ) ) // msg type 30002
-            cout << "[ERROR] unable to send a message to TS xApp, state: " << mbuf.Get_state() << endl;
+        if ( mbuf.Send_response( TS_QOE_PREDICTION, Message::NO_SUBID, len, (unsigned char *) body.c_str() ) ) { // msg type 30002
+            replies++;
+        } else {
+            send_errors++;
+            if ( config.verbose ) {
+                cout << "[ERROR] unable to send a message to TS xApp, state: " << mbuf.Get_state() << endl;
+            }
+        }
     }
 }
 
-int main(int argc, char const *argv[]) {
-    int nthreads = 1;
+// prints the message rates every interval when per-message logging is off
+void report_stats( int interval_sec ) {
+    unsigned long last_requests = 0;
+    unsigned long last_replies = 0;
+
+    while ( true ) {
+        this_thread::sleep_for( chrono::seconds( interval_sec ) );
+
+        unsigned long req = requests.load();
+        unsigned long rep = replies.load();
+        cout << "[QP] requests/s " << ( req - last_requests ) / interval_sec << ", replies/s " << ( rep - last_replies ) / interval_sec
+             << ", total requests " << req << ", replies " << rep << ", handoffs " << handoffs.load()
+             << ", send errors " << send_errors.load() << endl;
+        last_requests = req;
+        last_replies = rep;
+    }
+}
 
-    srand( (unsigned int) time(0) );
+void usage( const char *prog ) {
+    cout << "usage: " << prog << " [-c cells] [-H handoff-pct] [-l latency-ms] [-j jitter-ms] [-e] [-t threads] [-q]\n"
+         << "  -c  cells in each prediction, the first one is the serving cell (default 3)\n"
+         << "  -H  percentage of UEs predicted to hand off (default: random predictions)\n"
+         << "  -l  latency added to each reply, in ms\n"
+         << "  -j  reply jitter in ms, uniform in [0, jitter]\n"
+         << "  -e  exponential jitter, with mean jitter-ms\n"
+         << "  -t  threads receiving messages (default 1)\n"
+         << "  -q  quiet, print message rates instead of each message" << endl;
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+
+    while ( ( opt = getopt( argc, argv, "c:H:l:j:et:qh" ) ) != -1 ) {
+        switch ( opt ) {
+            case 'c': config.ncells = atoi( optarg ); break;
+            case 'H': config.handoff_pct = atoi( optarg ); break;
+            case 'l': config.latency_ms = atoi( optarg ); break;
+            case 'j': config.jitter_ms = atoi( optarg ); break;
+            case 'e': config.exp_jitter = true; break;
+            case 't': config.nthreads = atoi( optarg ); break;
+            case 'q': config.verbose = false; break;
+            default:
+                usage( argv[0] );
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if ( config.ncells < 1 || config.handoff_pct > 100 || config.latency_ms < 0 || config.jitter_ms < 0 || config.nthreads < 1 ) {
+        usage( argv[0] );
+        return 1;
+    }
 
     char* port = (char *) "4580";
 
-    cout << "[QP] listening on port " << port << endl;
+    cout << "[QP] listening on port " << port << ", cells " << config.ncells << ", handoff % " << config.handoff_pct
+         << ", latency " << config.latency_ms << " ms, jitter " << config.jitter_ms << " ms" << ( config.exp_jitter ? " (exponential)" : "" )
+         << ", threads " << config.nthreads << endl;
     xfw = std::unique_ptr<Xapp>( new Xapp( port, true ) );
+    delayed_sender = unique_ptr<DelayedSender>( new DelayedSender() );
+
+    if ( !config.verbose ) {
+        thread( report_stats, 5 ).detach();
+    }
 
     xfw->Add_msg_cb( TS_UE_LIST, prediction_callback, NULL ); /*Register a callback function for msg type 30000*/
 
-    xfw->Run( nthreads );
+    xfw->Run( config.nthreads );
 
     return 0;
 }
@@ -21,15 +21,27 @@
 /*
 	Mnemonic:	rc_xapp.cpp
 	Abstract:   Implements a simple echo server just for testing gRPC calls
-                from TS xApp.
+                from TS xApp. A load mode serves requests asynchronously, with
+                injected delay and errors, and prints server side stats.
 
 	Date:		08 Dec 2021
 	Author:		Alexandre Huff
 */
 
 #include <iostream>
+#include <signal.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <vector>
 
 #include <grpc/grpc.h>
+#include <grpcpp/alarm.h>
 #include <grpcpp/security/server_credentials.h>
 #include <grpcpp/server.h>
 #include <grpcpp/server_builder.h>
@@ -38,6 +50,101 @@
 
 using namespace std;
 
+typedef chrono::steady_clock clock_type;
+
+/*
+    Load mode options. Without -a, the synchronous echo server is used.
+*/
+struct rc_config {
+    bool async = false;
+    int nthreads = 2;           // completion queues, each one polled by a thread
+    int delay_ms = 0;           // before answering
+    int jitter_ms = 0;          // on top of delay, uniform in [0, jitter]
+    double error_rate = 0;      // share of requests failed with UNAVAILABLE
+    int stats_sec = 5;
+    string address = "0.0.0.0:50051";
+    string trace_file;          // arrival time and UE of each request, written on exit
+};
+
+rc_config config;
+
+volatile sig_atomic_t stopping = 0;
+
+void on_signal( int ) {
+    stopping = 1;
+}
+
+// state of a thread serving a completion queue
+struct worker_ctx {
+    mt19937 gen { random_device{}() };
+    vector<pair<int64_t, long>> trace;
+};
+
+/*
+    Latency histogram with log2 buckets split in 8 linear sub-buckets, so
+    percentiles are within 12.5%. Updated without locks from any thread.
+*/
+class LatencyHistogram {
+    private:
+        static const int SUB_BITS = 3;
+        static const int NBUCKETS = 64 << SUB_BITS;
+        vector<atomic<unsigned long>> buckets;
+
+        static int index( uint64_t us ) {
+            if ( us < ( 1u << SUB_BITS ) ) {
+                return us;
+            }
+            int exp = 63 - __builtin_clzll( us );
+            return ( ( exp - SUB_BITS + 1 ) << SUB_BITS ) + ( ( us >> ( exp - SUB_BITS ) ) & ( ( 1 << SUB_BITS ) - 1 ) );
+        }
+
+        // largest value of a bucket
+        static uint64_t upper( int idx ) {
+            if ( idx < ( 1 << SUB_BITS ) ) {
+                return idx;
+            }
+            int exp = ( idx >> SUB_BITS ) + SUB_BITS - 1;
+            uint64_t base = ( 1ull << exp ) + ( (uint64_t) ( idx & ( ( 1 << SUB_BITS ) - 1 ) ) << ( exp - SUB_BITS ) );
+            return base + ( 1ull << ( exp - SUB_BITS ) ) - 1;
+        }
+
+    public:
+        LatencyHistogram( ) : buckets( NBUCKETS ) { }
+
+        void add( uint64_t us ) {
+            buckets[index( us )].fetch_add( 1, memory_order_relaxed );
+        }
+
+        // moves the counts out, so each dump covers one interval
+        vector<unsigned long> drain( ) {
+            vector<unsigned long> counts( NBUCKETS );
+            for ( int i = 0; i < NBUCKETS; i++ ) {
+                counts[i] = buckets[i].exchange( 0, memory_order_relaxed );
+            }
+            return counts;
+        }
+
+        static uint64_t percentile( const vector<unsigned long> &counts, double p ) {
+            unsigned long total = 0;
+            for ( auto c : counts ) {
+                total += c;
+            }
+            unsigned long rank = (unsigned long) ceil( p * total );
+            unsigned long seen = 0;
+            for ( int i = 0; i < NBUCKETS; i++ ) {
+                seen += counts[i];
+                if ( seen >= rank && seen > 0 ) {
+                    return upper( i );
+                }
+            }
+            return 0;
+        }
+};
+
+atomic<unsigned long> requests( 0 );
+atomic<unsigned long> errors( 0 );
+LatencyHistogram latency;
+
 class ControlServiceImpl : public rc::MsgComm::Service {
     ::grpc::Status SendRICControlReqServiceGrpc(::grpc::ServerContext* context, const ::rc::RicControlGrpcReq* request,
                                                 ::rc::RicControlGrpcRsp* response) override {
@@ -57,8 +164,119 @@ class ControlServiceImpl : public rc::MsgComm::Service {
     }
 };
 
+/*
+    One control request served asynchronously. A call first waits for a
+    request, then (when a delay is configured) for an alarm, and ends when
+    the response was sent; each step is an event of the completion queue
+    with the call as tag.
+*/
+class ControlCall {
+    private:
+        enum class State { REQUESTED, DELAYED, FINISHED };
+
+        rc::MsgComm::AsyncService *service;
+        grpc::ServerCompletionQueue *cq;
+        grpc::ServerContext ctx;
+        rc::RicControlGrpcReq request;
+        rc::RicControlGrpcRsp response;
+        grpc::ServerAsyncResponseWriter<rc::RicControlGrpcRsp> responder;
+        grpc::Alarm alarm;
+        State state = State::REQUESTED;
+        clock_type::time_point received;
+
+        void respond( worker_ctx &w ) {
+            state = State::FINISHED;
+
+            if ( config.error_rate > 0 && uniform_real_distribution<double>( 0, 1 )( w.gen ) < config.error_rate ) {
+                errors.fetch_add( 1, memory_order_relaxed );
+                responder.FinishWithError( grpc::Status( grpc::StatusCode::UNAVAILABLE, "injected error" ), this );
+                return;
+            }
+
+            response.set_rspcode( 0 );
+            response.set_description( "ACK" );
+            responder.Finish( response, grpc::Status::OK, this );
+        }
+
+    public:
+        ControlCall( rc::MsgComm::AsyncService *service, grpc::ServerCompletionQueue *cq )
+            : service( service ), cq( cq ), responder( &ctx ) {
+            service->RequestSendRICControlReqServiceGrpc( &ctx, &request, &responder, cq, cq, this );
+        }
+
+        // an event that is not ok (server or queue shutting down, cancelled alarm, response not sent) ends the call
+        void proceed( bool ok, worker_ctx &w ) {
+            if ( !ok ) {
+                delete this;
+                return;
+            }
+
+            switch ( state ) {
+                case State::REQUESTED:
+                    new ControlCall( service, cq );     // next request
+                    received = clock_type::now();
+                    requests.fetch_add( 1, memory_order_relaxed );
+                    if ( !config.trace_file.empty() ) {
+                        int64_t wall_us = chrono::duration_cast<chrono::microseconds>( chrono::system_clock::now().time_since_epoch() ).count();
+                        w.trace.emplace_back( wall_us, request.riccontrolheaderdata().ueid().gnbueid().amfuengapid() );
+                    }
+
+                    if ( config.delay_ms > 0 || config.jitter_ms > 0 ) {
+                        int delay = config.delay_ms + ( config.jitter_ms > 0 ? uniform_int_distribution<int>( 0, config.jitter_ms )( w.gen ) : 0 );
+                        state = State::DELAYED;
+                        alarm.Set( cq, chrono::system_clock::now() + chrono::milliseconds( delay ), this );
+                    } else {
+                        respond( w );
+                    }
+                    break;
+
+                case State::DELAYED:
+                    respond( w );
+                    break;
+
+                case State::FINISHED:
+                    latency.add( chrono::duration_cast<chrono::microseconds>( clock_type::now() - received ).count() );
+                    delete this;
+                    break;
+            }
+        }
+};
+
+void serve_queue( rc::MsgComm::AsyncService *service, grpc::ServerCompletionQueue *cq, worker_ctx *w ) {
+    void *tag;
+    bool ok;
+
+    new ControlCall( service, cq );
+    while ( cq->Next( &tag, &ok ) ) {
+        static_cast<ControlCall *>( tag )->proceed( ok, *w );
+    }
+}
+
+// dumps the counters of each interval
+void report_stats( ) {
+    unsigned long last_requests = 0;
+    unsigned long last_errors = 0;
+
+    while ( true ) {
+        this_thread::sleep_for( chrono::seconds( config.stats_sec ) );
+
+        unsigned long req = requests.load();
+        unsigned long err = errors.load();
+        vector<unsigned long> counts = latency.drain();
+
+        cout << "[RC] requests/s " << ( req - last_requests ) / (double) config.stats_sec
+             << ", errors/s " << ( err - last_errors ) / (double) config.stats_sec
+             << ", total " << req << ", latency us p50 " << LatencyHistogram::percentile( counts, 0.50 )
+             << " p99 " << LatencyHistogram::percentile( counts, 0.99 )
+             << " p99.9 " << LatencyHistogram::percentile( counts, 0.999 ) << endl;
+
+        last_requests = req;
+        last_errors = err;
+    }
+}
+
 void RunServer() {
-    string server_address("0.0.0.0:50051");
+    string server_address( config.address );
     ControlServiceImpl service;
 
     grpc::ServerBuilder builder;
@@ -71,8 +289,97 @@ void RunServer() {
     server->Wait();
 }
 
-int main(int argc, char const *argv[]) {
-    RunServer();
+void RunAsyncServer() {
+    rc::MsgComm::AsyncService service;
+    vector<unique_ptr<grpc::ServerCompletionQueue>> queues;
+
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort( config.address, grpc::InsecureServerCredentials() );
+    builder.RegisterService( &service );
+    for ( int i = 0; i < config.nthreads; i++ ) {
+        queues.emplace_back( builder.AddCompletionQueue() );
+    }
+
+    unique_ptr<grpc::Server> server( builder.BuildAndStart() );
+
+    cout << "[RC] Async server listening on " << config.address << ", threads " << config.nthreads << ", delay " << config.delay_ms
+         << " ms, jitter " << config.jitter_ms << " ms, error rate " << config.error_rate << endl;
+
+    signal( SIGINT, on_signal );
+    signal( SIGTERM, on_signal );
+    thread( report_stats ).detach();
+
+    vector<worker_ctx> contexts( queues.size() );
+    vector<thread> workers;
+    for ( size_t i = 0; i < queues.size(); i++ ) {
+        workers.emplace_back( serve_queue, &service, queues[i].get(), &contexts[i] );
+    }
+
+    while ( !stopping ) {
+        this_thread::sleep_for( chrono::milliseconds( 200 ) );
+    }
+
+    // pending calls are cancelled, then the queues drain
+    server->Shutdown( chrono::system_clock::now() + chrono::seconds( 1 ) );
+    for ( auto &cq : queues ) {
+        cq->Shutdown();
+    }
+    for ( auto &w : workers ) {
+        w.join();
+    }
+
+    cout << "[RC] total requests " << requests.load() << ", errors " << errors.load() << endl;
+    if ( !config.trace_file.empty() ) {
+        ofstream out( config.trace_file );
+        for ( auto &ctx : contexts ) {
+            for ( auto &t : ctx.trace ) {
+                out << t.first << " " << t.second << "\n";
+            }
+        }
+    }
+}
+
+void usage( const char *prog ) {
+    cout << "usage: " << prog << " [-a] [-t threads] [-d delay-ms] [-j jitter-ms] [-e error-rate] [-s stats-sec] [-l address] [-o trace-file]\n"
+         << "  -a  asynchronous server without per-request logging\n"
+         << "  -t  threads serving requests (default 2)\n"
+         << "  -d  delay before answering, in ms\n"
+         << "  -j  delay jitter, uniform in [0, jitter] ms\n"
+         << "  -e  share of requests answered with UNAVAILABLE, from 0 to 1\n"
+         << "  -s  seconds between stats dumps (default 5)\n"
+         << "  -l  listening address (default 0.0.0.0:50051)\n"
+         << "  -o  with -a, on exit write the wall clock arrival time (us) and UE of each request to a file" << endl;
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+
+    while ( ( opt = getopt( argc, argv, "at:d:j:e:s:l:o:h" ) ) != -1 ) {
+        switch ( opt ) {
+            case 'a': config.async = true; break;
+            case 't': config.nthreads = atoi( optarg ); break;
+            case 'd': config.delay_ms = atoi( optarg ); break;
+            case 'j': config.jitter_ms = atoi( optarg ); break;
+            case 'e': config.error_rate = atof( optarg ); break;
+            case 's': config.stats_sec = atoi( optarg ); break;
+            case 'l': config.address = optarg; break;
+            case 'o': config.trace_file = optarg; break;
+            default:
+                usage( argv[0] );
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if ( config.nthreads < 1 || config.delay_ms < 0 || config.jitter_ms < 0 || config.error_rate < 0 || config.error_rate > 1 || config.stats_sec < 1 ) {
+        usage( argv[0] );
+        return 1;
+    }
+
+    if ( config.async ) {
+        RunAsyncServer();
+    } else {
+        RunServer();
+    }
 
     return 0;
 }
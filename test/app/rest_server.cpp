@@ -0,0 +1,590 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+	Copyright (c) 2021 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+	Mnemonic:	rest_server.cpp
+	Abstract:   Multi-threaded HTTP/1.1 stand-in for the REST control endpoint
+                of the TS xApp, replacing echo-server.py in load tests. POST
+                requests are echoed back, after an optional delay and with a
+                status drawn from a configurable mix. Connections are kept
+                alive. GET /stats returns the counters.
+
+                Each thread runs its own epoll loop on its own listening socket
+                (SO_REUSEPORT), so the kernel spreads connections over threads.
+                Delayed responses wait in a timer queue of the thread, they
+                never block it; responses on a connection leave in request
+                order.
+
+	Date:		18 Oct 2026
+*/
+
+#include <iostream>
+#include <unistd.h>
+#include <string.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+typedef chrono::steady_clock clock_type;
+
+struct status_share {
+    int status;
+    int weight;
+};
+
+struct server_config {
+    int port = 5000;
+    int nthreads = 4;
+    int delay_ms = 0;
+    int jitter_ms = 0;          // on top of delay, uniform in [0, jitter]
+    vector<status_share> mix { { 200, 100 } };
+    int stats_sec = 5;
+    bool verbose = false;
+    string trace_file;          // arrival time and UE of each request, written on exit
+};
+
+server_config config;
+
+volatile sig_atomic_t stopping = 0;
+
+void on_signal( int ) {
+    stopping = 1;
+}
+
+// counters shared by all threads
+atomic<unsigned long> connections( 0 );
+atomic<unsigned long> requests( 0 );
+atomic<unsigned long> bad_requests( 0 );
+atomic<unsigned long> bytes_in( 0 );
+atomic<unsigned long> bytes_out( 0 );
+map<int, atomic<unsigned long>> status_counts;     // keys fixed before threads start
+
+const char *reason( int status ) {
+    switch ( status ) {
+        case 100: return "Continue";
+        case 200: return "OK";
+        case 201: return "Created";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 429: return "Too Many Requests";
+        case 500: return "Internal Server Error";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        default: return "Status";
+    }
+}
+
+string stats_json( ) {
+    ostringstream os;
+
+    os << "{\"connections\": " << connections.load() << ", \"requests\": " << requests.load()
+       << ", \"badRequests\": " << bad_requests.load() << ", \"bytesIn\": " << bytes_in.load()
+       << ", \"bytesOut\": " << bytes_out.load() << ", \"status\": {";
+    for ( auto it = status_counts.begin(); it != status_counts.end(); it++ ) {
+        os << ( it == status_counts.begin() ? "" : ", " ) << "\"" << it->first << "\": " << it->second.load();
+    }
+    os << "}}";
+
+    return os.str();
+}
+
+string http_response( int status, const string &body, bool keep_alive ) {
+    string rsp = "HTTP/1.1 " + to_string( status ) + " " + reason( status ) + "\r\n"
+                 "Content-Type: application/json\r\n"
+                 "Content-Length: " + to_string( body.size() ) + "\r\n" +
+                 ( keep_alive ? "" : "Connection: close\r\n" ) + "\r\n";
+    return rsp + body;
+}
+
+// case insensitive value of a header, empty when absent
+string header_value( const string &headers, const char *name ) {
+    size_t nlen = strlen( name );
+    size_t pos = 0;
+
+    while ( ( pos = headers.find( "\r\n", pos ) ) != string::npos ) {
+        pos += 2;
+        if ( strncasecmp( headers.c_str() + pos, name, nlen ) == 0 && headers[pos + nlen] == ':' ) {
+            size_t start = headers.find_first_not_of( " \t", pos + nlen + 1 );
+            size_t end = headers.find( "\r\n", pos );
+            return start < end ? headers.substr( start, end - start ) : "";
+        }
+    }
+
+    return "";
+}
+
+class Worker {
+    private:
+        struct response {
+            clock_type::time_point due;
+            string data;
+            bool close;         // after this response
+        };
+
+        struct connection {
+            int fd;
+            unsigned long id;
+            string in;
+            string out;
+            deque<response> pending;
+            bool continue_sent = false;
+            bool closing = false;
+        };
+
+        int listen_fd = -1;
+        int epfd = -1;
+        unsigned long next_id = 0;
+        unordered_map<int, connection> conns;
+        multimap<clock_type::time_point, pair<int, unsigned long>> timers;    // due -> fd, connection id
+        mt19937 gen;
+
+        void record( const string &body ) {
+            // the TS control request carries the UE as "ue" : "id"
+            size_t key = body.find( "\"ue\"" );
+            size_t start = key == string::npos ? key : body.find( '"', body.find( ':', key ) );
+            size_t end = start == string::npos ? start : body.find( '"', start + 1 );
+            if ( end == string::npos ) {
+                return;
+            }
+            int64_t wall_us = chrono::duration_cast<chrono::microseconds>( chrono::system_clock::now().time_since_epoch() ).count();
+            trace.emplace_back( wall_us, body.substr( start + 1, end - start - 1 ) );
+        }
+
+        int draw_status( ) {
+            int total = 0;
+            for ( auto &s : config.mix ) {
+                total += s.weight;
+            }
+            int r = uniform_int_distribution<int>( 0, total - 1 )( gen );
+            for ( auto &s : config.mix ) {
+                if ( r < s.weight ) {
+                    return s.status;
+                }
+                r -= s.weight;
+            }
+            return config.mix.back().status;
+        }
+
+        int draw_delay_ms( ) {
+            return config.delay_ms + ( config.jitter_ms > 0 ? uniform_int_distribution<int>( 0, config.jitter_ms )( gen ) : 0 );
+        }
+
+        void close_conn( connection &c ) {
+            epoll_ctl( epfd, EPOLL_CTL_DEL, c.fd, NULL );
+            close( c.fd );
+            conns.erase( c.fd );
+        }
+
+        void want_write( connection &c, bool on ) {
+            struct epoll_event ev = {};
+            ev.events = EPOLLIN | ( on ? EPOLLOUT : 0 );
+            ev.data.fd = c.fd;
+            epoll_ctl( epfd, EPOLL_CTL_MOD, c.fd, &ev );
+        }
+
+        // returns false when the connection was closed
+        bool flush( connection &c ) {
+            auto now = clock_type::now();
+            while ( !c.pending.empty() && c.pending.front().due <= now ) {
+                c.out += c.pending.front().data;
+                c.closing = c.closing || c.pending.front().close;
+                c.pending.pop_front();
+            }
+
+            while ( !c.out.empty() ) {
+                ssize_t n = send( c.fd, c.out.data(), c.out.size(), MSG_NOSIGNAL );
+                if ( n < 0 ) {
+                    if ( errno == EAGAIN || errno == EWOULDBLOCK ) {
+                        want_write( c, true );
+                        return true;
+                    }
+                    close_conn( c );
+                    return false;
+                }
+                bytes_out.fetch_add( n, memory_order_relaxed );
+                c.out.erase( 0, n );
+            }
+            want_write( c, false );
+
+            if ( c.closing && c.pending.empty() ) {
+                close_conn( c );
+                return false;
+            }
+            if ( !c.pending.empty() ) {
+                timers.emplace( c.pending.front().due, make_pair( c.fd, c.id ) );
+            }
+            return true;
+        }
+
+        /*
+            Handles the complete requests in the input buffer; returns false
+            when the connection has to be closed right away.
+        */
+        bool handle_requests( connection &c ) {
+            while ( !c.closing ) {
+                size_t hdr_end = c.in.find( "\r\n\r\n" );
+                if ( hdr_end == string::npos ) {
+                    return c.in.size() < 64 * 1024;
+                }
+
+                string headers = c.in.substr( 0, hdr_end + 2 );
+                size_t sp1 = headers.find( ' ' );
+                size_t sp2 = headers.find( ' ', sp1 + 1 );
+                size_t eol = headers.find( "\r\n" );
+                if ( sp1 == string::npos || sp2 == string::npos || sp2 > eol ) {
+                    bad_requests++;
+                    c.out += http_response( 400, "{\"error\": \"bad request line\"}", false );
+                    c.closing = true;
+                    break;
+                }
+
+                string method = headers.substr( 0, sp1 );
+                string path = headers.substr( sp1 + 1, sp2 - sp1 - 1 );
+                string version = headers.substr( sp2 + 1, eol - sp2 - 1 );
+                string conn_hdr = header_value( headers, "Connection" );
+                bool keep_alive = ( version == "HTTP/1.1" ) ? strcasecmp( conn_hdr.c_str(), "close" ) != 0
+                                                             : strcasecmp( conn_hdr.c_str(), "keep-alive" ) == 0;
+
+                if ( !header_value( headers, "Transfer-Encoding" ).empty() ) {      // the TS client always sends a length
+                    bad_requests++;
+                    c.out += http_response( 400, "{\"error\": \"chunked bodies are not supported\"}", false );
+                    c.closing = true;
+                    break;
+                }
+
+                size_t body_len = strtoul( header_value( headers, "Content-Length" ).c_str(), NULL, 10 );
+                if ( c.in.size() < hdr_end + 4 + body_len ) {
+                    if ( !c.continue_sent && strcasecmp( header_value( headers, "Expect" ).c_str(), "100-continue" ) == 0 ) {
+                        c.out += "HTTP/1.1 100 Continue\r\n\r\n";
+                        c.continue_sent = true;
+                    }
+                    return hdr_end + 4 + body_len < 16 * 1024 * 1024;
+                }
+
+                string body = c.in.substr( hdr_end + 4, body_len );
+                c.in.erase( 0, hdr_end + 4 + body_len );
+                c.continue_sent = false;
+                requests.fetch_add( 1, memory_order_relaxed );
+
+                if ( config.verbose ) {
+                    cout << "[REST] " << method << " " << path << " " << body << endl;
+                }
+                if ( !config.trace_file.empty() && method == "POST" ) {
+                    record( body );
+                }
+
+                response rsp;
+                rsp.close = !keep_alive;
+                if ( method == "GET" && path == "/stats" ) {
+                    rsp.due = clock_type::now();
+                    rsp.data = http_response( 200, stats_json(), keep_alive );
+                } else if ( method != "POST" ) {
+                    status_counts.at( 404 )++;
+                    rsp.due = clock_type::now();
+                    rsp.data = http_response( 404, "{\"error\": \"not found\"}", keep_alive );
+                } else {
+                    int status = draw_status();
+                    status_counts.at( status )++;
+                    rsp.due = clock_type::now() + chrono::milliseconds( draw_delay_ms() );
+                    rsp.data = http_response( status, status < 300 ? body : "{\"error\": \"injected status\"}", keep_alive );
+                }
+
+                // responses leave in request order, so a response is never due before the previous one
+                if ( !c.pending.empty() && rsp.due < c.pending.back().due ) {
+                    rsp.due = c.pending.back().due;
+                }
+                c.pending.push_back( move( rsp ) );
+                c.closing = !keep_alive;
+            }
+
+            return true;
+        }
+
+        void accept_all( ) {
+            while ( true ) {
+                int fd = accept4( listen_fd, NULL, NULL, SOCK_NONBLOCK );
+                if ( fd < 0 ) {
+                    return;
+                }
+
+                int one = 1;
+                setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof( one ) );
+
+                struct epoll_event ev = {};
+                ev.events = EPOLLIN;
+                ev.data.fd = fd;
+                epoll_ctl( epfd, EPOLL_CTL_ADD, fd, &ev );
+
+                connection &c = conns[fd];
+                c = connection();
+                c.fd = fd;
+                c.id = next_id++;
+                connections.fetch_add( 1, memory_order_relaxed );
+            }
+        }
+
+        void on_readable( connection &c ) {
+            char buf[16384];
+
+            while ( true ) {
+                ssize_t n = recv( c.fd, buf, sizeof( buf ), 0 );
+                if ( n > 0 ) {
+                    bytes_in.fetch_add( n, memory_order_relaxed );
+                    c.in.append( buf, n );
+                    continue;
+                }
+                if ( n < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK ) ) {
+                    break;
+                }
+                close_conn( c );        // peer closed or error
+                return;
+            }
+
+            if ( !handle_requests( c ) ) {
+                close_conn( c );
+                return;
+            }
+            flush( c );
+        }
+
+        void run_timers( ) {
+            auto now = clock_type::now();
+
+            while ( !timers.empty() && timers.begin()->first <= now ) {
+                int fd = timers.begin()->second.first;
+                unsigned long id = timers.begin()->second.second;
+                timers.erase( timers.begin() );
+
+                auto it = conns.find( fd );
+                if ( it != conns.end() && it->second.id == id ) {   // not a reused descriptor
+                    flush( it->second );
+                }
+            }
+        }
+
+        int next_timeout_ms( ) {
+            if ( timers.empty() ) {
+                return 1000;
+            }
+            auto wait = chrono::duration_cast<chrono::milliseconds>( timers.begin()->first - clock_type::now() ).count();
+            return (int) max<long long>( 0, min<long long>( wait + 1, 1000 ) );
+        }
+
+    public:
+        vector<pair<int64_t, string>> trace;
+
+        Worker( ) : gen( random_device{}() ) { }
+
+        bool listen_on( int port ) {
+            listen_fd = socket( AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0 );
+            if ( listen_fd < 0 ) {
+                return false;
+            }
+
+            int one = 1;
+            setsockopt( listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof( one ) );
+            setsockopt( listen_fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof( one ) );
+
+            struct sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl( INADDR_ANY );
+            addr.sin_port = htons( port );
+            if ( ::bind( listen_fd, (struct sockaddr *) &addr, sizeof( addr ) ) < 0 || listen( listen_fd, 1024 ) < 0 ) {
+                return false;
+            }
+
+            epfd = epoll_create1( 0 );
+            struct epoll_event ev = {};
+            ev.events = EPOLLIN;
+            ev.data.fd = listen_fd;
+            return epfd >= 0 && epoll_ctl( epfd, EPOLL_CTL_ADD, listen_fd, &ev ) == 0;
+        }
+
+        void run( ) {
+            struct epoll_event events[256];
+
+            while ( !stopping ) {
+                int n = epoll_wait( epfd, events, 256, next_timeout_ms() );
+
+                for ( int i = 0; i < n; i++ ) {
+                    int fd = events[i].data.fd;
+                    if ( fd == listen_fd ) {
+                        accept_all();
+                        continue;
+                    }
+
+                    auto it = conns.find( fd );
+                    if ( it == conns.end() ) {
+                        continue;
+                    }
+                    if ( events[i].events & ( EPOLLERR | EPOLLHUP ) ) {
+                        close_conn( it->second );
+                        continue;
+                    }
+                    if ( events[i].events & EPOLLIN ) {
+                        on_readable( it->second );
+                        it = conns.find( fd );
+                    }
+                    if ( it != conns.end() && ( events[i].events & EPOLLOUT ) ) {
+                        flush( it->second );
+                    }
+                }
+
+                run_timers();
+            }
+        }
+};
+
+void report_stats( ) {
+    unsigned long last = 0;
+
+    while ( true ) {
+        this_thread::sleep_for( chrono::seconds( config.stats_sec ) );
+
+        unsigned long req = requests.load();
+        cout << "[REST] requests/s " << ( req - last ) / (double) config.stats_sec << ", " << stats_json() << endl;
+        last = req;
+    }
+}
+
+// e.g. "200:95,500:4,503:1"
+bool parse_mix( const string &spec, vector<status_share> &mix ) {
+    istringstream is( spec );
+    string item;
+
+    mix.clear();
+    while ( getline( is, item, ',' ) ) {
+        status_share s;
+        if ( sscanf( item.c_str(), "%d:%d", &s.status, &s.weight ) != 2 || s.status < 200 || s.status > 599 || s.weight < 0 ) {
+            return false;
+        }
+        mix.push_back( s );
+    }
+
+    int total = 0;
+    for ( auto &s : mix ) {
+        total += s.weight;
+    }
+    return total > 0;
+}
+
+void usage( const char *prog ) {
+    cout << "usage: " << prog << " [-p port] [-t threads] [-d delay-ms] [-j jitter-ms] [-m status-mix] [-s stats-sec] [-v] [-o trace-file]\n"
+         << "  -p  listening port (default 5000)\n"
+         << "  -t  threads (default 4)\n"
+         << "  -d  delay before answering, in ms\n"
+         << "  -j  delay jitter, uniform in [0, jitter] ms\n"
+         << "  -m  response status weights, e.g. 200:95,500:4,503:1 (default 200:100)\n"
+         << "  -s  seconds between stats dumps (default 5)\n"
+         << "  -v  log every request\n"
+         << "  -o  on exit, write the wall clock arrival time (us) and UE of each request to a file" << endl;
+}
+
+int main( int argc, char *argv[] ) {
+    int opt;
+
+    while ( ( opt = getopt( argc, argv, "p:t:d:j:m:s:vo:h" ) ) != -1 ) {
+        switch ( opt ) {
+            case 'p': config.port = atoi( optarg ); break;
+            case 't': config.nthreads = atoi( optarg ); break;
+            case 'd': config.delay_ms = atoi( optarg ); break;
+            case 'j': config.jitter_ms = atoi( optarg ); break;
+            case 'm':
+                if ( !parse_mix( optarg, config.mix ) ) {
+                    usage( argv[0] );
+                    return 1;
+                }
+                break;
+            case 's': config.stats_sec = atoi( optarg ); break;
+            case 'v': config.verbose = true; break;
+            case 'o': config.trace_file = optarg; break;
+            default:
+                usage( argv[0] );
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if ( config.nthreads < 1 || config.delay_ms < 0 || config.jitter_ms < 0 || config.stats_sec < 1 ) {
+        usage( argv[0] );
+        return 1;
+    }
+
+    status_counts[404];
+    for ( auto &s : config.mix ) {
+        status_counts[s.status];
+    }
+
+    vector<unique_ptr<Worker>> workers;
+    for ( int i = 0; i < config.nthreads; i++ ) {
+        workers.emplace_back( new Worker() );
+        if ( !workers.back()->listen_on( config.port ) ) {
+            cout << "[ERROR] unable to listen on port " << config.port << ": " << strerror( errno ) << endl;
+            return 1;
+        }
+    }
+
+    cout << "[REST] listening on port " << config.port << ", threads " << config.nthreads << ", delay " << config.delay_ms
+         << " ms, jitter " << config.jitter_ms << " ms" << endl;
+
+    signal( SIGINT, on_signal );
+    signal( SIGTERM, on_signal );
+    thread( report_stats ).detach();
+
+    vector<thread> threads;
+    for ( auto &w : workers ) {
+        threads.emplace_back( &Worker::run, w.get() );
+    }
+    for ( auto &t : threads ) {
+        t.join();
+    }
+
+    cout << "[REST] " << stats_json() << endl;
+    if ( !config.trace_file.empty() ) {
+        ofstream out( config.trace_file );
+        for ( auto &w : workers ) {
+            for ( auto &t : w->trace ) {
+                out << t.first << " " << t.second << "\n";
+            }
+        }
+    }
+
+    return 0;
+}
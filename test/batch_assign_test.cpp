@@ -0,0 +1,154 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	batch_assign_test.cpp
+    Abstract:	Tests the joint assignment of UEs to target cells, and the
+                batches collected by the batch assigner. Included by
+                unit_test.cpp.
+
+    Date:       18 Oct 2026
+*/
+
+static int solve_assignment_test( ) {
+    int errors = 0;
+    ts::assign_problem_t problem;
+    std::vector<int> assignment;
+
+    // two UEs want cell 0, which takes one: the one gaining the most gets it, the other falls back to cell 1
+    problem.reset( 3, 2 );
+    float rows[3][2] = { { 50, 40 }, { 60, 15 }, { 5, 8 } };
+    for( int u = 0; u < 3; u++ ) {
+        problem.row( u )[0] = rows[u][0];
+        problem.row( u )[1] = rows[u][1];
+        problem.serving[u] = 10;
+        problem.above[u] = 11;
+    }
+    problem.capacity = { 1, 1 };
+
+    errors += fail_not_equal( ts::solve_assignment( problem, 1, 4, assignment ), 2u, "handoffs" );
+    errors += fail_not_if( assignment == std::vector<int>( { 1, 0, -1 } ), "a full cell keeps the UE gaining the most" );
+
+    problem.capacity = { 1, 0 };
+    ts::solve_assignment( problem, 1, 4, assignment );
+    errors += fail_not_if( assignment == std::vector<int>( { -1, 0, -1 } ), "cells without capacity take no UE" );
+
+    problem.capacity = { 1, 1 };
+    ts::solve_assignment( problem, 1, 1, assignment );
+    errors += fail_not_if( assignment == std::vector<int>( { -1, 0, -1 } ), "UEs only propose to their best candidates" );
+
+    // a large random problem, with a cell count that is not a whole number of blocks
+    const size_t UES = 5000;
+    const size_t CELLS = 37;
+    const int CANDIDATES = 4;
+    uint64_t state = 42;
+    auto next_rand = [&state]( float lo, float hi ) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return lo + ( hi - lo ) * ( ( state >> 40 ) / 16777216.0f );
+    };
+
+    problem.reset( UES, CELLS );
+    for( size_t u = 0; u < UES; u++ ) {
+        for( size_t c = 0; c < CELLS; c++ ) {
+            problem.row( u )[c] = next_rand( 0, 1 ) < 0.2f ? -1 : next_rand( 1000, 100000 );     // some cells are not predicted
+        }
+        problem.serving[u] = next_rand( 1000, 100000 );
+        problem.above[u] = problem.serving[u] * 1.1f;
+    }
+    for( size_t c = 0; c < CELLS; c++ ) {
+        problem.capacity[c] = 60;
+    }
+
+    size_t handoffs = ts::solve_assignment( problem, 1, CANDIDATES, assignment );
+    std::vector<int> parallel;
+    errors += fail_not_equal( ts::solve_assignment( problem, 4, CANDIDATES, parallel ), handoffs, "handoffs with several threads" );
+    errors += fail_not_if( parallel == assignment, "threads do not change the assignment" );
+    errors += fail_not_equal( handoffs, CELLS * 60, "every cell is filled in a large batch" );
+
+    std::vector<int> load( CELLS, 0 );
+    bool qualifies = true;
+    bool among_best = true;
+    for( size_t u = 0; u < UES; u++ ) {
+        int c = assignment[u];
+        if( c < 0 ) {
+            continue;
+        }
+        load[c]++;
+
+        const float *row = problem.row( u );
+        qualifies = qualifies && row[c] > problem.above[u];
+        int better = 0;
+        for( size_t o = 0; o < CELLS; o++ ) {
+            better += row[o] > row[c];
+        }
+        among_best = among_best && better < CANDIDATES;
+    }
+    errors += fail_not_if( *std::max_element( load.begin(), load.end() ) <= 60, "no cell takes more UEs than its capacity" );
+    errors += fail_not_if( qualifies, "UEs only go to cells beating their serving cell by the threshold" );
+    errors += fail_not_if( among_best, "UEs only go to one of their best cells" );
+
+    return errors;
+}
+
+static int batch_assigner_test( ) {
+    int errors = 0;
+    std::mutex mutex;
+    std::map<std::string, std::string> sent;
+    int sends = 0;
+
+    ts::batch_opts_t opts;
+    opts.window = std::chrono::milliseconds( 200 );
+    opts.cell_capacity = 1;
+    opts.threads = 1;
+    opts.stats_interval = std::chrono::seconds( 0 );
+
+    ts::batch_hooks_t hooks;
+    hooks.cell_open = []( const std::string &cell_id ) { return cell_id != "full"; };
+    hooks.send_control = [&]( const std::string &ue_id, const std::string &serving_cell_id, const std::string &target_cell_id ) {
+        std::lock_guard<std::mutex> lock( mutex );
+        sent[ue_id] = target_cell_id;
+        sends++;
+        return true;
+    };
+
+    {
+        ts::BatchAssigner assigner( opts, hooks );
+        assigner.add( "ue-1", "s", 10, 11, { { "s", 10 }, { "t1", 50 }, { "t2", 40 }, { "full", 90 } } );
+        assigner.add( "ue-2", "s", 10, 11, { { "s", 10 }, { "t1", 60 }, { "t2", 20 } } );
+        assigner.add( "ue-3", "s", 10, 11, { { "s", 10 }, { "t1", 30 }, { "t2", 12 } } );
+
+        errors += fail_not_if( wait_for( [&]{ std::lock_guard<std::mutex> lock( mutex ); return sent.size() == 2; } ),
+                               "the batch is solved once its window is over" );
+        ts::batch_stats_t stats = assigner.get_stats();
+        errors += fail_not_equal( stats.batches, 1u, "batches" );
+        errors += fail_not_equal( stats.ues, 3u, "UEs in batches" );
+        errors += fail_not_equal( stats.handoffs, 2u, "handoffs" );
+
+        // the latest prediction of a UE added twice to a batch is the one solved
+        assigner.add( "ue-4", "s", 10, 11, { { "s", 10 }, { "t3", 50 } } );
+        assigner.add( "ue-5", "s", 10, 11, { { "s", 10 }, { "t3", 40 } } );
+        assigner.add( "ue-4", "s", 10, 11, { { "s", 10 }, { "t4", 50 } } );
+    }       // the batch being collected is solved on destruction
+
+    errors += fail_not_if( sent == std::map<std::string, std::string>( { { "ue-1", "t2" }, { "ue-2", "t1" }, { "ue-4", "t4" }, { "ue-5", "t3" } } ),
+                           "closed cells are skipped and each cell takes its capacity" );
+    errors += fail_not_equal( sends, 4, "one control request per UE" );
+
+    return errors;
+}
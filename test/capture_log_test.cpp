@@ -0,0 +1,121 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	capture_log_test.cpp
+    Abstract:	Tests that messages written to a capture are read back as
+                they were, and that truncated captures are not misread.
+                Included by unit_test.cpp.
+
+    Date:       18 Oct 2026
+*/
+
+static int capture_log_test( ) {
+    int errors = 0;
+    std::string path = "/tmp/capture_log_test." + std::to_string( getpid() );
+    std::string error;
+
+    std::vector<std::pair<int, std::string>> sent = {
+        { 20010, "{\"policy_type_id\": 20008}" },
+        { 30003, "" },
+        { 30002, std::string( 70000, 'x' ) },
+        { 30003, std::string( "bin\0ary", 7 ) },
+    };
+
+    remove( path.c_str() );
+    {
+        ts::CaptureWriter writer( path );
+        errors += fail_not_if( writer.is_open(), "open a new capture" );
+        for( auto &msg : sent ) {
+            writer.append( msg.first, msg.second.data(), msg.second.size() );
+            std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+        }
+    }
+
+    ts::CaptureReader reader;
+    errors += fail_not_if( reader.open( path, error ), "open the capture" );
+
+    ts::capture_record_t record;
+    uint64_t first_ns = 0;
+    uint64_t last_ns = 0;
+    size_t read = 0;
+    bool same = true;
+    bool spaced = true;
+    while( reader.next( record ) ) {
+        if( read == 0 ) {
+            first_ns = record.timestamp_ns;
+        } else {
+            spaced = spaced && record.timestamp_ns - last_ns >= 2000000;
+        }
+        last_ns = record.timestamp_ns;
+
+        same = same && read < sent.size() && record.mtype == sent[read].first &&
+               std::string( record.payload, record.len ) == sent[read].second;
+        read++;
+    }
+    errors += fail_not_equal( read, sent.size(), "records read" );
+    errors += fail_not_if( same, "message types and payloads are read back" );
+    errors += fail_not_if( spaced && last_ns - first_ns < 10000000000ULL, "timestamps keep the spacing of the messages" );
+
+    reader.rewind();
+    errors += fail_not_if( reader.next( record ) && record.timestamp_ns == first_ns, "rewind goes back to the first record" );
+
+    // a capture cut in the last record, as when the xApp is killed: the complete records are read, not the cut one
+    FILE *f = fopen( path.c_str(), "rb" );
+    std::vector<char> bytes;
+    int c;
+    while( ( c = fgetc( f ) ) != EOF ) {
+        bytes.push_back( (char) c );
+    }
+    fclose( f );
+
+    auto write_file = [&path]( const std::vector<char> &bytes ) {
+        FILE *f = fopen( path.c_str(), "wb" );
+        fwrite( bytes.data(), 1, bytes.size(), f );
+        fclose( f );
+    };
+
+    write_file( std::vector<char>( bytes.begin(), bytes.end() - 3 ) );
+    errors += fail_not_if( reader.open( path, error ), "open a capture cut in its last payload" );
+    read = 0;
+    while( reader.next( record ) ) {
+        read++;
+    }
+    errors += fail_not_equal( read, sent.size() - 1, "records read before a cut payload" );
+
+    size_t last_record = bytes.size() - ts::CAPTURE_RECORD_HEADER_SIZE - sent.back().second.size();
+    write_file( std::vector<char>( bytes.begin(), bytes.begin() + last_record + 10 ) );
+    errors += fail_not_if( reader.open( path, error ), "open a capture cut in its last record header" );
+    read = 0;
+    while( reader.next( record ) ) {
+        read++;
+    }
+    errors += fail_not_equal( read, sent.size() - 1, "records read before a cut record header" );
+
+    write_file( std::vector<char>( bytes.begin(), bytes.begin() + 5 ) );
+    errors += fail_if( reader.open( path, error ), "a capture cut in its file header is rejected" );
+
+    write_file( std::vector<char>( 64, 'z' ) );
+    errors += fail_if( reader.open( path, error ), "a file that is not a capture is rejected" );
+
+    remove( path.c_str() );
+    errors += fail_if( reader.open( path, error ), "a missing capture is rejected" );
+
+    return errors;
+}
@@ -0,0 +1,64 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	cell_index_test.cpp
+    Abstract:	Tests the dense index of cell ids. Included by unit_test.cpp.
+
+    Date:       18 Oct 2026
+*/
+
+static int cell_index_test( ) {
+    int errors = 0;
+    ts::CellIndex index( 3 );
+
+    errors += fail_not_equal( index.find( "a" ), ts::NO_CELL, "unknown cells have no index" );
+    errors += fail_not_equal( index.intern( "a" ), 0, "the first cell" );
+    errors += fail_not_equal( index.intern( "b" ), 1, "the next cell" );
+    errors += fail_not_equal( index.intern( "a" ), 0, "a cell keeps its index" );
+    errors += fail_not_equal( index.find( "b" ), 1, "find an interned cell" );
+    errors += fail_not_equal( index.intern( "c" ), 2, "the last cell that fits" );
+    errors += fail_not_equal( index.intern( "d" ), ts::NO_CELL, "no index once full" );
+    errors += fail_not_equal( index.size(), 3u, "cells indexed" );
+
+    // cells interned by several threads at once get distinct, dense indices
+    ts::CellIndex shared;
+    std::vector<std::thread> threads;
+    std::vector<std::vector<int>> seen( 4 );
+    for( int t = 0; t < 4; t++ ) {
+        threads.emplace_back( [&shared, &seen, t]{
+            for( int i = 0; i < 500; i++ ) {
+                seen[t].push_back( shared.intern( "cell-" + std::to_string( ( i * ( t + 1 ) ) % 500 ) ) );
+            }
+        } );
+    }
+    for( std::thread &t : threads ) {
+        t.join();
+    }
+
+    std::set<int> indices;
+    for( int i = 0; i < 500; i++ ) {
+        indices.insert( shared.find( "cell-" + std::to_string( i ) ) );
+    }
+    errors += fail_not_equal( indices.size(), 500u, "one index per cell" );
+    errors += fail_not_if( *indices.begin() == 0 && *indices.rbegin() == 499, "indices are dense" );
+    errors += fail_not_equal( seen[2][7], shared.find( "cell-21" ), "every thread sees the same index" );
+
+    return errors;
+}
@@ -0,0 +1,109 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	handoff_budget_test.cpp
+    Abstract:	Tests the handoff decision kernel, the ranking of fallback
+                targets, and the handoff budget of target cells. Included
+                by unit_test.cpp.
+
+    Date:       18 Oct 2026
+*/
+
+static int handoff_decision_test( ) {
+    int errors = 0;
+    ts::handoff_decision_t decision;
+    std::unordered_map<std::string, int> throughput { { "serving", 100 }, { "a", 130 }, { "b", 108 }, { "c", 130 }, { "d", 90 } };
+
+    errors += fail_if( ts::decide_handoff( throughput, "unknown", 0, decision ), "no decision without a serving prediction" );
+
+    errors += fail_not_if( ts::decide_handoff( throughput, "serving", 10, decision ), "decide" );
+    errors += fail_not_if( decision.handoff, "a cell beats the serving one by more than the threshold" );
+    errors += fail_not_equal( decision.highest_throughput, 130, "highest throughput" );
+    errors += fail_not_equal( decision.handoff_above, 110.0f, "throughput a target must beat" );
+
+    std::vector<std::pair<std::string, int>> targets;
+    ts::rank_targets( throughput, decision, targets );
+    errors += fail_not_equal( targets.size(), 2u, "only cells over the threshold are targets" );
+    errors += fail_not_if( targets.size() == 2 && targets[0].first == "a" && targets[1].first == "c", "ties are ranked by cell id" );
+
+    ts::decide_handoff( throughput, "serving", 40, decision );
+    errors += fail_if( decision.handoff, "no cell beats the serving one by more than 40%" );
+    ts::rank_targets( throughput, decision, targets );
+    errors += fail_not_if( targets.empty(), "no target without a handoff" );
+
+    ts::decide_handoff( throughput, "serving", 0, decision );
+    ts::rank_targets( throughput, decision, targets );
+    errors += fail_not_equal( targets.size(), 3u, "without a threshold any better cell is a target" );
+
+    return errors;
+}
+
+static int handoff_budget_test( ) {
+    int errors = 0;
+
+    ts::budget_opts_t opts;
+    opts.handoffs = 2;
+    opts.interval = std::chrono::milliseconds( 400 );
+    opts.max_cells = 2;
+    opts.stats_interval = std::chrono::seconds( 0 );
+    ts::HandoffBudget budget( opts );
+
+    errors += fail_not_if( budget.admit( "a" ), "first handoff into a cell" );
+    errors += fail_not_if( budget.admit( "a" ), "second handoff into a cell" );
+    errors += fail_if( budget.admit( "a" ), "a cell over its budget refuses handoffs" );
+    errors += fail_not_if( budget.admit( "b" ), "cells have a budget of their own" );
+
+    std::this_thread::sleep_for( std::chrono::milliseconds( 250 ) );     // one token comes back every 200 ms
+    errors += fail_not_if( budget.admit( "a" ), "the budget refills over time" );
+    errors += fail_if( budget.admit( "a" ), "one token at a time" );
+
+    // the table holds 4 slots (twice the cells, rounded to a power of two); further cells are not limited
+    for( int i = 0; i < 10; i++ ) {
+        budget.admit( "cell-" + std::to_string( i ) );
+    }
+    ts::budget_stats_t stats = budget.get_stats();
+    errors += fail_not_if( stats.untracked > 0, "cells over the table size are admitted untracked" );
+
+    budget.count_fallback();
+    stats = budget.get_stats();
+    errors += fail_not_equal( stats.fallbacks, 1u, "fallbacks are counted" );
+    errors += fail_not_equal( stats.refused, 2u, "refusals are counted" );
+
+    // threads racing for the same cell get exactly its budget
+    opts.handoffs = 10;
+    opts.interval = std::chrono::seconds( 60 );
+    opts.max_cells = 16;
+    ts::HandoffBudget shared( opts );
+    std::atomic<int> admitted { 0 };
+    std::vector<std::thread> threads;
+    for( int t = 0; t < 4; t++ ) {
+        threads.emplace_back( [&]{
+            for( int i = 0; i < 1000; i++ ) {
+                admitted += shared.admit( "hot" );
+            }
+        } );
+    }
+    for( std::thread &t : threads ) {
+        t.join();
+    }
+    errors += fail_not_equal( admitted.load(), 10, "concurrent handoffs into one cell stay within its budget" );
+
+    return errors;
+}
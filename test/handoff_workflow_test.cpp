@@ -0,0 +1,102 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	handoff_workflow_test.cpp
+    Abstract:	Tests the handoff workflow engine: decisions, merged
+                anomalies, prediction and control timeouts, and answers
+                that come after their workflow gave up. Included by
+                unit_test.cpp when built with C++20 coroutines.
+
+    Date:       18 Oct 2026
+*/
+
+static ts::ue_prediction_t workflow_prediction( const std::string &ue_id, int serving, int neighbor ) {
+    ts::ue_prediction_t p;
+
+    p.ue_id = ue_id;
+    p.serving_cell_id = "A";
+    p.downlink = { { "A", serving }, { "B", neighbor } };
+
+    return p;
+}
+
+static int handoff_workflow_test( ) {
+    int errors = 0;
+    std::mutex mutex;
+    std::set<std::string> requested;
+
+    ts::workflow_hooks_t hooks;
+    hooks.request_predictions = [&]( const std::vector<std::string> &ue_ids ) {
+        std::lock_guard<std::mutex> lock( mutex );
+        requested.insert( ue_ids.begin(), ue_ids.end() );
+    };
+    hooks.choose_target = []( const ts::ue_prediction_t &p, std::string &target ) {
+        target = "B";
+        return p.downlink.at( "B" ) > p.downlink.at( "A" );
+    };
+    hooks.send_control = []( const std::string &ue_id, const std::string &, const std::string & ) {
+        if( ue_id == "slow" ) {
+            std::this_thread::sleep_for( std::chrono::milliseconds( 300 ) );     // answers after the control timeout
+        }
+        return ue_id != "fail";
+    };
+
+    ts::workflow_opts_t opts;
+    opts.prediction_timeout = std::chrono::milliseconds( 200 );
+    opts.control_timeout = std::chrono::milliseconds( 100 );
+    opts.control_workers = 2;
+    opts.stats_interval = std::chrono::seconds( 0 );
+
+    ts::HandoffEngine engine( opts, hooks );
+
+    engine.start( { "keep", "move", "fail", "slow", "silent" } );
+    engine.start( { "move" } );
+    errors += fail_not_if( wait_for( [&]{ std::lock_guard<std::mutex> lock( mutex ); return requested.size() == 5; } ),
+                           "a prediction is requested for each new workflow" );
+
+    engine.on_prediction( workflow_prediction( "keep", 10, 5 ) );
+    engine.on_prediction( workflow_prediction( "move", 10, 20 ) );
+    engine.on_prediction( workflow_prediction( "fail", 10, 20 ) );
+    engine.on_prediction( workflow_prediction( "slow", 10, 20 ) );
+    engine.on_prediction( workflow_prediction( "nobody", 10, 20 ) );
+    engine.start_predicted( workflow_prediction( "cached", 10, 20 ) );
+
+    errors += fail_not_if( wait_for( [&]{ return engine.get_stats().active == 0; } ), "all workflows end" );
+    engine.on_prediction( workflow_prediction( "silent", 10, 20 ) );      // after its workflow timed out
+    errors += fail_not_if( wait_for( [&]{ return engine.get_stats().unmatched == 2; } ), "late predictions are not matched" );
+
+    ts::workflow_stats_t stats = engine.get_stats();
+    errors += fail_not_equal( stats.started, 6u, "started workflows" );
+    errors += fail_not_equal( stats.merged, 1u, "anomalies merged into a running workflow" );
+    errors += fail_not_equal( stats.kept, 1u, "UEs kept in their cell" );
+    errors += fail_not_equal( stats.handoffs, 2u, "acknowledged handoffs" );
+    errors += fail_not_equal( stats.control_failures, 1u, "failed control requests" );
+    errors += fail_not_equal( stats.control_timeouts, 1u, "control requests timed out" );
+    errors += fail_not_equal( stats.prediction_timeouts, 1u, "predictions timed out" );
+
+    // the late control answer of slow must not wake a newer workflow of the same UE
+    engine.start( { "slow" } );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 300 ) );
+    stats = engine.get_stats();
+    errors += fail_not_equal( stats.handoffs, 2u, "a late control answer is dropped" );
+    errors += fail_not_equal( stats.prediction_timeouts, 2u, "the new workflow waits for its own prediction" );
+
+    return errors;
+}
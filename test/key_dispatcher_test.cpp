@@ -0,0 +1,61 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	key_dispatcher_test.cpp
+    Abstract:	Tests the compile-time JSON key table of the SAX handlers.
+                Included by unit_test.cpp.
+
+    Date:       18 Oct 2026
+*/
+
+static int key_dispatcher_test( ) {
+    int errors = 0;
+
+    static constexpr ts::KeyDispatcher keys { "operation", "policy_type_id", "policy_instance_id", "threshold",
+                                              "cell_ids", "cell_id", "slice_id" };
+
+    const char *names[] = { "operation", "policy_type_id", "policy_instance_id", "threshold", "cell_ids", "cell_id", "slice_id" };
+    for( int i = 0; i < 7; i++ ) {
+        errors += fail_not_equal( keys.find( names[i], strlen( names[i] ) ), i + 1, names[i] );
+    }
+
+    errors += fail_not_equal( keys.find( "cell", 4 ), 0, "prefixes of keys are unknown" );
+    errors += fail_not_equal( keys.find( "cell_idsx", 9 ), 0, "keys with a suffix are unknown" );
+    errors += fail_not_equal( keys.find( "", 0 ), 0, "the empty key is unknown" );
+    errors += fail_not_equal( keys.find( "Threshold", 9 ), 0, "keys are case sensitive" );
+
+    // keys come from the payload and are not nil terminated
+    const char payload[] = "cell_ids\"]";
+    errors += fail_not_equal( keys.find( payload, 7 ), 6, "keys are matched on their length" );
+
+    // a single key, and many keys colliding in a small table
+    static constexpr ts::KeyDispatcher one { "UEID" };
+    errors += fail_not_equal( one.find( "UEID", 4 ), 1, "single key" );
+    errors += fail_not_equal( one.find( "UEI", 3 ), 0, "single key, unknown" );
+
+    static constexpr ts::KeyDispatcher many { "a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l", "m", "n", "o", "p" };
+    const char *letters = "abcdefghijklmnop";
+    for( int i = 0; i < 16; i++ ) {
+        errors += fail_not_equal( many.find( letters + i, 1 ), i + 1, "one of many keys" );
+    }
+    errors += fail_not_equal( many.find( "q", 1 ), 0, "none of many keys" );
+
+    return errors;
+}
@@ -0,0 +1,74 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	load_shedder_test.cpp
+    Abstract:	Tests the age and backlog based shedding of anomalies.
+                Included by unit_test.cpp.
+
+    Date:       18 Oct 2026
+*/
+
+// share of n anomalies of the given age admitted at a backlog
+static double admitted_share( ts::LoadShedder &shedder, int64_t age_ms, double backlog, int n = 20000 ) {
+    const int64_t now = 1000000;
+    int admitted = 0;
+
+    for( int i = 0; i < n; i++ ) {
+        admitted += shedder.admit( now - age_ms, now, backlog );
+    }
+
+    return (double) admitted / n;
+}
+
+static int load_shedder_test( ) {
+    int errors = 0;
+
+    ts::shed_opts_t opts;
+    opts.max_age_ms = 1000;
+    opts.shed_start = 0.5;
+    opts.stats_interval_ms = 0;
+    ts::LoadShedder shedder( opts );
+
+    errors += fail_if( shedder.admit( 1000000 - 2000, 1000000, 0 ), "stale anomalies are dropped" );
+    errors += fail_not_if( shedder.admit( 0, 1000000, 0 ), "anomalies without a timestamp are kept" );
+    errors += fail_not_if( shedder.admit( 1000000 + 50, 1000000, 0 ), "anomalies ahead of the clock are kept" );
+
+    errors += fail_not_equal( admitted_share( shedder, 10, 0.4 ), 1.0, "nothing is shed under the backlog threshold" );
+    errors += fail_not_equal( admitted_share( shedder, 10, 1.0 ), 0.0, "everything is shed with a full queue" );
+
+    // at 75% the backlog share is one half; fresh anomalies are shed at that rate, old ones more often
+    double fresh = admitted_share( shedder, 0, 0.75 );
+    double old = admitted_share( shedder, 990, 0.75 );
+    errors += fail_if( fresh < 0.45 || fresh > 0.55, "fresh anomalies are shed at the backlog share" );
+    errors += fail_if( old < 0.2 || old > 0.3, "the oldest anomalies are shed at one and a half times the backlog share" );
+
+    ts::shed_stats_t stats = shedder.get_stats();
+    errors += fail_not_equal( stats.stale, 1u, "stale anomalies are counted" );
+    errors += fail_not_equal( stats.admitted + stats.stale + stats.shed, 80003u, "every anomaly is counted once" );
+
+    // without a maximum age, the age does not matter
+    opts.max_age_ms = 0;
+    ts::LoadShedder ageless( opts );
+    double recent = admitted_share( ageless, 0, 0.75 );
+    double ancient = admitted_share( ageless, 100000, 0.75 );
+    errors += fail_if( recent < 0.45 || recent > 0.55 || ancient < 0.45 || ancient > 0.55, "all ages weigh the same without a maximum age" );
+
+    return errors;
+}
@@ -0,0 +1,107 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	loopback_transport_test.cpp
+    Abstract:	Tests the in-process transport: routing, replies, the bounds
+                of its queue, and several producers and consumers sharing
+                it. Included by unit_test.cpp.
+
+    Date:       18 Oct 2026
+*/
+
+static int loopback_transport_test( ) {
+    int errors = 0;
+    ts::LoopbackBus bus;
+    ts::LoopbackTransport ad( bus, "ad", 4 );
+    ts::LoopbackTransport ts_app( bus, "ts", 4 );
+
+    bus.add_route( 30003, &ts_app );
+    bus.add_route( 30004, &ad );
+
+    std::vector<std::string> received;
+    ts_app.add_handler( 30003, [&]( int mtype, const char *payload, int len, ts::Replier &replier ) {
+        received.emplace_back( payload, len );
+        replier.reply( 30004, payload, len );
+    } );
+    std::vector<std::string> acks;
+    ad.add_handler( 30004, [&]( int mtype, const char *payload, int len, ts::Replier &replier ) {
+        acks.emplace_back( payload, len );
+    } );
+
+    errors += fail_not_if( ad.send( 30003, "one", 3 ), "send a routed message" );
+    errors += fail_not_if( ad.send( 30003, "two", 3 ), "send another one" );
+    errors += fail_if( ad.send( 99, "x", 1 ), "unrouted messages are not sent" );
+    errors += fail_not_equal( ts_app.pending(), 2u, "messages queued" );
+
+    errors += fail_not_equal( ts_app.poll( 1 ), 1u, "poll handles at most max messages" );
+    errors += fail_not_equal( ts_app.poll(), 1u, "poll handles the rest" );
+    errors += fail_not_if( received == std::vector<std::string>( { "one", "two" } ), "messages are handled in order" );
+    errors += fail_not_equal( ad.poll(), 2u, "replies go back to the sender" );
+    errors += fail_not_if( acks == received, "replies carry their payload" );
+    errors += fail_not_equal( ts_app.dispatched(), 2u, "dispatched messages" );
+
+    // the queue holds 4 messages
+    for( int i = 0; i < 4; i++ ) {
+        errors += fail_not_if( ad.send( 30003, "m", 1 ), "queue a message" );
+    }
+    errors += fail_if( ad.send( 30003, "m", 1 ), "a full queue refuses messages" );
+    errors += fail_not_equal( ts_app.refused(), 1u, "refused messages are counted" );
+    std::vector<char> big( ts::LOOPBACK_MAX_PAYLOAD + 1, 'x' );
+    ts_app.poll();
+    errors += fail_if( ad.send( 30003, big.data(), (int) big.size() ), "oversized payloads are refused" );
+    ad.poll();
+
+    // producers and consumers on several threads: every message is handled exactly once
+    ts::LoopbackTransport sink( bus, "sink", 64 );
+    bus.add_route( 1, &sink );
+    std::atomic<long> sum { 0 };
+    std::atomic<long> count { 0 };
+    sink.add_handler( 1, [&]( int mtype, const char *payload, int len, ts::Replier &replier ) {
+        int value;
+        memcpy( &value, payload, sizeof( value ) );
+        sum += value;
+        count++;
+    } );
+
+    std::thread consumers( [&]{ sink.run( 2 ); } );
+    const int PER_PRODUCER = 20000;
+    std::vector<std::thread> producers;
+    for( int p = 0; p < 3; p++ ) {
+        producers.emplace_back( [&, p]{
+            ts::LoopbackTransport source( bus, "source" + std::to_string( p ), 2 );
+            for( int i = 1; i <= PER_PRODUCER; i++ ) {
+                while( !source.send( 1, &i, sizeof( i ) ) ) {
+                    std::this_thread::yield();
+                }
+            }
+        } );
+    }
+    for( std::thread &t : producers ) {
+        t.join();
+    }
+    wait_for( [&]{ return count == 3 * PER_PRODUCER; } );
+    sink.stop();
+    consumers.join();
+
+    errors += fail_not_equal( count.load(), 3L * PER_PRODUCER, "every message is handled" );
+    errors += fail_not_equal( sum.load(), 3L * PER_PRODUCER * ( PER_PRODUCER + 1 ) / 2, "every message is handled once" );
+
+    return errors;
+}
@@ -0,0 +1,120 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	metrics_record_test.cpp
+    Abstract:	Tests the encoding and the in place decoding of the binary UE
+                and cell records, and that truncated or oversized records
+                are refused. Included by unit_test.cpp.
+
+    Date:       18 Oct 2026
+*/
+
+static int metrics_record_test( ) {
+    int errors = 0;
+    std::vector<uint8_t> buf;
+
+    ts::ue_record_t ue;
+    ue.serving_cell_id = "c2/B13";
+    ue.rsrp = -90;
+    ue.rsrq = -12.5;
+    ue.sinr = 7;
+    ue.prb_usage_dl = 40;
+    ue.prb_usage_ul = 20;
+    ue.pdcp_bytes_dl = 1ULL << 40;
+    ue.pdcp_bytes_ul = 12345;
+    ue.timestamp_ms = 1584498198210;
+    ue.neighbors.push_back( { "c1/B13", -100, -15, 3 } );
+    ue.neighbors.push_back( { "c3/B13", -110, -18, -2 } );
+
+    errors += fail_not_if( ts::encode_ue_record( ue, buf ), "encode a UE record" );
+    errors += fail_not_if( ts::is_binary_record( buf.data(), buf.size() ), "UE records are binary" );
+    errors += fail_not_equal( buf.size(), ts::UE_RECORD_FIXED_SIZE + 2 * ts::UE_RECORD_NEIGHBOR_SIZE + 18, "UE record size" );
+
+    ts::UeRecordView view( buf.data(), buf.size() );
+    errors += fail_not_if( view.valid(), "a complete UE record is valid" );
+    errors += fail_not_if( view.serving_cell_id() == "c2/B13", "serving cell id" );
+    errors += fail_not_if( view.rsrp() == -90 && view.rsrq() == -12.5 && view.sinr() == 7, "serving cell RF" );
+    errors += fail_not_if( view.prb_usage_dl() == 40 && view.prb_usage_ul() == 20, "PRB usage" );
+    errors += fail_not_if( view.pdcp_bytes_dl() == 1ULL << 40 && view.pdcp_bytes_ul() == 12345, "PDCP bytes" );
+    errors += fail_not_equal( view.timestamp_ms(), (int64_t) 1584498198210, "timestamp" );
+    errors += fail_not_equal( view.neighbor_count(), 2u, "neighbor count" );
+    errors += fail_not_if( view.neighbor_cell_id( 1 ) == "c3/B13" && view.neighbor_rsrp( 1 ) == -110 &&
+                           view.neighbor_rsrq( 1 ) == -18 && view.neighbor_sinr( 1 ) == -2, "neighbor fields" );
+
+    ts::ue_metrics_t metrics;
+    errors += fail_not_if( ts::parse_ue_metrics( (const char *) buf.data(), buf.size(), metrics ), "parse a binary UE record" );
+    errors += fail_not_if( metrics.serving_cell_id == "c2/B13" && metrics.neighbors.size() == 2 &&
+                           metrics.neighbors[0].cell_id == "c1/B13", "binary UE records are parsed like JSON" );
+
+    // truncated records: the fixed part, the neighbor entries, and the cell ids
+    errors += fail_if( ts::UeRecordView( buf.data(), 3 ).valid(), "a record cut before its kind is invalid" );
+    errors += fail_if( ts::UeRecordView( buf.data(), ts::UE_RECORD_FIXED_SIZE - 1 ).valid(), "a record cut in its fixed part is invalid" );
+    errors += fail_if( ts::UeRecordView( buf.data(), ts::UE_RECORD_FIXED_SIZE + ts::UE_RECORD_NEIGHBOR_SIZE ).valid(),
+                       "a record cut in its neighbors is invalid" );
+    errors += fail_if( ts::parse_ue_metrics( (const char *) buf.data(), ts::UE_RECORD_FIXED_SIZE + 4, metrics ),
+                       "a cut record is not parsed" );
+    ts::UeRecordView cut( buf.data(), buf.size() - 1 );
+    errors += fail_not_if( cut.neighbor_cell_id( 1 ).empty() && cut.serving_cell_id() == "c2/B13",
+                           "cell ids past the end of a cut record are empty" );
+
+    std::vector<uint8_t> other( buf );
+    other[3] = ts::RECORD_KIND_CELL;
+    errors += fail_if( ts::UeRecordView( other.data(), other.size() ).valid(), "a cell record is not a UE record" );
+
+    // ids are cut at 255 bytes
+    ue.serving_cell_id = std::string( 300, 'a' );
+    errors += fail_not_if( ts::encode_ue_record( ue, buf ), "encode a UE record with a long id" );
+    errors += fail_not_equal( ts::UeRecordView( buf.data(), buf.size() ).serving_cell_id().size(), 255u, "long ids are truncated" );
+    errors += fail_not_if( ts::UeRecordView( buf.data(), buf.size() ).neighbor_cell_id( 0 ) == "c1/B13", "ids after a truncated one" );
+
+    // records over 64 KiB would wrap their offsets
+    ue.serving_cell_id = "c2/B13";
+    ue.neighbors.assign( 2000, { std::string( 20, 'n' ), -100, -15, 3 } );       // 56 + 2000 * ( 16 + 20 ) bytes
+    errors += fail_if( ts::encode_ue_record( ue, buf ), "a UE record over 64 KiB is not encoded" );
+    errors += fail_not_equal( buf.size(), 0u, "nothing is left of a record that is not encoded" );
+
+    ue.neighbors.resize( 1800 );        // 56 + 6 + 1800 * 36 bytes, just below
+    errors += fail_not_if( ts::encode_ue_record( ue, buf ), "a UE record just below 64 KiB is encoded" );
+    ts::UeRecordView large( buf.data(), buf.size() );
+    errors += fail_not_if( large.valid() && large.neighbor_count() == 1800 && large.neighbor_cell_id( 1799 ) == std::string( 20, 'n' ),
+                           "the last neighbor of a large record" );
+
+    // cell records
+    ts::cell_record_t cell;
+    cell.avail_prb_dl = 30;
+    cell.avail_prb_ul = 50;
+    cell.pdcp_bytes_dl = 1000;
+    cell.pdcp_bytes_ul = 2000;
+    cell.timestamp_ms = 1584498198210;
+    ts::encode_cell_record( cell, buf );
+
+    ts::CellRecordView cell_view( buf.data(), buf.size() );
+    errors += fail_not_if( cell_view.valid(), "a complete cell record is valid" );
+    errors += fail_not_if( cell_view.avail_prb_dl() == 30 && cell_view.avail_prb_ul() == 50 && cell_view.pdcp_bytes_dl() == 1000 &&
+                           cell_view.pdcp_bytes_ul() == 2000 && cell_view.timestamp_ms() == 1584498198210, "cell fields" );
+    errors += fail_if( ts::CellRecordView( buf.data(), buf.size() - 1 ).valid(), "a cut cell record is invalid" );
+    errors += fail_if( ts::UeRecordView( buf.data(), buf.size() ).valid(), "a UE record is not a cell record" );
+
+    ts::cell_metrics_t cell_metrics;
+    errors += fail_not_if( ts::parse_cell_metrics( (const char *) buf.data(), buf.size(), cell_metrics ) &&
+                           cell_metrics.has_avail_prb_dl && cell_metrics.avail_prb_dl == 30, "parse a binary cell record" );
+
+    return errors;
+}
@@ -0,0 +1,93 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	neighbor_table_test.cpp
+    Abstract:	Tests the neighbor relation table built from the UE metrics
+                in SDL and the E2 setups. Included by unit_test.cpp.
+
+    Date:       18 Oct 2026
+*/
+
+static int neighbor_table_test( ) {
+    int errors = 0;
+
+    std::shared_ptr<ts::InMemorySdl> sdl = std::make_shared<ts::InMemorySdl>();
+    ts::ue_record_t ue;
+    ue.serving_cell_id = "a";
+    ue.neighbors.push_back( { "x", -90, -10, 5 } );
+    ts::sdl_data_t value;
+    ts::encode_ue_record( ue, value );
+    sdl->set( ts::SDL_UE_NAMESPACE, { { "ue-1", value } } );
+
+    ts::MetricsCache metrics( sdl, { "" }, std::chrono::milliseconds( 1000 ) );
+    metrics.refresh_prefix( "" );
+
+    ts::NeighborTable table( &metrics, std::chrono::milliseconds( 1000 ) );
+    table.add_e2_node( { "a", "b" } );
+    table.add_e2_node( { "c", "d" } );
+    table.start();
+
+    std::shared_ptr<const ts::neighbor_snapshot_t> snap = table.snapshot();
+    const std::unordered_set<std::string> *cells = snap->neighbors_of( "a" );
+    errors += fail_not_if( cells != nullptr && cells->count( "x" ) == 1, "cells reported by UEs are neighbors" );
+    errors += fail_not_if( cells != nullptr && cells->count( "b" ) == 1, "cells of the same E2 node are neighbors" );
+    errors += fail_if( snap->neighbors_of( "b" ) != nullptr, "E2 relations alone do not make neighbors known" );
+    errors += fail_if( snap->neighbors_of( "c" ) != nullptr, "E2 nodes without UE reports have no known neighbors" );
+    errors += fail_not_equal( table.get_stats().cells, 1u, "cells with known neighbors" );
+
+    // a UE now reports neighbors of c
+    ue.serving_cell_id = "c";
+    ts::encode_ue_record( ue, value );
+    sdl->set( ts::SDL_UE_NAMESPACE, { { "ue-2", value } } );
+    metrics.refresh_prefix( "" );
+    table.refresh();
+    snap = table.snapshot();
+    errors += fail_not_if( snap->neighbors_of( "c" ) != nullptr && snap->neighbors_of( "c" )->count( "d" ) == 1, "refresh adds reported cells" );
+
+    // without UE metrics nothing is ever pruned
+    ts::NeighborTable e2_only( nullptr, std::chrono::milliseconds( 1000 ) );
+    e2_only.add_e2_node( { "a", "b" } );
+    e2_only.start();
+    errors += fail_if( e2_only.snapshot()->neighbors_of( "a" ) != nullptr, "E2 setups alone prune nothing" );
+
+    // snapshots are read while refreshes publish new ones
+    std::atomic<bool> stop { false };
+    std::atomic<bool> versions_ok { true };
+    std::thread reader( [&]{
+        unsigned long last = 0;
+        while( !stop ) {
+            unsigned long version = table.snapshot()->version;
+            if( version < last ) {
+                versions_ok = false;
+            }
+            last = version;
+        }
+    } );
+    unsigned long before = table.snapshot()->version;
+    for( int i = 0; i < 1000; i++ ) {
+        table.refresh();
+    }
+    stop = true;
+    reader.join();
+    errors += fail_not_if( versions_ok, "snapshot versions never go back" );
+    errors += fail_not_equal( table.snapshot()->version, before + 1000, "each refresh publishes a snapshot" );
+
+    return errors;
+}
@@ -0,0 +1,119 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	policy_store_test.cpp
+    Abstract:	Tests the A1 policy store: operations on instances, scope
+                precedence, and snapshots read while writers publish.
+                Included by unit_test.cpp.
+
+    Date:       18 Oct 2026
+*/
+
+static ts::policy_t test_policy( const std::string &instance_id, int threshold,
+                                 const std::vector<std::string> &cells = { } ) {
+    ts::policy_t p;
+
+    p.type_id = ts::TS_POLICY_TYPE;
+    p.instance_id = instance_id;
+    p.threshold = threshold;
+    p.cells = cells;
+    if( cells.size() == 1 ) {
+        p.scope = ts::PolicyScope::CELL;
+    } else if( cells.size() > 1 ) {
+        p.scope = ts::PolicyScope::CELL_GROUP;
+    }
+
+    return p;
+}
+
+static int policy_store_test( ) {
+    int errors = 0;
+    std::string error;
+    ts::CellIndex cells;
+    ts::PolicyStore store( cells );
+
+    errors += fail_not_if( ts::to_policy_op( "UPDATE" ) == ts::PolicyOp::UPDATE, "UPDATE operation" );
+    errors += fail_not_if( ts::to_policy_op( "PATCH" ) == ts::PolicyOp::UNKNOWN, "unknown operation" );
+
+    errors += fail_not_equal( store.snapshot()->threshold_for( cells.find( "a" ) ), 0, "no policy, no threshold" );
+    errors += fail_if( store.apply( ts::PolicyOp::CREATE, test_policy( "", 5 ), error ), "an instance id is required" );
+    errors += fail_if( store.apply( ts::PolicyOp::DELETE, test_policy( "nope", 0 ), error ), "deleting an unknown instance fails" );
+    ts::policy_t empty_group = test_policy( "group", 5 );
+    empty_group.scope = ts::PolicyScope::CELL_GROUP;
+    errors += fail_if( store.apply( ts::PolicyOp::CREATE, empty_group, error ), "a scoped policy needs cells" );
+
+    std::shared_ptr<const ts::policy_snapshot_t> before = store.snapshot();
+    errors += fail_not_if( store.apply( ts::PolicyOp::CREATE, test_policy( "global-1", 5 ), error ), "create a global policy" );
+    errors += fail_not_if( store.apply( ts::PolicyOp::CREATE, test_policy( "global-2", 7 ), error ), "create another global policy" );
+    errors += fail_not_equal( store.snapshot()->threshold_for( cells.find( "a" ) ), 7, "the latest global policy wins" );
+    errors += fail_not_equal( before->threshold_for( cells.find( "a" ) ), 0, "published snapshots never change" );
+
+    errors += fail_not_if( store.apply( ts::PolicyOp::UPDATE, test_policy( "global-1", 6 ), error ), "update a global policy" );
+    errors += fail_not_equal( store.snapshot()->threshold_for( cells.find( "a" ) ), 6, "an updated policy is the latest" );
+
+    // a cell policy overrides a cell group policy, whatever the order they came in
+    store.apply( ts::PolicyOp::CREATE, test_policy( "cell", 3, { "a" } ), error );
+    store.apply( ts::PolicyOp::CREATE, test_policy( "group", 2, { "a", "b" } ), error );
+    std::shared_ptr<const ts::policy_snapshot_t> snap = store.snapshot();
+    errors += fail_not_equal( snap->threshold_for( cells.find( "a" ) ), 3, "cell policy over group policy" );
+    errors += fail_not_equal( snap->threshold_for( cells.find( "b" ) ), 2, "group policy over global policy" );
+    errors += fail_not_equal( snap->threshold_for( cells.find( "c" ) ), 6, "global policy elsewhere" );
+    errors += fail_not_equal( snap->scoped_cells, 2u, "one threshold per scoped cell" );
+    errors += fail_not_if( cells.find( "a" ) != ts::NO_CELL && cells.find( "c" ) == ts::NO_CELL, "cells of scoped policies are indexed" );
+
+    store.apply( ts::PolicyOp::DELETE, test_policy( "cell", 0 ), error );
+    errors += fail_not_equal( store.snapshot()->threshold_for( cells.find( "a" ) ), 2, "deleting the cell policy falls back to the group" );
+    errors += fail_not_equal( store.snapshot()->instances.size(), 3u, "instances left" );
+
+    // a serving cell resolved before any policy applies to it keeps its index
+    int z = cells.intern( "z" );
+    errors += fail_not_equal( store.snapshot()->threshold_for( z ), 6, "a cell indexed without policy" );
+    store.apply( ts::PolicyOp::CREATE, test_policy( "cell-z", 9, { "z" } ), error );
+    errors += fail_not_equal( store.snapshot()->threshold_for( z ), 9, "a cell indexed before its policy" );
+    store.apply( ts::PolicyOp::DELETE, test_policy( "cell-z", 0 ), error );
+
+    // readers never see a snapshot go back, nor a half built one
+    std::atomic<bool> stop { false };
+    std::atomic<bool> consistent { true };
+    std::vector<std::thread> readers;
+    for( int r = 0; r < 2; r++ ) {
+        readers.emplace_back( [&]{
+            unsigned long last = 0;
+            while( !stop ) {
+                std::shared_ptr<const ts::policy_snapshot_t> s = store.snapshot();
+                if( s->version < last || s->threshold_for( cells.find( "c" ) ) != s->downlink_threshold ) {
+                    consistent = false;
+                }
+                last = s->version;
+            }
+        } );
+    }
+    for( int i = 0; i < 2000; i++ ) {
+        store.apply( ts::PolicyOp::UPDATE, test_policy( "global-1", i ), error );
+    }
+    stop = true;
+    for( std::thread &t : readers ) {
+        t.join();
+    }
+    errors += fail_not_if( consistent, "snapshots read while writers publish" );
+    errors += fail_not_equal( store.snapshot()->threshold_for( cells.find( "c" ) ), 1999, "the last update wins" );
+
+    return errors;
+}
@@ -19,6 +19,6 @@
 
 helm delete --purge dbprepop
 
-docker build --tag ts-write-sdl:0.0.1 .
+docker build --tag ts-write-sdl:0.0.1 -f Dockerfile ../..
 
 helm install helm --name dbprepop  --namespace ricplt
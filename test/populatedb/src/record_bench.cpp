@@ -0,0 +1,238 @@
+/*
+# ==================================================================================
+#       Copyright (c) 2020 AT&T Intellectual Property.
+#
+#   Licensed under the Apache License, Version 2.0 (the "License");
+#   you may not use this file except in compliance with the License.
+#   You may obtain a copy of the License at
+#
+#          http://www.apache.org/licenses/LICENSE-2.0
+#
+#   Unless required by applicable law or agreed to in writing, software
+#   distributed under the License is distributed on an "AS IS" BASIS,
+#   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#   See the License for the specific language governing permissions and
+#   limitations under the License.
+# ==================================================================================
+*/
+
+/*
+  Compares the JSON and the binary encoding of UE and cell metrics: storage
+  size of the values and time to decode them with the same functions the
+  TS xApp uses (parse_ue_metrics, parse_cell_metrics). The in place read of
+  the binary UE record (only the fields used by a handover decision, no
+  copies) is timed as well. There is one cell value for 16 UEs.
+
+  Usage: record_bench [-n ues] [-c neighbors]
+*/
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "metrics_cache.hpp"
+#include "metrics_record.hpp"
+
+using namespace std;
+using Data = std::vector<uint8_t>;
+
+static uint64_t lcg_state = 42;
+
+// deterministic values, so runs are comparable
+static double next_rand( double lo, double hi ) {
+  lcg_state = lcg_state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return lo + ( hi - lo ) * ( ( lcg_state >> 11 ) * ( 1.0 / 9007199254740992.0 ) );
+}
+
+static string cell_id( int n ) {
+  char buf[32];
+  snprintf( buf, sizeof( buf ), "310-680-200-%06d", 555000 + n );
+  return buf;
+}
+
+// same layout as the JSON written by write_sdl
+static string ue_json( int ue_id, const ts::ue_record_t &ue ) {
+  char buf[256];
+  string json;
+
+  snprintf( buf, sizeof( buf ), "{ \"UEID\": %d, \"ServingCellID\": \"%s\", \"MeasTimestampUEPDCPBytes\": \"2020-03-18 02:23:18.220\", ",
+            ue_id, ue.serving_cell_id.c_str() );
+  json += buf;
+  snprintf( buf, sizeof( buf ), "\"MeasPeriodUEPDCPBytes\": 20,\"UEPDCPBytesDL\": %lu,\"UEPDCPBytesUL\": %lu, ",
+            (unsigned long) ue.pdcp_bytes_dl, (unsigned long) ue.pdcp_bytes_ul );
+  json += buf;
+  snprintf( buf, sizeof( buf ), "\"MeasTimestampUEPRBUsage\": \"2020-03-18 02:23:18.220\", \"MeasPeriodUEPRBUsage\": 20, \"UEPRBUsageDL\": %u, \"UEPRBUsageUL\": %u, ",
+            ue.prb_usage_dl, ue.prb_usage_ul );
+  json += buf;
+  snprintf( buf, sizeof( buf ), "\"MeasTimestampRF\": \"2020-03-18 02:23:18.210\",\"MeasPeriodRF\": 40, \"ServingCellRF\": [%.1f,%.1f,%.1f], \"NeighborCellRF\": [",
+            ue.rsrp, ue.rsrq, ue.sinr );
+  json += buf;
+  for( size_t i = 0; i < ue.neighbors.size(); i++ ) {
+    auto &n = ue.neighbors[i];
+    snprintf( buf, sizeof( buf ), "%s {\"CID\": \"%s\",\"CellRF\": [%.1f,%.1f,%.1f] }",
+              i == 0 ? "" : ",", n.cell_id.c_str(), n.rsrp, n.rsrq, n.sinr );
+    json += buf;
+  }
+  json += " ] }";
+
+  return json;
+}
+
+// same layout as the JSON written by write_sdl
+static string cell_json( const string &id, const ts::cell_record_t &cell ) {
+  char buf[512];
+
+  snprintf( buf, sizeof( buf ), "{ \"CellID\": \"%s\", \"MeasTimestampPDCPBytes\": \"2020-03-18 02:23:18.220\", \"MeasPeriodPDCPBytes\": 20, "
+            "\"PDCPBytesDL\": %lu, \"PDCPBytesUL\": %lu, \"MeasTimestampAvailPRB\": \"2020-03-18 02:23:18.220\", \"MeasPeriodAvailPRB\": 20, "
+            "\"AvailPRBDL\": %u, \"AvailPRBUL\": %u  }",
+            id.c_str(), (unsigned long) cell.pdcp_bytes_dl, (unsigned long) cell.pdcp_bytes_ul, cell.avail_prb_dl, cell.avail_prb_ul );
+
+  return buf;
+}
+
+template<typename F>
+static double time_ms( F f ) {
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>( chrono::steady_clock::now() - start ).count();
+}
+
+extern int main( int argc, char** argv ) {
+  int nues = 1000000;
+  int nneighbors = 3;
+  int opt;
+
+  while( ( opt = getopt( argc, argv, "n:c:" ) ) != -1 ) {
+    switch( opt ) {
+      case 'n': nues = atoi( optarg ); break;
+      case 'c': nneighbors = atoi( optarg ); break;
+      default:
+        cerr << "usage: " << argv[0] << " [-n ues] [-c neighbors]" << endl;
+        return 1;
+    }
+  }
+
+  vector<Data> json( nues );
+  vector<Data> binary( nues );
+  size_t json_bytes = 0;
+  size_t binary_bytes = 0;
+
+  for( int i = 0; i < nues; i++ ) {
+    ts::ue_record_t ue;
+    ue.serving_cell_id = cell_id( i % 64 );
+    ue.rsrp = (int) next_rand( -140, -70 );
+    ue.rsrq = (int) next_rand( -20, -3 );
+    ue.sinr = (int) next_rand( -10, 30 );
+    ue.prb_usage_dl = next_rand( 0, 100 );
+    ue.prb_usage_ul = next_rand( 0, 100 );
+    ue.pdcp_bytes_dl = next_rand( 0, 1e7 );
+    ue.pdcp_bytes_ul = next_rand( 0, 1e7 );
+    ue.timestamp_ms = 1584498198210;
+    for( int n = 1; n <= nneighbors; n++ ) {
+      ue.neighbors.push_back( { cell_id( ( i + n ) % 64 ), (float) (int) next_rand( -140, -70 ),
+                                (float) (int) next_rand( -20, -3 ), (float) (int) next_rand( -10, 30 ) } );
+    }
+
+    string s = ue_json( 12345 + i, ue );
+    json[i].assign( s.begin(), s.end() );
+    if( !ts::encode_ue_record( ue, binary[i] ) ) {
+      binary[i] = json[i];      // too many neighbors for a binary record, stored as JSON
+    }
+
+    json_bytes += json[i].size();
+    binary_bytes += binary[i].size();
+  }
+
+  int ncells = max( 1, nues / 16 );
+  vector<Data> cell_json_values( ncells );
+  vector<Data> cell_binary( ncells );
+  size_t cell_json_bytes = 0;
+  size_t cell_binary_bytes = 0;
+
+  for( int i = 0; i < ncells; i++ ) {
+    ts::cell_record_t cell;
+    cell.avail_prb_dl = next_rand( 0, 100 );
+    cell.avail_prb_ul = next_rand( 0, 100 );
+    cell.pdcp_bytes_dl = next_rand( 0, 1e9 );
+    cell.pdcp_bytes_ul = next_rand( 0, 1e9 );
+    cell.timestamp_ms = 1584498198220;
+
+    string s = cell_json( cell_id( i ), cell );
+    cell_json_values[i].assign( s.begin(), s.end() );
+    ts::encode_cell_record( cell, cell_binary[i] );
+
+    cell_json_bytes += cell_json_values[i].size();
+    cell_binary_bytes += cell_binary[i].size();
+  }
+
+  size_t failed = 0;
+  double sink = 0;      // keeps the decoded values alive
+
+  double json_ms = time_ms( [&]{
+    for( auto &v : json ) {
+      ts::ue_metrics_t ue;
+      failed += !ts::parse_ue_metrics( (const char *) v.data(), v.size(), ue );
+      sink += ue.serving_rf.rsrp;
+    }
+  } );
+
+  double binary_ms = time_ms( [&]{
+    for( auto &v : binary ) {
+      ts::ue_metrics_t ue;
+      failed += !ts::parse_ue_metrics( (const char *) v.data(), v.size(), ue );
+      sink += ue.serving_rf.rsrp;
+    }
+  } );
+
+  double view_ms = time_ms( [&]{
+    for( auto &v : binary ) {
+      ts::UeRecordView ue( v.data(), v.size() );
+      if( !ue.valid() ) {
+        failed++;
+        continue;
+      }
+      sink += ue.rsrp() + ue.serving_cell_id().size();
+      for( size_t n = 0; n < ue.neighbor_count(); n++ ) {
+        sink += ue.neighbor_rsrp( n );
+      }
+    }
+  } );
+
+  double cell_json_ms = time_ms( [&]{
+    for( auto &v : cell_json_values ) {
+      ts::cell_metrics_t cell;
+      failed += !ts::parse_cell_metrics( (const char *) v.data(), v.size(), cell );
+      sink += cell.avail_prb_dl;
+    }
+  } );
+
+  double cell_binary_ms = time_ms( [&]{
+    for( auto &v : cell_binary ) {
+      ts::cell_metrics_t cell;
+      failed += !ts::parse_cell_metrics( (const char *) v.data(), v.size(), cell );
+      sink += cell.avail_prb_dl;
+    }
+  } );
+
+  printf( "UEs: %d, neighbors per UE: %d, decode failures: %zu (checksum %.0f)\n", nues, nneighbors, failed, sink );
+  printf( "storage  json %10zu bytes (%6.1f per UE)\n", json_bytes, (double) json_bytes / nues );
+  printf( "storage  bin  %10zu bytes (%6.1f per UE), %.1f%% smaller\n", binary_bytes, (double) binary_bytes / nues,
+          100.0 * ( 1.0 - (double) binary_bytes / json_bytes ) );
+  printf( "decode   json %10.1f ms (%6.1f ns per UE)\n", json_ms, json_ms * 1e6 / nues );
+  printf( "decode   bin  %10.1f ms (%6.1f ns per UE), %.1fx faster\n", binary_ms, binary_ms * 1e6 / nues, json_ms / binary_ms );
+  printf( "in place view %10.1f ms (%6.1f ns per UE), %.1fx faster\n", view_ms, view_ms * 1e6 / nues, json_ms / view_ms );
+  printf( "cells: %d\n", ncells );
+  printf( "storage  json %10zu bytes (%6.1f per cell)\n", cell_json_bytes, (double) cell_json_bytes / ncells );
+  printf( "storage  bin  %10zu bytes (%6.1f per cell), %.1f%% smaller\n", cell_binary_bytes, (double) cell_binary_bytes / ncells,
+          100.0 * ( 1.0 - (double) cell_binary_bytes / cell_json_bytes ) );
+  printf( "decode   json %10.1f ms (%6.1f ns per cell)\n", cell_json_ms, cell_json_ms * 1e6 / ncells );
+  printf( "decode   bin  %10.1f ms (%6.1f ns per cell), %.1fx faster\n", cell_binary_ms, cell_binary_ms * 1e6 / ncells,
+          cell_json_ms / cell_binary_ms );
+
+  return 0;
+}
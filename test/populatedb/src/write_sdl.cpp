@@ -1,4 +1,3 @@
-
 /*
 # ==================================================================================
 #       Copyright (c) 2020 AT&T Intellectual Property.
@@ -17,20 +16,46 @@
 # ==================================================================================
 */
 
+/*
+  Populates SDL with a synthetic topology: N cells on a regular grid, M UEs
+  per cell and, for each UE, the RF of the F cells nearest to its serving
+  cell. RF values come from a macro cell path loss model with log-normal
+  shadowing, so RSRP, RSRQ and SINR are consistent with each other.
+
+  Everything derives from the seed: the same options write the same data,
+  regardless of the batch size and of the number of writers. Batches of
+  keys are generated while previous batches are being written by the
+  writer threads, each one with its own SDL connection.
+
+  Usage: write_sdl [-c cells] [-u ues-per-cell] [-f fanout] [-s seed]
+                   [-k keys-per-set] [-w writers] [-b] [-n]
+    -b  write binary metrics records instead of JSON
+    -n  do not remove the existing data first
+*/
+
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
 #include <thread>
 #include <iostream>
 #include <memory>
+#include <mutex>
 
 #include <sdl/syncstorage.hpp>
 #include <set>
+#include <sstream>
 #include <map>
 #include <vector>
 #include <string>
 
+#include "metrics_record.hpp"
+
 
 using namespace std;
 using Namespace = std::string;
@@ -51,43 +76,69 @@ std::unique_ptr<shareddatalayer::SyncStorage> sdl;
 Namespace nsu;
 Namespace nsc;
 
-void get_sdl_data() {
+struct options {
+  int cells = 3;
+  int ues_per_cell = 1;
+  int fanout = 2;
+  uint64_t seed = 1;
+  int batch = 1000;             // keys per set
+  int writers = 4;              // sets in flight
+  bool binary = false;
+  bool keep = false;
+};
 
-  std::string prefix2="310";
-  Keys K = sdl->findKeys(nsc, prefix2);     // just the prefix
-  DataMap Dk = sdl->get(nsc, K);
+/*
+  Binary records (see metrics_record.hpp) are printed decoded, JSON as is.
+*/
+std::string value_to_string( const Data &val_v ) {
+  std::ostringstream os;
+
+  if( ts::is_binary_record( val_v.data(), val_v.size() ) ) {
+    ts::UeRecordView ue( val_v.data(), val_v.size() );
+    ts::CellRecordView cell( val_v.data(), val_v.size() );
+
+    if( ue.valid() ) {
+      os << "<UE record v" << (int) ue.version() << " " << val_v.size() << " bytes> serving " << ue.serving_cell_id()
+         << " [" << ue.rsrp() << "," << ue.rsrq() << "," << ue.sinr() << "]";
+      for( size_t i = 0; i < ue.neighbor_count(); i++ ) {
+        os << " neighbor " << ue.neighbor_cell_id( i ) << " [" << ue.neighbor_rsrp( i ) << "," << ue.neighbor_rsrq( i ) << "," << ue.neighbor_sinr( i ) << "]";
+      }
+    } else if( cell.valid() ) {
+      os << "<cell record v" << (int) cell.version() << " " << val_v.size() << " bytes> AvailPRBDL " << cell.avail_prb_dl()
+         << " AvailPRBUL " << cell.avail_prb_ul() << " PDCPBytesDL " << cell.pdcp_bytes_dl() << " PDCPBytesUL " << cell.pdcp_bytes_ul();
+    } else {
+      os << "<invalid record " << val_v.size() << " bytes>";
+    }
+    return os.str();
+  }
 
-  std::cout << "K contains " << K.size() << " elements.\n";
+  return std::string( val_v.begin(), val_v.end() );
+}
 
-  cout << "before forloop\n";
+/*
+  Prints the number of keys of a namespace and the first few values.
+*/
+void show_namespace( const Namespace &ns, size_t max_values ) {
+  Keys K = sdl->findKeys(ns, "");
 
+  std::cout << ns << " contains " << K.size() << " elements.\n";
 
-  for(auto si=K.begin();si!=K.end();++si){
-    std::vector<uint8_t> val_v = Dk[(*si)]; // 4 lines to unpack a string
-    char val[val_v.size()+1];                               // from Data
-    int i;
-    for(i=0;i<val_v.size();++i) val[i] = (char)(val_v[i]);
-    val[i]='\0';
-    cout << "KEYS and Values " << (*si).c_str()  << " = " <<  val << "\n";
+  Keys first;
+  for(auto si=K.begin();si!=K.end() && first.size() < max_values;++si){
+    first.insert(*si);
   }
-  
-  std::string prefix3="12";
-  Keys K2 = sdl->findKeys(nsu, prefix3);     // just the prefix
-  DataMap Dk2 = sdl->get(nsu, K2);
 
-  std::cout << "K contains " << K2.size() << " elements.\n";
+  DataMap Dk = sdl->get(ns, first);
+  for(auto &kv : Dk){
+    cout << "KEYS and Values " << kv.first << " = " <<  value_to_string( kv.second ) << "\n";
+  }
+}
+
+void get_sdl_data() {
 
-  cout << "before forloop\n";
+  show_namespace( nsc, 3 );
+  show_namespace( nsu, 3 );
 
-  for(auto si=K2.begin();si!=K2.end();++si){
-    std::vector<uint8_t> val_v = Dk2[(*si)]; // 4 lines to unpack a string
-    char val[val_v.size()+1];                               // from Data
-    int i;
-    for(i=0;i<val_v.size();++i) val[i] = (char)(val_v[i]);
-    val[i]='\0';
-    cout << "KEYS and Values " << (*si).c_str()  << " = " <<  val << "\n";
-  }
-  
   cout << endl;
 
 }
@@ -105,95 +156,435 @@ void delete_sdl_data() {
     std::cout << "Removing All Keys from UE namespace\n";
 
     sdl->removeAll(nsu);
-    
+
   }
   catch(...){
     cout << "SDL Error in Removing Data for Namespace" << endl;
 
-  }    
+  }
 
 }
 
+// ---------------- random numbers --------------------------------------------
 
-void write_sdl_data() {
+/*
+  splitmix64; unlike the std distributions, the sequence does not depend on
+  the standard library.
+*/
+class Random {
+  private:
+    uint64_t state;
+    bool have_spare = false;
+    double spare = 0;
+
+  public:
+    Random( uint64_t seed ) : state( seed ) { }
+
+    uint64_t next( ) {
+      uint64_t z = ( state += 0x9E3779B97F4A7C15ULL );
+      z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+      z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+      return z ^ ( z >> 31 );
+    }
+
+    double uniform( double lo, double hi ) {
+      return lo + ( hi - lo ) * ( ( next() >> 11 ) * ( 1.0 / 9007199254740992.0 ) );
+    }
+
+    // Box-Muller
+    double normal( double mean, double stddev ) {
+      if( have_spare ) {
+        have_spare = false;
+        return mean + stddev * spare;
+      }
+
+      double u = uniform( 1e-12, 1.0 );
+      double v = uniform( 0.0, 2 * M_PI );
+      double r = sqrt( -2.0 * log( u ) );
+      spare = r * sin( v );
+      have_spare = true;
+      return mean + stddev * r * cos( v );
+    }
+};
+
+// independent stream per entity, so the data does not depend on the generation order
+uint64_t stream_seed( uint64_t seed, uint64_t kind, uint64_t index ) {
+  Random r( seed ^ ( kind << 56 ) ^ ( index * 0x9E3779B97F4A7C15ULL ) );
+  return r.next();
+}
 
-  cout << "before sdl set\n";
-  
-  try{
-    //connecting to the Redis and generating a random key for namespace "hwxapp"
-    cout << "IN SDL Set Data";
-    //    std::string data_string = "{\"rsrp\" : -110}";
-
-    std::string data_string = "{\"CellID\": \"310-680-200-555001\", \"MeasTimestampPDCPBytes\": \"2020-03-18 02:23:18.220\", \"MeasPeriodPDCPBytes\": 20, \"PDCPBytesDL\": 2000000, \"PDCPBytesUL\": 1200000, \"MeasTimestampAvailPRB\": \"2020-03-18 02:23:18.220\", \"MeasPeriodAvailPRB\": 20, \"AvailPRBDL\": 30, \"AvailPRBUL\": 50  }";
-      
-    DataMap dmap;
-    //    char key[4]="abc";
-    char key[] = "310-680-200-555001";
-    std::cout << "KEY: "<< key << std::endl;
-    Key k = key;
-    Data d;
-    //    uint8_t num = 101;
-    d.assign(data_string.begin(), data_string.end());
-    //    d.push_back(num);
-    dmap.insert({k,d});
-
-    sdl->set(nsc, dmap);
-
-    std::string data_string_cell2 = "{ \"CellID\": \"310-680-200-555002\", \"MeasTimestampPDCPBytes\": \"2020-03-18 02:23:18.220\", \"MeasPeriodPDCPBytes\": 20, \"PDCPBytesDL\": 800000, \"PDCPBytesUL\": 400000, \"MeasTimestampAvailPRB\": \"2020-03-18 02:23:18.220\", \"MeasPeriodAvailPRB\": 20, \"AvailPRBDL\": 30, \"AvailPRBUL\": 45  }";
-
-    Data d2;
-    DataMap dmap2;    
-    char key2[] = "310-680-200-555002";
-    std::cout << "KEY: "<< key2 << std::endl;
-    Key k2 = key2;
-    d2.assign(data_string_cell2.begin(), data_string_cell2.end());
-    //    d.push_back(num);
-    dmap2.insert({k2,d});
-
-    sdl->set(nsc, dmap2);
-
-
-
-    std::string data_string_cell3 = "{ \"CellID\": \"310-680-200-555003\", \"MeasTimestampPDCPBytes\": \"2020-03-18 02:23:18.220\", \"MeasPeriodPDCPBytes\": 20, \"PDCPBytesDL\": 800000, \"PDCPBytesUL\": 400000, \"MeasTimestampAvailPRB\": \"2020-03-18 02:23:18.220\", \"MeasPeriodAvailPRB\": 20, \"AvailPRBDL\": 30, \"AvailPRBUL\": 45  }";
-
-    Data d3;
-    DataMap dmap3;
-    char key3[] = "310-680-200-555003";
-    std::cout << "KEY: "<< key3 << std::endl;
-    Key k3 = key3;
-    d3.assign(data_string_cell3.begin(), data_string_cell3.end());
-    //    d.push_back(num);
-    dmap3.insert({k3,d3});
-
-    sdl->set(nsc, dmap3);
-
-
-    std::string data_string_ue = "{ \"UEID\": 12345, \"ServingCellID\": \"310-680-200-555002\", \"MeasTimestampUEPDCPBytes\": \"2020-03-18 02:23:18.220\", \"MeasPeriodUEPDCPBytes\": 20,\"UEPDCPBytesDL\": 250000,\"UEPDCPBytesUL\": 100000, \"MeasTimestampUEPRBUsage\": \"2020-03-18 02:23:18.220\", \"MeasPeriodUEPRBUsage\": 20, \"UEPRBUsageDL\": 10, \"UEPRBUsageUL\": 30, \"MeasTimestampRF\": \"2020-03-18 02:23:18.210\",\"MeasPeriodRF\": 40, \"ServingCellRF\": [-115,-16,-5], \"NeighborCellRF\": [  {\"CID\": \"310-680-200-555001\",\"CellRF\": [-90,-13,-2.5 ] }, {\"CID\": \"310-680-200-555003\",	\"CellRF\": [-140,-17,-6 ] } ] }";
-      
-    Data d4;
-    DataMap dmap4;
-    char key4[] = "12345";
-    std::cout << "KEY: "<< key4 << std::endl;
-    d4.assign(data_string_ue.begin(), data_string_ue.end());
-    Key k4 = key4;
-    //    d.push_back(num);
-    dmap4.insert({k4,d4});
-
-    sdl->set(nsu, dmap4);
-    
+// ---------------- topology and RF model -------------------------------------
+
+const double ISD_M = 500;                 // inter-site distance
+const double CELL_RS_POWER_DBM = 15.2;    // 46 dBm over 1200 subcarriers
+const double NOISE_RE_DBM = -132.2;       // thermal noise over 15 kHz with 7 dB noise figure
+const double SHADOWING_DB = 8;
+
+struct cell_t {
+  std::string id;
+  double x;
+  double y;
+  std::vector<int> neighbors;             // nearest cells first
+};
+
+std::string cell_name( int n ) {
+  char buf[32];
+  snprintf( buf, sizeof( buf ), "310-680-200-%06d", 555001 + n );
+  return buf;
+}
+
+/*
+  Cells on a grid of ISD_M; the neighbors of a cell are the fanout nearest
+  cells, found by scanning rings of the grid around it.
+*/
+std::vector<cell_t> build_cells( int ncells, int fanout ) {
+  int cols = (int) ceil( sqrt( (double) ncells ) );
+  std::vector<cell_t> cells( ncells );
+
+  for( int i = 0; i < ncells; i++ ) {
+    cells[i].id = cell_name( i );
+    cells[i].x = ( i % cols ) * ISD_M + ( ( i / cols ) % 2 ) * ISD_M / 2;     // offset rows, hexagonal like
+    cells[i].y = ( i / cols ) * ISD_M * 0.866;
   }
-  catch(...){
-    cout << "SDL Error in Set Data for Namespace" << endl;
 
+  fanout = std::min( fanout, ncells - 1 );
+  int radius = 1;
+  while( ( 2 * radius + 1 ) * ( 2 * radius + 1 ) - 1 < fanout ) {
+    radius++;
+  }
+  radius++;           // the ring after the one that is big enough may hold closer cells
+
+  for( int i = 0; i < ncells; i++ ) {
+    int row = i / cols;
+    int col = i % cols;
+    std::vector<std::pair<double, int>> candidates;
+
+    for( int r = std::max( 0, row - radius ); r <= row + radius; r++ ) {
+      for( int c = std::max( 0, col - radius ); c <= std::min( cols - 1, col + radius ); c++ ) {
+        int j = r * cols + c;
+        if( j == i || j >= ncells ) {
+          continue;
+        }
+        double dx = cells[j].x - cells[i].x;
+        double dy = cells[j].y - cells[i].y;
+        candidates.push_back( { dx * dx + dy * dy, j } );
+      }
+    }
+
+    if( (int) candidates.size() < fanout ) {        // small or ragged grids: take every cell
+      candidates.clear();
+      for( int j = 0; j < ncells; j++ ) {
+        if( j != i ) {
+          double dx = cells[j].x - cells[i].x;
+          double dy = cells[j].y - cells[i].y;
+          candidates.push_back( { dx * dx + dy * dy, j } );
+        }
+      }
+    }
+
+    std::partial_sort( candidates.begin(), candidates.begin() + fanout, candidates.end() );
+    for( int n = 0; n < fanout; n++ ) {
+      cells[i].neighbors.push_back( candidates[n].second );
+    }
   }
 
-  cout << "after sdl set\n";
+  return cells;
+}
 
+// 3GPP macro path loss (TR 36.814), distance in meters
+double rsrp_dbm( double distance_m, Random &rnd ) {
+  double d_km = std::max( distance_m, 35.0 ) / 1000.0;
+  return CELL_RS_POWER_DBM - ( 128.1 + 37.6 * log10( d_km ) ) + rnd.normal( 0, SHADOWING_DB );
+}
+
+double to_mw( double dbm ) {
+  return pow( 10.0, dbm / 10.0 );
+}
+
+double to_db( double mw ) {
+  return 10.0 * log10( mw );
+}
+
+/*
+  RSRQ and SINR of each measured cell, given the RSRP of all of them; the
+  measured cells are the only interferers. Values are rounded and clamped
+  to the reporting ranges.
+*/
+void rf_quality( const std::vector<double> &rsrp, std::vector<double> &rsrq, std::vector<double> &sinr ) {
+  double total = to_mw( NOISE_RE_DBM );
+  for( double r : rsrp ) {
+    total += to_mw( r );
+  }
+
+  rsrq.resize( rsrp.size() );
+  sinr.resize( rsrp.size() );
+  for( size_t i = 0; i < rsrp.size(); i++ ) {
+    double s = to_mw( rsrp[i] );
+    rsrq[i] = std::min( -3.0, std::max( -19.5, round( 2 * ( to_db( s / total ) - 3.0 ) ) / 2 ) );
+    sinr[i] = std::min( 30.0, std::max( -23.0, round( 2 * to_db( s / ( total - s ) ) ) / 2 ) );
+  }
+}
+
+// ---------------- records ---------------------------------------------------
+
+void cell_metrics( int n, const options &opts, ts::cell_record_t &cell ) {
+  Random rnd( stream_seed( opts.seed, 1, n ) );
+  double load = rnd.uniform( 0.1, 0.95 );
+
+  cell.avail_prb_dl = (uint32_t) round( 100 * ( 1 - load ) );
+  cell.avail_prb_ul = (uint32_t) round( 100 * ( 1 - load * rnd.uniform( 0.5, 1.0 ) ) );
+  cell.pdcp_bytes_dl = (uint64_t) ( load * rnd.uniform( 1e6, 4e6 ) );
+  cell.pdcp_bytes_ul = (uint64_t) ( cell.pdcp_bytes_dl * rnd.uniform( 0.2, 0.6 ) );
+  cell.timestamp_ms = 1584498198220;
+}
+
+/*
+  A UE dropped uniformly in the serving cell area, measuring the serving
+  cell and its neighbors.
+*/
+void ue_metrics( int64_t n, const std::vector<cell_t> &cells, const options &opts, ts::ue_record_t &ue ) {
+  Random rnd( stream_seed( opts.seed, 2, n ) );
+  const cell_t &serving = cells[n / opts.ues_per_cell];
+
+  double angle = rnd.uniform( 0, 2 * M_PI );
+  double dist = ISD_M / 2 * sqrt( rnd.uniform( 0, 1 ) );
+  double x = serving.x + dist * cos( angle );
+  double y = serving.y + dist * sin( angle );
+
+  std::vector<const cell_t *> measured { &serving };
+  for( int j : serving.neighbors ) {
+    measured.push_back( &cells[j] );
+  }
+
+  std::vector<double> rsrp;
+  std::vector<double> rsrq;
+  std::vector<double> sinr;
+  for( auto c : measured ) {
+    rsrp.push_back( round( std::max( -140.0, std::min( -44.0, rsrp_dbm( hypot( c->x - x, c->y - y ), rnd ) ) ) ) );
+  }
+  rf_quality( rsrp, rsrq, sinr );
+
+  ue.serving_cell_id = serving.id;
+  ue.rsrp = rsrp[0];
+  ue.rsrq = rsrq[0];
+  ue.sinr = sinr[0];
+  ue.prb_usage_dl = (uint32_t) rnd.uniform( 0, 30 );
+  ue.prb_usage_ul = (uint32_t) rnd.uniform( 0, 30 );
+  ue.pdcp_bytes_dl = (uint64_t) rnd.uniform( 1e4, 5e5 );
+  ue.pdcp_bytes_ul = (uint64_t) ( ue.pdcp_bytes_dl * rnd.uniform( 0.1, 0.5 ) );
+  ue.timestamp_ms = 1584498198210;
+  ue.neighbors.clear();
+  for( size_t i = 1; i < measured.size(); i++ ) {
+    ue.neighbors.push_back( { measured[i]->id, (float) rsrp[i], (float) rsrq[i], (float) sinr[i] } );
+  }
+}
+
+// same layout as the metrics written by KPIMON
+std::string cell_json( const std::string &id, const ts::cell_record_t &cell ) {
+  char buf[512];
+  snprintf( buf, sizeof( buf ), "{ \"CellID\": \"%s\", \"MeasTimestampPDCPBytes\": \"2020-03-18 02:23:18.220\", \"MeasPeriodPDCPBytes\": 20, "
+            "\"PDCPBytesDL\": %lu, \"PDCPBytesUL\": %lu, \"MeasTimestampAvailPRB\": \"2020-03-18 02:23:18.220\", \"MeasPeriodAvailPRB\": 20, "
+            "\"AvailPRBDL\": %u, \"AvailPRBUL\": %u  }",
+            id.c_str(), (unsigned long) cell.pdcp_bytes_dl, (unsigned long) cell.pdcp_bytes_ul, cell.avail_prb_dl, cell.avail_prb_ul );
+  return buf;
+}
+
+std::string ue_json( int64_t ue_id, const ts::ue_record_t &ue ) {
+  char buf[512];
+  std::string json;
+
+  snprintf( buf, sizeof( buf ), "{ \"UEID\": %ld, \"ServingCellID\": \"%s\", \"MeasTimestampUEPDCPBytes\": \"2020-03-18 02:23:18.220\", "
+            "\"MeasPeriodUEPDCPBytes\": 20,\"UEPDCPBytesDL\": %lu,\"UEPDCPBytesUL\": %lu, \"MeasTimestampUEPRBUsage\": \"2020-03-18 02:23:18.220\", "
+            "\"MeasPeriodUEPRBUsage\": 20, \"UEPRBUsageDL\": %u, \"UEPRBUsageUL\": %u, \"MeasTimestampRF\": \"2020-03-18 02:23:18.210\",\"MeasPeriodRF\": 40, "
+            "\"ServingCellRF\": [%g,%g,%g], \"NeighborCellRF\": [",
+            (long) ue_id, ue.serving_cell_id.c_str(), (unsigned long) ue.pdcp_bytes_dl, (unsigned long) ue.pdcp_bytes_ul,
+            ue.prb_usage_dl, ue.prb_usage_ul, ue.rsrp, ue.rsrq, ue.sinr );
+  json += buf;
+
+  for( size_t i = 0; i < ue.neighbors.size(); i++ ) {
+    auto &n = ue.neighbors[i];
+    snprintf( buf, sizeof( buf ), "%s {\"CID\": \"%s\",\"CellRF\": [%g,%g,%g ] }",
+              i == 0 ? "" : ",", n.cell_id.c_str(), n.rsrp, n.rsrq, n.sinr );
+    json += buf;
+  }
+  json += " ] }";
+
+  return json;
+}
+
+Data to_data( const std::string &s ) {
+  return Data( s.begin(), s.end() );
+}
+
+// ---------------- pipelined writes ------------------------------------------
+
+/*
+  Batches waiting to be written. Bounded, so that the generator stays at
+  most a couple of batches ahead of the writers.
+*/
+class BatchQueue {
+  private:
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<std::pair<const Namespace *, DataMap>> batches;
+    size_t capacity;
+    bool closed = false;
+
+  public:
+    BatchQueue( size_t capacity ) : capacity( capacity ) { }
+
+    void push( const Namespace *ns, DataMap &&batch ) {
+      std::unique_lock<std::mutex> lock( mutex );
+      not_full.wait( lock, [this]{ return batches.size() < capacity; } );
+      batches.emplace_back( ns, std::move( batch ) );
+      not_empty.notify_one();
+    }
+
+    bool pop( std::pair<const Namespace *, DataMap> &batch ) {
+      std::unique_lock<std::mutex> lock( mutex );
+      not_empty.wait( lock, [this]{ return closed || !batches.empty(); } );
+      if( batches.empty() ) {
+        return false;
+      }
+      batch = std::move( batches.front() );
+      batches.pop_front();
+      not_full.notify_one();
+      return true;
+    }
+
+    void close( ) {
+      std::lock_guard<std::mutex> lock( mutex );
+      closed = true;
+      not_empty.notify_all();
+    }
+};
+
+struct write_stats {
+  std::mutex mutex;
+  size_t keys = 0;
+  size_t bytes = 0;
+  size_t sets = 0;
+  size_t errors = 0;
+};
+
+void writer( BatchQueue &queue, write_stats &stats ) {
+  std::unique_ptr<shareddatalayer::SyncStorage> conn;
+  std::pair<const Namespace *, DataMap> batch;
+
+  try {
+    conn = shareddatalayer::SyncStorage::create();
+  } catch( const std::exception &e ) {
+    cout << "SDL Error in connecting: " << e.what() << endl;
+  }
+
+  while( queue.pop( batch ) ) {
+    size_t bytes = 0;
+    for( auto &kv : batch.second ) {
+      bytes += kv.first.size() + kv.second.size();
+    }
+
+    bool ok = false;
+    try {
+      if( conn ) {
+        conn->set( *batch.first, batch.second );
+        ok = true;
+      }
+    } catch( const std::exception &e ) {
+      cout << "SDL Error in Set Data for Namespace " << *batch.first << ": " << e.what() << endl;
+    }
+
+    std::lock_guard<std::mutex> lock( stats.mutex );
+    stats.sets++;
+    if( ok ) {
+      stats.keys += batch.second.size();
+      stats.bytes += bytes;
+    } else {
+      stats.errors++;
+    }
+  }
+}
+
+void write_sdl_data( const options &opts ) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<cell_t> cells = build_cells( opts.cells, opts.fanout );
+
+  BatchQueue queue( 2 * opts.writers );
+  write_stats stats;
+  std::vector<std::thread> writers;
+  for( int i = 0; i < opts.writers; i++ ) {
+    writers.emplace_back( writer, std::ref( queue ), std::ref( stats ) );
+  }
+
+  DataMap batch;
+  Data d;
+  auto flush = [&]( const Namespace &ns, bool last ) {
+    if( (int) batch.size() >= opts.batch || ( last && !batch.empty() ) ) {
+      queue.push( &ns, std::move( batch ) );
+      batch = DataMap();
+    }
+  };
+
+  ts::cell_record_t cell;
+  for( int i = 0; i < opts.cells; i++ ) {
+    cell_metrics( i, opts, cell );
+    if( opts.binary ) {
+      ts::encode_cell_record( cell, d );
+    } else {
+      d = to_data( cell_json( cells[i].id, cell ) );
+    }
+    batch.emplace_hint( batch.end(), cells[i].id, std::move( d ) );
+    flush( nsc, i == opts.cells - 1 );
+  }
+
+  ts::ue_record_t ue;
+  int64_t nues = (int64_t) opts.cells * opts.ues_per_cell;
+  for( int64_t i = 0; i < nues; i++ ) {
+    int64_t ue_id = 12345 + i;
+    ue_metrics( i, cells, opts, ue );
+    if( !opts.binary || !ts::encode_ue_record( ue, d ) ) {   // too large UEs are written as JSON
+      d = to_data( ue_json( ue_id, ue ) );
+    }
+    batch.emplace( std::to_string( ue_id ), std::move( d ) );
+    flush( nsu, i == nues - 1 );
+  }
+
+  queue.close();
+  for( auto &w : writers ) {
+    w.join();
+  }
+
+  double secs = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+  printf( "wrote %zu keys (%zu bytes) in %zu sets, %zu failed, %.2f s, %.0f keys/s\n",
+          stats.keys, stats.bytes, stats.sets, stats.errors, secs, stats.keys / secs );
 }
 
 
 extern int main( int argc, char** argv ) {
 
+  options opts;
+  int opt;
+  while( ( opt = getopt( argc, argv, "c:u:f:s:k:w:bn" ) ) != -1 ) {
+    switch( opt ) {
+      case 'c': opts.cells = atoi( optarg ); break;
+      case 'u': opts.ues_per_cell = atoi( optarg ); break;
+      case 'f': opts.fanout = atoi( optarg ); break;
+      case 's': opts.seed = strtoull( optarg, NULL, 10 ); break;
+      case 'k': opts.batch = atoi( optarg ); break;
+      case 'w': opts.writers = atoi( optarg ); break;
+      case 'b': opts.binary = true; break;
+      case 'n': opts.keep = true; break;
+      default:
+        cerr << "usage: " << argv[0] << " [-c cells] [-u ues-per-cell] [-f fanout] [-s seed] [-k keys-per-set] [-w writers] [-b] [-n]" << endl;
+        return 1;
+    }
+  }
+
+  if( opts.cells < 1 || opts.ues_per_cell < 0 || opts.fanout < 0 || opts.batch < 1 || opts.writers < 1 ) {
+    cerr << "cells, keys per set and writers must be positive; UEs per cell and fanout must not be negative" << endl;
+    return 1;
+  }
+
   sdl = shareddatalayer::SyncStorage::create();
 
   nsu = Namespace(sdl_namespace_u);
@@ -201,17 +592,17 @@ extern int main( int argc, char** argv ) {
 
   cout << "\n\n";
   get_sdl_data();
+  if( !opts.keep ) {
+    cout << "\n\n";
+    cout << "Deleting Data\n";
+    delete_sdl_data();
+  }
   cout << "\n\n";
-  cout << "Deleting Data\n";  
-  delete_sdl_data();
-  cout << "\n\n";  
-  get_sdl_data();
-  cout << "\n\n";
-  cout << "Writing Data\n";
-  write_sdl_data();
+  cout << "Writing " << opts.cells << " cells, " << opts.ues_per_cell << " UEs per cell, " << opts.fanout << " neighbors per UE, seed " << opts.seed << "\n";
+  write_sdl_data( opts );
   cout << "\n\n";
   get_sdl_data();
 
   return 0;
-  
+
 }
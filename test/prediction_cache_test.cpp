@@ -0,0 +1,92 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	prediction_cache_test.cpp
+    Abstract:	Tests the cache of UE predictions: TTL, LRU eviction,
+                invalidation, and the split of anomalous UEs between
+                cached and requested ones. Included by unit_test.cpp.
+
+    Date:       18 Oct 2026
+*/
+
+static ts::ue_prediction_t cached_prediction( const std::string &ue_id, int throughput ) {
+    ts::ue_prediction_t p;
+
+    p.ue_id = ue_id;
+    p.serving_cell_id = "A";
+    p.downlink = { { "A", throughput } };
+
+    return p;
+}
+
+static int prediction_cache_test( ) {
+    int errors = 0;
+    ts::ue_prediction_t p;
+
+    ts::PredictionCache cache( 1000, std::chrono::milliseconds( 50 ) );
+    cache.put( cached_prediction( "ue-1", 10 ) );
+    cache.put( cached_prediction( "ue-1", 20 ) );
+    errors += fail_not_if( cache.get( "ue-1", p ), "a fresh prediction is found" );
+    errors += fail_not_equal( p.downlink["A"], 20, "the last prediction is kept" );
+    errors += fail_if( cache.get( "ue-2", p ), "unknown UEs are not found" );
+
+    cache.invalidate( "ue-1" );
+    errors += fail_if( cache.get( "ue-1", p ), "invalidated predictions are not found" );
+    cache.invalidate( "ue-2" );     // unknown, nothing to do
+
+    cache.put( cached_prediction( "ue-3", 10 ) );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 60 ) );
+    errors += fail_if( cache.get( "ue-3", p ), "expired predictions are not found" );
+
+    /*
+        Misses before the first hit are kept where they are: they must not
+        be moved onto themselves, which leaves the id empty.
+    */
+    cache.put( cached_prediction( "hit-1", 1 ) );
+    cache.put( cached_prediction( "hit-2", 2 ) );
+    std::vector<std::string> ues { "miss-1", "miss-2", "hit-1", "miss-3", "hit-2", "miss-4" };
+    std::vector<ts::ue_prediction_t> known;
+    cache.take_fresh( ues, known );
+    errors += fail_not_if( ues == std::vector<std::string>( { "miss-1", "miss-2", "miss-3", "miss-4" } ),
+                           "UEs without a fresh prediction are kept in order" );
+    errors += fail_not_equal( known.size(), 2u, "UEs with a fresh prediction are known" );
+    errors += fail_not_if( known.size() == 2 && known[0].ue_id == "hit-1" && known[1].ue_id == "hit-2", "known predictions" );
+
+    ues = { "hit-1", "hit-2" };
+    known.clear();
+    cache.take_fresh( ues, known );
+    errors += fail_not_if( ues.empty() && known.size() == 2, "all UEs known" );
+
+    ts::prediction_cache_stats_t stats = cache.get_stats();
+    errors += fail_not_equal( stats.ues_saved, 4u, "UE predictions saved" );
+    errors += fail_not_equal( stats.requests_saved, 1u, "requests saved" );
+
+    // each of the 16 shards holds one UE
+    ts::PredictionCache small( 16, std::chrono::milliseconds( 1000 ) );
+    for( int i = 0; i < 100; i++ ) {
+        small.put( cached_prediction( "ue-" + std::to_string( i ), i ) );
+    }
+    stats = small.get_stats();
+    errors += fail_if( stats.size > 16, "the cache is bounded" );
+    errors += fail_not_equal( stats.evictions + stats.size, 100u, "UEs over the capacity are evicted" );
+    errors += fail_not_if( small.get( "ue-99", p ), "the last UE stored is kept" );
+
+    return errors;
+}
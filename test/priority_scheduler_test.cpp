@@ -0,0 +1,92 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	priority_scheduler_test.cpp
+    Abstract:	Tests the order in which the message scheduler dispatches
+                the classes, and the budget of each class. Included by
+                unit_test.cpp.
+
+    Date:       18 Oct 2026
+*/
+
+// handlers are plain functions: they record the payloads in the order they ran
+static std::mutex sched_mutex;
+static std::vector<std::string> sched_order;
+static std::atomic<bool> sched_blocked { false };
+static std::atomic<bool> sched_release { false };
+
+static void sched_record( const char *payload, int len ) {
+    std::lock_guard<std::mutex> lock( sched_mutex );
+    sched_order.push_back( std::string( payload, len ) );
+}
+
+// holds the dispatcher until released, so messages pile up behind it
+static void sched_block( const char *payload, int len ) {
+    sched_blocked = true;
+    while( !sched_release ) {
+        std::this_thread::yield();
+    }
+    sched_record( payload, len );
+}
+
+static int priority_scheduler_test( ) {
+    int errors = 0;
+
+    ts::sched_opts_t opts;
+    opts.budget[(int) ts::MsgClass::CONTROL] = 2;
+    opts.budget[(int) ts::MsgClass::DATA] = 3;
+    opts.stats_interval = std::chrono::seconds( 0 );
+
+    ts::PriorityScheduler scheduler( opts );
+
+    errors += fail_not_if( scheduler.submit( ts::MsgClass::DATA, sched_block, "block", 5 ), "submit" );
+    errors += fail_not_if( wait_for( []{ return sched_blocked.load(); } ), "the dispatcher takes the first message" );
+
+    errors += fail_not_if( scheduler.submit( ts::MsgClass::DATA, sched_record, "d1", 2 ), "data within budget" );
+    errors += fail_not_if( scheduler.submit( ts::MsgClass::DATA, sched_record, "d2", 2 ), "data within budget" );
+    errors += fail_not_if( scheduler.submit( ts::MsgClass::DATA, sched_record, "d3", 2 ), "data within budget" );
+    errors += fail_if( scheduler.submit( ts::MsgClass::DATA, sched_record, "d4", 2 ), "data over budget is dropped" );
+    errors += fail_not_if( scheduler.submit( ts::MsgClass::CONTROL, sched_record, "c1", 2 ), "control within budget" );
+    errors += fail_not_if( scheduler.submit( ts::MsgClass::CONTROL, sched_record, "c2", 2 ), "control within budget" );
+    errors += fail_if( scheduler.submit( ts::MsgClass::CONTROL, sched_record, "c3", 2 ), "control over budget is dropped" );
+
+    errors += fail_not_if( scheduler.backlog( ts::MsgClass::DATA ) == 1.0, "data queue at its budget" );
+
+    sched_release = true;
+    errors += fail_not_if( wait_for( []{ std::lock_guard<std::mutex> lock( sched_mutex ); return sched_order.size() == 6; } ),
+                           "every queued message is dispatched" );
+    {
+        std::lock_guard<std::mutex> lock( sched_mutex );
+        errors += fail_not_if( sched_order == std::vector<std::string>( { "block", "c1", "c2", "d1", "d2", "d3" } ),
+                               "control messages go before older data messages" );
+    }
+
+    ts::sched_class_stats_t control = scheduler.get_stats( ts::MsgClass::CONTROL );
+    ts::sched_class_stats_t data = scheduler.get_stats( ts::MsgClass::DATA );
+    errors += fail_not_equal( control.dispatched, 2u, "control dispatched" );
+    errors += fail_not_equal( control.dropped, 1u, "control dropped" );
+    errors += fail_not_equal( control.high_water, 2u, "control high water" );
+    errors += fail_not_equal( data.dispatched, 4u, "data dispatched" );
+    errors += fail_not_equal( data.dropped, 1u, "data dropped" );
+    errors += fail_not_equal( data.high_water, 3u, "data high water" );
+    errors += fail_not_equal( data.queued, 0u, "data left queued" );
+
+    return errors;
+}
@@ -0,0 +1,135 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	sdl_sync_test.cpp
+    Abstract:	Tests the in-memory SDL stand-in and the notification driven
+                sync on top of it. Included by unit_test.cpp.
+
+    Date:       18 Oct 2026
+*/
+
+static ts::sdl_data_t to_data( const std::string &s ) {
+    return ts::sdl_data_t( s.begin(), s.end() );
+}
+
+// fails the first get, then passes everything through
+class FlakySdl : public ts::KvStore {
+    private:
+        ts::KvStore &store;
+
+    public:
+        std::atomic<int> failures { 1 };
+
+        FlakySdl( ts::KvStore &store ) : store( store ) { }
+
+        ts::sdl_keys_t find_keys( const std::string &ns, const std::string &prefix ) override {
+            return store.find_keys( ns, prefix );
+        }
+        ts::sdl_datamap_t get( const std::string &ns, const ts::sdl_keys_t &keys ) override {
+            if( failures.fetch_sub( 1 ) > 0 ) {
+                throw std::runtime_error( "store unavailable" );
+            }
+            return store.get( ns, keys );
+        }
+        void set( const std::string &ns, const ts::sdl_datamap_t &data ) override {
+            store.set( ns, data );
+        }
+        void remove( const std::string &ns, const ts::sdl_keys_t &keys ) override {
+            store.remove( ns, keys );
+        }
+};
+
+static int sdl_sync_test( ) {
+    int errors = 0;
+    ts::InMemorySdl sdl;
+
+    sdl.set( "ns", { { "ue-1", to_data( "a" ) }, { "ue-2", to_data( "b" ) }, { "cell-1", to_data( "c" ) } } );
+    errors += fail_not_equal( sdl.find_keys( "ns", "ue-" ).size(), 2u, "find_keys by prefix" );
+    errors += fail_not_equal( sdl.get( "ns", { "ue-1", "nope" } ).size(), 1u, "get skips missing keys" );
+    errors += fail_not_equal( sdl.find_keys( "other", "" ).size(), 0u, "namespaces are separate" );
+
+    std::mutex mutex;
+    std::map<std::string, std::string> local;
+    int applied = 0;
+    auto apply = [&]( const ts::sdl_datamap_t &changed, const ts::sdl_keys_t &removed ) {
+        std::lock_guard<std::mutex> lock( mutex );
+        for( auto &kv : changed ) {
+            local[kv.first] = std::string( kv.second.begin(), kv.second.end() );
+        }
+        for( auto &k : removed ) {
+            local.erase( k );
+        }
+        applied++;
+    };
+    auto local_has = [&]( const std::string &key, const std::string &value ) {
+        std::lock_guard<std::mutex> lock( mutex );
+        auto it = local.find( key );
+        return it != local.end() && it->second == value;
+    };
+
+    {
+        ts::SdlSync sync( sdl, sdl, "ns", apply );
+
+        sync.resync();
+        errors += fail_not_if( wait_for( [&]{ return local_has( "cell-1", "c" ); } ), "resync copies the namespace" );
+
+        sdl.set( "ns", { { "ue-1", to_data( "a2" ) } } );
+        errors += fail_not_if( wait_for( [&]{ return local_has( "ue-1", "a2" ); } ), "set is synced" );
+
+        sdl.remove( "ns", { "ue-2" } );
+        errors += fail_not_if( wait_for( [&]{ std::lock_guard<std::mutex> lock( mutex ); return local.count( "ue-2" ) == 0; } ),
+                               "remove is synced" );
+
+        sdl.set( "other", { { "ue-1", to_data( "x" ) } } );
+        std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+        errors += fail_not_if( local_has( "ue-1", "a2" ), "other namespaces are not synced" );
+    }
+
+    // the sync is gone and unsubscribed: notifying must not reach it
+    int before = applied;
+    sdl.set( "ns", { { "ue-3", to_data( "d" ) } } );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+    errors += fail_not_equal( applied, before, "no sync after the SdlSync is destroyed" );
+
+    // a failed get is retried
+    {
+        FlakySdl flaky( sdl );
+        ts::SdlSync sync( flaky, sdl, "ns", apply );
+
+        sdl.set( "ns", { { "ue-4", to_data( "e" ) } } );
+        errors += fail_not_if( wait_for( [&]{ return local_has( "ue-4", "e" ); } ), "keys are synced again after a failed get" );
+        errors += fail_not_if( flaky.failures < 0, "the failed get was retried" );
+    }
+
+    // subscriptions come and go while the store is written to
+    std::atomic<bool> stop { false };
+    std::thread writer( [&]{
+        for( int i = 0; !stop; i++ ) {
+            sdl.set( "ns", { { "ue-" + std::to_string( i % 10 ), to_data( "v" ) } } );
+        }
+    } );
+    for( int i = 0; i < 50; i++ ) {
+        ts::SdlSync sync( sdl, sdl, "ns", []( const ts::sdl_datamap_t &, const ts::sdl_keys_t & ) { } );
+    }
+    stop = true;
+    writer.join();
+
+    return errors;
+}
@@ -0,0 +1,80 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	spsc_ring_test.cpp
+    Abstract:	Tests the single-producer single-consumer ring of the staged
+                pipeline. Included by unit_test.cpp.
+
+    Date:       18 Oct 2026
+*/
+
+static int spsc_ring_test( ) {
+    int errors = 0;
+
+    ts::SpscRing<std::string> ring( 3 );
+    errors += fail_not_equal( ring.capacity(), 4u, "the capacity is rounded up to a power of two" );
+
+    std::string item;
+    errors += fail_if( ring.pop( item ), "an empty ring pops nothing" );
+
+    for( int i = 0; i < 4; i++ ) {
+        std::string s = "item-" + std::to_string( i );
+        errors += fail_not_if( ring.push( std::move( s ) ), "push into a ring with room" );
+    }
+    std::string extra = "extra";
+    errors += fail_if( ring.push( std::move( extra ) ), "a full ring refuses items" );
+    errors += fail_not_equal( extra, std::string( "extra" ), "a refused item is left untouched" );
+    errors += fail_not_equal( ring.size(), 4u, "size of a full ring" );
+
+    for( int i = 0; i < 4; i++ ) {
+        errors += fail_not_if( ring.pop( item ) && item == "item-" + std::to_string( i ), "items pop in order" );
+    }
+    errors += fail_not_equal( ring.size(), 0u, "size of a drained ring" );
+
+    // wraps around many times between two threads
+    const int ITEMS = 200000;
+    ts::SpscRing<std::unique_ptr<int>> shared( 16 );
+    std::thread producer( [&]{
+        for( int i = 0; i < ITEMS; i++ ) {
+            std::unique_ptr<int> p( new int( i ) );
+            while( !shared.push( std::move( p ) ) ) {
+                std::this_thread::yield();
+            }
+        }
+    } );
+
+    int expected = 0;
+    bool in_order = true;
+    while( expected < ITEMS ) {
+        std::unique_ptr<int> p;
+        if( !shared.pop( p ) ) {
+            std::this_thread::yield();
+            continue;
+        }
+        in_order = in_order && p && *p == expected;
+        expected++;
+    }
+    producer.join();
+
+    errors += fail_not_if( in_order, "items cross threads in order, none lost" );
+    errors += fail_not_equal( shared.size(), 0u, "nothing left" );
+
+    return errors;
+}
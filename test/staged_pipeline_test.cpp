@@ -0,0 +1,139 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	staged_pipeline_test.cpp
+    Abstract:	Tests that the staged pipeline delivers every message in the
+                order it was submitted, and counts the stalls of stages
+                when one of them holds the pipeline. Included by
+                unit_test.cpp.
+
+    Date:       18 Oct 2026
+*/
+
+static int staged_pipeline_test( ) {
+    int errors = 0;
+    std::mutex mutex;
+    std::vector<std::string> delivered;     // UEs of control and prediction requests, as egress sees them
+    std::atomic<bool> hold { false };
+
+    auto delivered_count = [&]( ) {
+        std::lock_guard<std::mutex> lock( mutex );
+        return delivered.size();
+    };
+
+    // payloads are the id of the UE; anomalies of UEs whose id starts with "k" have a known prediction
+    ts::staged_hooks_t hooks;
+    hooks.decode_prediction = []( const char *payload, int len, ts::ue_prediction_t &prediction ) {
+        prediction.ue_id.assign( payload, len );
+        prediction.serving_cell_id = "s";
+        return true;
+    };
+    hooks.decode_anomaly = []( const char *payload, int len, std::vector<std::string> &ues, std::vector<ts::ue_prediction_t> &known ) {
+        std::string ue_id( payload, len );
+        if( ue_id[0] == 'k' ) {
+            known.push_back( { ue_id, "s", { } } );
+        } else {
+            ues.push_back( ue_id );
+        }
+        return true;
+    };
+    hooks.choose_target = []( const ts::ue_prediction_t &prediction, std::string &target ) {
+        target = "t";
+        return prediction.ue_id != "drop";
+    };
+    hooks.request_predictions = [&]( const std::vector<std::string> &ues ) {
+        std::lock_guard<std::mutex> lock( mutex );
+        delivered.push_back( "request " + ues[0] );
+    };
+    hooks.send_control = [&]( const std::string &ue_id, const std::string &serving, const std::string &target ) {
+        while( hold ) {
+            std::this_thread::yield();
+        }
+        std::lock_guard<std::mutex> lock( mutex );
+        delivered.push_back( "control " + ue_id );
+        return true;
+    };
+
+    ts::staged_opts_t opts;
+    opts.capacity = 4;
+    opts.stats_interval = std::chrono::seconds( 0 );
+
+    {
+        ts::StagedPipeline pipeline( opts, hooks );
+
+        std::vector<std::string> expected;
+        for( int i = 0; i < 5000; i++ ) {
+            std::string ue_id = std::to_string( i );
+            switch( i % 3 ) {
+                case 0:
+                    pipeline.submit( TS_QOE_PREDICTION, ue_id.data(), ue_id.size() );
+                    expected.push_back( "control " + ue_id );
+                    break;
+                case 1:
+                    pipeline.submit( TS_ANOMALY_UPDATE, ue_id.data(), ue_id.size() );
+                    expected.push_back( "request " + ue_id );
+                    break;
+                case 2:
+                    ue_id = "k" + ue_id;
+                    pipeline.submit( TS_ANOMALY_UPDATE, ue_id.data(), ue_id.size() );
+                    expected.push_back( "control " + ue_id );
+                    break;
+            }
+        }
+        pipeline.submit( TS_QOE_PREDICTION, "drop", 4 );
+
+        errors += fail_not_if( wait_for( [&]{ return delivered_count() == expected.size(); } ), "every message is delivered" );
+        {
+            std::lock_guard<std::mutex> lock( mutex );
+            errors += fail_not_if( delivered == expected, "messages are delivered in the order they were submitted" );
+        }
+
+        errors += fail_not_if( wait_for( [&]{ return pipeline.get_stats()[0].processed == 5001; } ), "every message is decoded" );
+        std::vector<ts::stage_stats_t> stats = pipeline.get_stats();
+        errors += fail_not_equal( stats.size(), 3u, "stages" );
+        errors += fail_not_equal( stats[2].processed, 5000u, "messages sent, without the one with no target" );
+        errors += fail_not_if( stats[0].high_water <= 4 && stats[2].high_water <= 4, "rings never hold more than their capacity" );
+
+        // egress holds: its ring fills, then the one of decide, then the one of decode
+        uint64_t stalls[3] = { stats[0].stalls, stats[1].stalls, stats[2].stalls };
+        size_t before = delivered_count();
+        hold = true;
+        std::thread producer( [&]{
+            for( int i = 0; i < 30; i++ ) {
+                std::string ue_id = "held" + std::to_string( i );
+                pipeline.submit( TS_QOE_PREDICTION, ue_id.data(), ue_id.size() );
+            }
+        } );
+
+        auto stalled = [&]( ) {
+            std::vector<ts::stage_stats_t> s = pipeline.get_stats();
+            return s[0].stalls > stalls[0] && s[1].stalls > stalls[1] && s[2].stalls > stalls[2] && s[0].queued == 4;
+        };
+        errors += fail_not_if( wait_for( stalled ), "every stage in front of the held one stalls, up to the producer" );
+        errors += fail_not_equal( pipeline.get_stats()[2].high_water, 4u, "a held stage fills its ring" );
+        errors += fail_not_if( pipeline.backlog() == 1.0, "the decode ring is full" );
+
+        hold = false;
+        producer.join();
+        errors += fail_not_if( wait_for( [&]{ return delivered_count() == before + 30; } ), "held messages are delivered once released" );
+    }
+
+    return errors;
+}
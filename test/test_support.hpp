@@ -0,0 +1,72 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	test_support.hpp
+    Abstract:	Small checks shared by the module tests. Each check prints
+                a line on failure and returns 1, so a test sums them up
+                into its error count.
+
+    Date:       18 Oct 2026
+*/
+
+#ifndef _TEST_SUPPORT_HPP
+#define _TEST_SUPPORT_HPP
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+static int fail_if( bool condition, const char *what ) {
+    if( condition ) {
+        std::cerr << "<FAIL> " << what << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+static int fail_not_if( bool condition, const char *what ) {
+    return fail_if( !condition, what );
+}
+
+template <typename A, typename B>
+static int fail_not_equal( const A &a, const B &b, const char *what ) {
+    if( !( a == b ) ) {
+        std::cerr << "<FAIL> " << what << ": got " << a << ", expected " << b << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// polls until the condition holds or a second went by; true if it held
+static bool wait_for( std::function<bool( )> condition ) {
+    for( int i = 0; i < 1000; i++ ) {
+        if( condition() ) {
+            return true;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+
+    return condition();
+}
+
+#endif
@@ -0,0 +1,122 @@
+// vi: ts=4 sw=4 noet:
+/*
+==================================================================================
+    Copyright (c) 2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+    Mnemonic:	unit_test.cpp
+    Abstract:	Drives the unit tests. The modules under test are included
+                directly, rather than linked, so that gcov reports on them;
+                they must not need RMR or the xApp framework.
+
+    Date:       18 Oct 2026
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <unistd.h>
+
+#include "../src/ts_xapp/a1_responder.cpp"
+#include "../src/ts_xapp/batch_assign.cpp"
+#include "../src/ts_xapp/capture_log.cpp"
+#include "../src/ts_xapp/cell_index.cpp"
+#include "../src/ts_xapp/handoff_budget.cpp"
+#include "../src/ts_xapp/handoff_decision.hpp"
+#include "../src/ts_xapp/handoff_workflow.cpp"
+#include "../src/ts_xapp/key_dispatcher.hpp"
+#include "../src/ts_xapp/load_shedder.cpp"
+#include "../src/ts_xapp/loopback_transport.cpp"
+#include "../src/ts_xapp/metrics_cache.cpp"
+#include "../src/ts_xapp/neighbor_table.cpp"
+#include "../src/ts_xapp/policy_store.cpp"
+#include "../src/ts_xapp/prediction_cache.cpp"
+#include "../src/ts_xapp/priority_scheduler.cpp"
+#include "../src/ts_xapp/sdl_sync.cpp"
+#include "../src/ts_xapp/spsc_ring.hpp"
+#include "../src/ts_xapp/staged_pipeline.cpp"
+
+#include "test_support.hpp"
+
+#include "a1_responder_test.cpp"
+#include "batch_assign_test.cpp"
+#include "capture_log_test.cpp"
+#include "cell_index_test.cpp"
+#include "handoff_budget_test.cpp"
+#include "key_dispatcher_test.cpp"
+#include "load_shedder_test.cpp"
+#include "loopback_transport_test.cpp"
+#include "metrics_record_test.cpp"
+#include "neighbor_table_test.cpp"
+#include "policy_store_test.cpp"
+#include "prediction_cache_test.cpp"
+#include "priority_scheduler_test.cpp"
+#include "sdl_sync_test.cpp"
+#include "spsc_ring_test.cpp"
+#include "staged_pipeline_test.cpp"
+#ifdef TS_HANDOFF_WORKFLOWS
+#include "handoff_workflow_test.cpp"
+#endif
+
+int main( ) {
+    int errors = 0;
+
+    errors += a1_responder_test();
+    errors += solve_assignment_test();
+    errors += batch_assigner_test();
+    errors += capture_log_test();
+    errors += cell_index_test();
+    errors += handoff_decision_test();
+    errors += handoff_budget_test();
+    errors += key_dispatcher_test();
+    errors += load_shedder_test();
+    errors += loopback_transport_test();
+    errors += metrics_record_test();
+    errors += neighbor_table_test();
+    errors += policy_store_test();
+    errors += prediction_cache_test();
+    errors += priority_scheduler_test();
+    errors += sdl_sync_test();
+    errors += spsc_ring_test();
+    errors += staged_pipeline_test();
+#ifdef TS_HANDOFF_WORKFLOWS
+    errors += handoff_workflow_test();
+#else
+    std::cerr << "<INFO> handoff workflows not tested, build with COROUTINES=1 (C++20)" << std::endl;
+#endif
+
+    if( errors > 0 ) {
+        std::cerr << "<FAIL> " << errors << " unit test error(s)" << std::endl;
+        return 1;
+    }
+
+    std::cerr << "<PASS> all unit tests passed" << std::endl;
+    return 0;
+}